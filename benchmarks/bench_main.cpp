@@ -0,0 +1,248 @@
+/**
+ * Headless turn throughput benchmark.
+ *
+ * Creates a fresh world from a fixed seed, starts the player in a city, surrounds them
+ * with a horde, sets some buildings on fire and adds a few running vehicles. Then
+ * @ref game::do_turn is called repeatedly without any user interface and the number of
+ * turns per second, together with the per-phase timings from the @ref turn_profiler,
+ * is reported.
+ *
+ * With --scent only the scent diffusion kernels are measured, see scent_bench.cpp.
+ */
+#include "game.h"
+#include "filesystem.h"
+#include "map.h"
+#include "field.h"
+#include "line.h"
+#include "mtype.h"
+#include "options.h"
+#include "path_info.h"
+#include "player.h"
+#include "rng.h"
+#include "scent_bench.h"
+#include "start_location.h"
+#include "turn_profiler.h"
+#include "vehicle.h"
+#include "worldfactory.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+extern bool test_mode;
+
+struct bench_options {
+    int turns = 1000;
+    int warmup = 50;
+    int monsters = 200;
+    int fires = 30;
+    int vehicles = 4;
+    unsigned int seed = 42;
+    bool scent_only = false;
+    std::string profile_path;
+};
+
+static bool parse_int_arg( const char *arg, const char *name, int &value )
+{
+    const size_t len = strlen( name );
+    if( strncmp( arg, name, len ) != 0 ) {
+        return false;
+    }
+    value = atoi( arg + len );
+    return true;
+}
+
+static bool parse_args( int argc, const char *argv[], bench_options &opts )
+{
+    for( int i = 1; i < argc; i++ ) {
+        const char *arg = argv[i];
+        int seed = 0;
+        if( parse_int_arg( arg, "--turns=", opts.turns ) ||
+            parse_int_arg( arg, "--warmup=", opts.warmup ) ||
+            parse_int_arg( arg, "--monsters=", opts.monsters ) ||
+            parse_int_arg( arg, "--fires=", opts.fires ) ||
+            parse_int_arg( arg, "--vehicles=", opts.vehicles ) ) {
+            continue;
+        } else if( parse_int_arg( arg, "--seed=", seed ) ) {
+            opts.seed = seed;
+        } else if( strncmp( arg, "--profile=", 10 ) == 0 ) {
+            opts.profile_path = arg + 10;
+        } else if( strcmp( arg, "--scent" ) == 0 ) {
+            opts.scent_only = true;
+        } else {
+            printf( "Usage: %s [options]\n", argv[0] );
+            printf( "  --turns=<n>        Number of measured turns (default 1000).\n" );
+            printf( "  --warmup=<n>       Turns to run before measuring (default 50).\n" );
+            printf( "  --monsters=<n>     Size of the horde (default 200).\n" );
+            printf( "  --fires=<n>        Number of burning tiles (default 30).\n" );
+            printf( "  --vehicles=<n>     Number of running vehicles (default 4).\n" );
+            printf( "  --seed=<n>         Random seed for world and scenario (default 42).\n" );
+            printf( "  --profile=<file>   Also write the turn profile into that file.\n" );
+            printf( "  --scent            Only compare the scent diffusion kernels, running\n" );
+            printf( "                     <turns> updates with each of them.\n" );
+            return false;
+        }
+    }
+    return opts.turns > 0;
+}
+
+static void init_game_state( const bench_options &opts )
+{
+    srand( opts.seed );
+    rng_set_engine_seed( opts.seed );
+
+    PATH_INFO::init_base_path( "" );
+    PATH_INFO::init_user_dir( "./" );
+    PATH_INFO::set_standard_filenames();
+
+    if( !assure_dir_exist( FILENAMES["config_dir"] ) || !assure_dir_exist( FILENAMES["savedir"] ) ) {
+        throw std::runtime_error( "Unable to make config or save directory. Check permissions." );
+    }
+
+    get_options().init();
+    get_options().load();
+    init_colors();
+
+    g = new game;
+    g->load_static_data();
+
+    world_generator->set_active_world( NULL );
+    world_generator->get_all_worlds();
+    const std::vector<std::string> mods = { "dda" };
+    WORLDPTR world = world_generator->make_new_world( mods );
+    if( world == NULL ) {
+        throw std::runtime_error( "Unable to create the benchmark world." );
+    }
+    world_generator->set_active_world( world );
+
+    g->load_core_data();
+    g->load_world_modfiles( world_generator->active_world );
+
+    g->u = player();
+    g->u.create( PLTYPE_NOW );
+    g->u.start_location = start_location_id( "s_grocery" );
+    // The player only watches, they must survive the horde.
+    g->u.set_mutation( "DEBUG_NODMG" );
+
+    if( !g->start_game( world->world_name ) ) {
+        throw std::runtime_error( "Unable to start the benchmark game." );
+    }
+}
+
+/** Random position within the reality bubble that is between min and max tiles away from the player. */
+static tripoint random_point_near_player( int min_dist, int max_dist )
+{
+    const tripoint &u = g->u.pos();
+    for( int attempts = 0; attempts < 100; attempts++ ) {
+        const tripoint p( u.x + rng( -max_dist, max_dist ), u.y + rng( -max_dist, max_dist ), u.z );
+        if( g->m.inbounds( p ) && rl_dist( p, u ) >= min_dist ) {
+            return p;
+        }
+    }
+    return tripoint_min;
+}
+
+static void setup_scenario( const bench_options &opts )
+{
+    const mtype_id zombie( "mon_zombie" );
+    for( int spawned = 0, attempts = 0; spawned < opts.monsters && attempts < opts.monsters * 20;
+         attempts++ ) {
+        const tripoint p = random_point_near_player( 8, SEEX * MAPSIZE / 2 - 2 );
+        if( p != tripoint_min && g->m.passable( p ) && g->critter_at( p ) == nullptr &&
+            g->summon_mon( zombie, p ) ) {
+            spawned++;
+        }
+    }
+
+    for( int lit = 0, attempts = 0; lit < opts.fires && attempts < opts.fires * 50; attempts++ ) {
+        const tripoint p = random_point_near_player( 6, SEEX * MAPSIZE / 2 - 2 );
+        if( p != tripoint_min && g->m.has_flag( "FLAMMABLE", p ) && g->m.add_field( p, fd_fire, 3 ) ) {
+            lit++;
+        }
+    }
+
+    const vproto_id car( "car" );
+    for( int i = 0; i < opts.vehicles; i++ ) {
+        const tripoint p = random_point_near_player( 10, SEEX * MAPSIZE / 2 - 10 );
+        if( p == tripoint_min ) {
+            continue;
+        }
+        vehicle *veh = g->m.add_vehicle( car, p, 90 * rng( 0, 3 ), 100, 0 );
+        if( veh == nullptr ) {
+            continue;
+        }
+        veh->engine_on = true;
+        veh->cruise_velocity = 1500;
+        veh->velocity = 1500;
+    }
+}
+
+/** Runs one turn of the game without giving the player a chance to act. */
+static bool run_turn()
+{
+    // A player with moves left would ask for input.
+    g->u.moves = 0;
+    return g->do_turn();
+}
+
+int main( int argc, const char *argv[] )
+{
+    bench_options opts;
+    if( !parse_args( argc, argv, opts ) ) {
+        return EXIT_FAILURE;
+    }
+
+    if( opts.scent_only ) {
+        return run_scent_benchmark( opts.turns, opts.seed );
+    }
+
+    test_mode = true;
+
+    try {
+        init_game_state( opts );
+        setup_scenario( opts );
+    } catch( const std::exception &err ) {
+        fprintf( stderr, "Terminated: %s\n", err.what() );
+        fprintf( stderr, "Make sure that you're in the correct working directory and your data isn't corrupted.\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "Seed %u, %d monsters, %d turns after %d warmup turns\n", opts.seed,
+            static_cast<int>( g->num_zombies() ), opts.turns, opts.warmup );
+
+    int result = EXIT_SUCCESS;
+    for( int i = 0; i < opts.warmup && result == EXIT_SUCCESS; i++ ) {
+        if( run_turn() ) {
+            result = EXIT_FAILURE;
+        }
+    }
+    turn_profiler::reset();
+
+    const auto start = std::chrono::steady_clock::now();
+    int turns_done = 0;
+    for( ; turns_done < opts.turns && result == EXIT_SUCCESS; turns_done++ ) {
+        if( run_turn() ) {
+            result = EXIT_FAILURE;
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>( end - start ).count();
+
+    if( result != EXIT_SUCCESS ) {
+        fprintf( stderr, "The game ended after %d measured turns.\n", turns_done );
+    }
+    printf( "%d turns in %.3f seconds: %.2f turns/second\n", turns_done, seconds,
+            seconds > 0 ? turns_done / seconds : 0.0 );
+    printf( "%s", turn_profiler::summary().c_str() );
+    if( !opts.profile_path.empty() && !turn_profiler::dump( opts.profile_path ) ) {
+        result = EXIT_FAILURE;
+    }
+
+    g->delete_world( world_generator->active_world->world_name, true );
+
+    return result;
+}
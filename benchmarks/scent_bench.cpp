@@ -0,0 +1,144 @@
+/**
+ * Benchmark of the scent diffusion kernels.
+ *
+ * Diffuses random scent over random terrain with every kernel the processor supports
+ * and with a copy of the old flag based implementation. The results must be exactly the
+ * same, otherwise the benchmark fails.
+ */
+#include "scent_bench.h"
+
+#include "scent_diffusion.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+using scent_diffusion::grid;
+using scent_diffusion::kernel;
+
+template<typename T>
+using flag_array = std::array<std::array<T, SEEY *MAPSIZE>, SEEX *MAPSIZE>;
+
+static constexpr int radius = 40;
+static constexpr int center = SEEX * MAPSIZE / 2;
+static constexpr int minx = center - radius;
+static constexpr int maxx = center + radius;
+static constexpr int miny = center - radius;
+static constexpr int maxy = center + radius;
+
+struct scent_input {
+    grid scent;
+    grid weights;
+    flag_array<bool> blocks_scent;
+    flag_array<bool> reduces_scent;
+};
+
+/** The diffusion as scent_map::update did it before the kernels, used as reference. */
+static void reference_diffuse( grid &grscent, const flag_array<bool> &blocks_scent,
+                               const flag_array<bool> &reduces_scent )
+{
+    grid sum_3_scent_y;
+    grid squares_used_y;
+    const int diffusivity = 100;
+    for( int x = minx - 1; x <= maxx + 1; ++x ) {
+        for( int y = miny; y <= maxy; ++y ) {
+            sum_3_scent_y[y][x] = 0;
+            squares_used_y[y][x] = 0;
+            for( int i = y - 1; i <= y + 1; ++i ) {
+                if( !blocks_scent[x][i] ) {
+                    if( reduces_scent[x][i] ) {
+                        sum_3_scent_y[y][x] += 2 * grscent[x][i];
+                        squares_used_y[y][x] += 2;
+                    } else {
+                        sum_3_scent_y[y][x] += 10 * grscent[x][i];
+                        squares_used_y[y][x] += 10;
+                    }
+                }
+            }
+        }
+    }
+    for( int x = minx; x <= maxx; ++x ) {
+        for( int y = miny; y <= maxy; ++y ) {
+            auto &scent_here = grscent[x][y];
+            if( !blocks_scent[x][y] ) {
+                int squares_used = squares_used_y[y][x - 1] + squares_used_y[y][x] +
+                                   squares_used_y[y][x + 1];
+                int this_diffusivity;
+                if( !reduces_scent[x][y] ) {
+                    this_diffusivity = diffusivity;
+                } else {
+                    this_diffusivity = diffusivity / 5;
+                }
+                int temp_scent;
+                temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
+                temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
+                scent_here = ( temp_scent + this_diffusivity * ( sum_3_scent_y[y][x - 1] +
+                               sum_3_scent_y[y][x] + sum_3_scent_y[y][x + 1] ) ) / ( 1000 * 10 );
+            } else {
+                scent_here = 0;
+            }
+        }
+    }
+}
+
+static void make_input( scent_input &in, const unsigned int seed )
+{
+    std::mt19937 gen( seed );
+    std::uniform_int_distribution<int> scent_dist( 0, 1000 );
+    std::uniform_int_distribution<int> terrain_dist( 0, 9 );
+    for( size_t x = 0; x < in.scent.size(); ++x ) {
+        for( size_t y = 0; y < in.scent[x].size(); ++y ) {
+            // Mostly open ground with some walls and bushes, like a town
+            const int terrain = terrain_dist( gen );
+            in.blocks_scent[x][y] = terrain == 0;
+            in.reduces_scent[x][y] = terrain == 1;
+            in.weights[x][y] = terrain == 0 ? scent_diffusion::WEIGHT_BLOCK :
+                               terrain == 1 ? scent_diffusion::WEIGHT_REDUCE : scent_diffusion::WEIGHT_NORMAL;
+            in.scent[x][y] = scent_dist( gen );
+        }
+    }
+}
+
+int run_scent_benchmark( const int iterations, const unsigned int seed )
+{
+    // The grids are too large for the stack
+    std::unique_ptr<scent_input> in( new scent_input() );
+    make_input( *in, seed );
+
+    std::unique_ptr<grid> expected( new grid( in->scent ) );
+    const auto start = std::chrono::steady_clock::now();
+    for( int i = 0; i < iterations; ++i ) {
+        reference_diffuse( *expected, in->blocks_scent, in->reduces_scent );
+    }
+    const double reference_seconds = std::chrono::duration<double>
+                                     ( std::chrono::steady_clock::now() - start ).count();
+    printf( "%-10s %8.2f us/update\n", "reference", reference_seconds * 1e6 / iterations );
+
+    int result = EXIT_SUCCESS;
+    std::unique_ptr<grid> actual( new grid() );
+    for( const kernel k : {
+             kernel::scalar, kernel::sse4_1, kernel::avx2
+         } ) {
+        if( !scent_diffusion::supported( k ) ) {
+            printf( "%-10s not supported\n", scent_diffusion::name( k ) );
+            continue;
+        }
+        *actual = in->scent;
+        const auto kernel_start = std::chrono::steady_clock::now();
+        for( int i = 0; i < iterations; ++i ) {
+            scent_diffusion::diffuse( *actual, in->weights, minx, miny, maxx, maxy, k );
+        }
+        const double seconds = std::chrono::duration<double>
+                               ( std::chrono::steady_clock::now() - kernel_start ).count();
+        const bool same = *actual == *expected;
+        printf( "%-10s %8.2f us/update, %.2fx%s\n", scent_diffusion::name( k ), seconds * 1e6 / iterations,
+                seconds > 0 ? reference_seconds / seconds : 0.0, same ? "" : ", RESULT DIFFERS" );
+        if( !same ) {
+            result = EXIT_FAILURE;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,10 @@
+#ifndef SCENT_BENCH_H
+#define SCENT_BENCH_H
+
+/**
+ * Runs the given number of scent updates with each diffusion kernel and compares the
+ * results with the old implementation. Returns EXIT_FAILURE if any of them differs.
+ */
+int run_scent_benchmark( int iterations, unsigned int seed );
+
+#endif
@@ -1212,7 +1212,7 @@ void it_artifact_armor::deserialize(JsonObject &jo)
 
 bool save_artifacts( const std::string &path )
 {
-    return write_to_file_exclusive( path, [&]( std::ostream &fout ) {
+    return write_to_file_exclusive_async( path, [&]( std::ostream &fout ) {
         JsonOut json( fout );
         json.start_array();
         for( const itype *e : item_controller->all() ) {
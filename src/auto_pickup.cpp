@@ -12,6 +12,7 @@
 #include "input.h"
 #include "worldfactory.h"
 #include "itype.h"
+#include "save_writer.h"
 
 #include <stdlib.h>
 #include <sstream>
@@ -602,6 +603,8 @@ bool auto_pickup::save(const bool bCharacter)
             savefile = world_generator->active_world->world_path + "/" + base64_encode(g->u.name) + ".apu.json";
 
             const std::string player_save = world_generator->active_world->world_path + "/" + base64_encode(g->u.name) + ".sav";
+            // The character may have just been saved in the background
+            save_writer::get().wait_for( player_save );
             if( !file_exist( player_save ) ) {
                 return true; //Character not saved yet.
             }
@@ -12,9 +12,11 @@
 #include "json.h"
 #include "filesystem.h"
 #include "item_search.h"
+#include "save_writer.h"
 
 #include <algorithm>
 #include <cmath>
+#include <sstream>
 
 double round_up( double val, unsigned int dp )
 {
@@ -424,6 +426,39 @@ bool write_to_file_exclusive( const std::string &path,
     }
 }
 
+static bool queue_write_to_file( const std::string &path,
+                                 const std::function<void( std::ostream & )> &writer, const char *const fail_message,
+                                 const bool exclusive )
+{
+    try {
+        std::ostringstream buffer;
+        writer( buffer );
+        if( buffer.fail() ) {
+            throw std::runtime_error( "writing to buffer failed" );
+        }
+        save_writer::get().write( path, buffer.str(), exclusive, fail_message ? fail_message : "" );
+        return true;
+
+    } catch( const std::exception &err ) {
+        if( fail_message ) {
+            popup( _( "Failed to write %1$s to \"%2$s\": %3$s" ), fail_message, path.c_str(), err.what() );
+        }
+        return false;
+    }
+}
+
+bool write_to_file_async( const std::string &path,
+                          const std::function<void( std::ostream & )> &writer, const char *const fail_message )
+{
+    return queue_write_to_file( path, writer, fail_message, false );
+}
+
+bool write_to_file_exclusive_async( const std::string &path,
+                                    const std::function<void( std::ostream & )> &writer, const char *const fail_message )
+{
+    return queue_write_to_file( path, writer, fail_message, true );
+}
+
 std::istream &safe_getline( std::istream &ins, std::string &str )
 {
     str.clear();
@@ -453,13 +488,27 @@ std::istream &safe_getline( std::istream &ins, std::string &str )
 
 bool read_from_file( const std::string &path, const std::function<void( std::istream & )> &reader )
 {
+    save_writer::get().wait_for( path );
     try {
         std::ifstream fin( path, std::ios::binary );
         if( !fin ) {
             throw std::runtime_error( "opening file failed" );
         }
-        reader( fin );
-        if( fin.bad() ) {
+        // Read it all at once, JsonIn parses from memory much faster than from a file stream
+        fin.seekg( 0, std::ios::end );
+        const std::streamoff size = fin.tellg();
+        fin.seekg( 0, std::ios::beg );
+        if( size < 0 ) {
+            throw std::runtime_error( "reading file failed" );
+        }
+        std::string data( size, '\0' );
+        if( !fin.read( &data[0], size ) ) {
+            throw std::runtime_error( "reading file failed" );
+        }
+        memory_streambuf buffer( data.data(), data.size() );
+        std::istream stream( &buffer );
+        reader( stream );
+        if( stream.bad() ) {
             throw std::runtime_error( "reading file failed" );
         }
         return true;
@@ -491,6 +540,8 @@ bool read_from_file_optional( const std::string &path,
     // Note: slight race condition here, but we'll ignore it. Worst case: the file
     // exists and got removed before reading it -> reading fails with a message
     // Or file does not exists, than everything works fine because it's optional anyway.
+    // A new file may not have been written yet.
+    save_writer::get().wait_for( path );
     return file_exist( path ) && read_from_file( path, reader );
 }
 
@@ -224,6 +224,19 @@ class ofstream_wrapper_exclusive
 bool write_to_file_exclusive( const std::string &path,
                               const std::function<void( std::ostream & )> &writer,  const char *fail_message );
 
+/**
+ * Like @ref write_to_file and @ref write_to_file_exclusive, but only the writer runs on the
+ * calling thread, into memory. The file itself is written by the @ref save_writer thread,
+ * which reports I/O errors later on.
+ * @return Whether the writer succeeded.
+ */
+/**@{*/
+bool write_to_file_async( const std::string &path,
+                          const std::function<void( std::ostream & )> &writer, const char *fail_message );
+bool write_to_file_exclusive_async( const std::string &path,
+                                    const std::function<void( std::ostream & )> &writer, const char *fail_message );
+/**@}*/
+
 std::istream &safe_getline( std::istream &ins, std::string &str );
 
 #endif // CAT_UTILITY_H
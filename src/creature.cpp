@@ -2,6 +2,7 @@
 #include "creature.h"
 #include "output.h"
 #include "game.h"
+#include "creature_tracker.h"
 #include "map.h"
 #include "messages.h"
 #include "rng.h"
@@ -242,6 +243,8 @@ bool Creature::sees( const tripoint &t, bool is_player ) const
             // Special case monster -> player visibility, forcing it to be symmetric with player vision.
             return range >= wanted_range &&
                 g->m.get_cache_ref(pos().z).seen_cache[pos().x][pos().y] > LIGHT_TRANSPARENCY_SOLID;
+        } else if( use_vision_field ) {
+            return g->m.sees_in_field( pos(), t, range, range_max );
         } else {
             return g->m.sees( pos(), t, range );
         }
@@ -302,15 +305,13 @@ Creature *Creature::auto_find_hostile_target( int range, int &boo_hoo, int area
     }
 
     std::vector<Creature*> targets;
-    targets.reserve( g->num_zombies() + g->active_npc.size() );
-    for (size_t i = 0; i < g->num_zombies(); i++) {
-        monster &m = g->zombie(i);
+    g->critter_tracker->for_each_in_radius( pos(), range, [&targets]( monster &m ) {
         if( m.friendly != 0 ) {
             // friendly to the player, not a target for us
-            continue;
+            return;
         }
         targets.push_back( &m );
-    }
+    } );
     for( auto &p : g->active_npc ) {
         if( p->attitude != NPCATT_KILL ) {
             // friendly to the player, not a target for us
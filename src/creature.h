@@ -147,6 +147,18 @@ class Creature
 
         /*@}*/
 
+        /**
+         * Whether @ref sees answers for points from one field of view per turn (see
+         * @ref map::sees_in_field) instead of a line per point. For creatures that look
+         * at many creatures or points each turn, off by default.
+         */
+        void set_vision_field( bool use ) {
+            use_vision_field = use;
+        }
+        bool uses_vision_field() const {
+            return use_vision_field;
+        }
+
         /**
          * How far the creature sees under the given light. Places outside this range can
          * @param light_level See @ref game::light_level.
@@ -555,6 +567,7 @@ class Creature
         int throw_resist;
 
         bool fake;
+        bool use_vision_field = false;
 
         Creature();
         Creature(const Creature &) = default;
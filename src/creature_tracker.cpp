@@ -5,6 +5,25 @@
 #include "debug.h"
 #include "mtype.h"
 #include "item.h"
+#include "line.h"
+
+#include <algorithm>
+
+static bool in_bubble( const tripoint &p )
+{
+    return p.x >= 0 && p.x < SEEX * MAPSIZE && p.y >= 0 && p.y < SEEY * MAPSIZE &&
+           p.z >= -OVERMAP_DEPTH && p.z <= OVERMAP_HEIGHT;
+}
+
+static size_t tile_index( const tripoint &p )
+{
+    return p.x * SEEY * MAPSIZE + p.y;
+}
+
+static size_t bucket_index( const tripoint &p )
+{
+    return ( p.x / SEEX ) * MAPSIZE + p.y / SEEY;
+}
 
 Creature_tracker::Creature_tracker()
 {
@@ -34,17 +53,45 @@ const monster &Creature_tracker::find( int index ) const
 
 int Creature_tracker::mon_at( const tripoint &coords ) const
 {
-    const auto iter = monsters_by_location.find( coords );
-    if( iter != monsters_by_location.end() ) {
-        const int critter_id = iter->second;
-        if( !monsters_list[critter_id]->is_dead() ) {
-            return ( int )critter_id;
-        }
+    const int critter_id = location_index( coords );
+    if( critter_id >= 0 && !monsters_list[critter_id]->is_dead() ) {
+        return critter_id;
     }
 
     return -1;
 }
 
+int Creature_tracker::location_index( const tripoint &p ) const
+{
+    if( in_bubble( p ) ) {
+        const auto &layer = monsters_by_location[p.z + OVERMAP_DEPTH];
+        return layer ? ( *layer )[tile_index( p )] - 1 : -1;
+    }
+
+    const auto iter = monsters_outside.find( p );
+    return iter != monsters_outside.end() ? ( int )iter->second : -1;
+}
+
+void Creature_tracker::add_to_location_map( monster &critter, const tripoint &p,
+        const size_t index )
+{
+    if( !in_bubble( p ) ) {
+        monsters_outside[p] = index;
+        return;
+    }
+
+    auto &layer = monsters_by_location[p.z + OVERMAP_DEPTH];
+    if( !layer ) {
+        layer.reset( new location_layer() );
+    }
+    ( *layer )[tile_index( p )] = index + 1;
+
+    auto &bucket = buckets[p.z + OVERMAP_DEPTH][bucket_index( p )];
+    if( std::find( bucket.begin(), bucket.end(), &critter ) == bucket.end() ) {
+        bucket.push_back( &critter );
+    }
+}
+
 bool Creature_tracker::add( monster &critter )
 {
     if( critter.type->id == NULL_ID ) { // Don't wanna spawn null monsters o.O
@@ -75,8 +122,8 @@ bool Creature_tracker::add( monster &critter )
         return false;
     }
 
-    monsters_by_location[critter.pos()] = monsters_list.size();
     monsters_list.push_back( new monster( critter ) );
+    add_to_location_map( *monsters_list.back(), critter.pos(), monsters_list.size() - 1 );
     return true;
 }
 
@@ -111,8 +158,8 @@ bool Creature_tracker::update_pos( const monster &critter, const tripoint &new_p
 
     if( critter_id >= 0 ) {
         if( &critter == monsters_list[critter_id] ) {
-            monsters_by_location.erase( old_pos );
-            monsters_by_location[new_pos] = critter_id;
+            remove_from_location_map( critter );
+            add_to_location_map( *monsters_list[critter_id], new_pos, critter_id );
             return true;
         } else {
             const auto &othermon = *monsters_list[critter_id];
@@ -137,12 +184,43 @@ bool Creature_tracker::update_pos( const monster &critter, const tripoint &new_p
 
 void Creature_tracker::remove_from_location_map( const monster &critter )
 {
+    remove_from_bucket( critter );
+
+    const tripoint &loc = critter.pos();
+    const int index = location_index( loc );
+    if( index < 0 || index >= ( int )monsters_list.size() || monsters_list[index] != &critter ) {
+        return;
+    }
+    if( in_bubble( loc ) ) {
+        ( *monsters_by_location[loc.z + OVERMAP_DEPTH] )[tile_index( loc )] = 0;
+    } else {
+        monsters_outside.erase( loc );
+    }
+}
+
+void Creature_tracker::remove_from_bucket( const monster &critter )
+{
+    const auto remove_from = [&critter]( std::vector<monster *> &bucket ) {
+        const auto iter = std::find( bucket.begin(), bucket.end(), &critter );
+        if( iter == bucket.end() ) {
+            return false;
+        }
+        *iter = bucket.back();
+        bucket.pop_back();
+        return true;
+    };
+
     const tripoint &loc = critter.pos();
-    const auto pos_iter = monsters_by_location.find( loc );
-    if( pos_iter != monsters_by_location.end() ) {
-        const auto &other = find( pos_iter->second );
-        if( &other == &critter ) {
-            monsters_by_location.erase( pos_iter );
+    if( in_bubble( loc ) && remove_from( buckets[loc.z + OVERMAP_DEPTH][bucket_index( loc )] ) ) {
+        return;
+    }
+    // The monster may have been moved without update_pos (the location index has the same
+    // problem, but there a stale entry is harmless and gets fixed by rebuild_cache)
+    for( auto &layer : buckets ) {
+        for( auto &bucket : layer ) {
+            if( remove_from( bucket ) ) {
+                return;
+            }
         }
     }
 }
@@ -161,10 +239,16 @@ void Creature_tracker::remove( const int idx )
     delete monsters_list[idx];
     monsters_list.erase( monsters_list.begin() + idx );
 
-    // Fix indices in monsters_by_location for any zombies that were just moved down 1 place.
-    for( auto &elem : monsters_by_location ) {
-        if( elem.second > ( size_t )idx ) {
-            --elem.second;
+    // Fix indices in the location index for any zombies that were just moved down 1 place.
+    for( size_t i = idx; i < monsters_list.size(); i++ ) {
+        const tripoint &loc = monsters_list[i]->pos();
+        if( location_index( loc ) != ( int )i + 1 ) {
+            continue;
+        }
+        if( in_bubble( loc ) ) {
+            ( *monsters_by_location[loc.z + OVERMAP_DEPTH] )[tile_index( loc )] = i + 1;
+        } else {
+            monsters_outside[loc] = i;
         }
     }
 }
@@ -175,15 +259,23 @@ void Creature_tracker::clear()
         delete monster_ptr;
     }
     monsters_list.clear();
-    monsters_by_location.clear();
+    rebuild_cache();
 }
 
 void Creature_tracker::rebuild_cache()
 {
-    monsters_by_location.clear();
+    for( auto &layer : monsters_by_location ) {
+        layer.reset();
+    }
+    monsters_outside.clear();
+    for( auto &layer : buckets ) {
+        for( auto &bucket : layer ) {
+            bucket.clear();
+        }
+    }
     for( size_t i = 0; i < monsters_list.size(); i++ ) {
         monster &critter = *monsters_list[i];
-        monsters_by_location[critter.pos()] = i;
+        add_to_location_map( critter, critter.pos(), i );
     }
 }
 
@@ -213,10 +305,73 @@ void Creature_tracker::swap_positions( monster &first, monster &second )
     second.spawn( first.pos() );
     first.spawn( temp );
     if( ok ) {
-        monsters_by_location[first.pos()] = first_mdex;
-        monsters_by_location[second.pos()] = second_mdex;
+        add_to_location_map( first, first.pos(), first_mdex );
+        add_to_location_map( second, second.pos(), second_mdex );
     } else {
         // Try to avoid spamming error messages if something weird happens
         rebuild_cache();
     }
 }
+
+void Creature_tracker::for_each_bucket( const tripoint &center, const int radius,
+                                        const std::function<void( const std::vector<monster *> & )> &func ) const
+{
+    const int minx = std::max( 0, center.x - radius ) / SEEX;
+    const int maxx = std::min( SEEX * MAPSIZE - 1, center.x + radius ) / SEEX;
+    const int miny = std::max( 0, center.y - radius ) / SEEY;
+    const int maxy = std::min( SEEY * MAPSIZE - 1, center.y + radius ) / SEEY;
+    const int minz = std::max( -OVERMAP_DEPTH, center.z - radius );
+    const int maxz = std::min( OVERMAP_HEIGHT, center.z + radius );
+    for( int z = minz; z <= maxz; z++ ) {
+        const auto &layer = buckets[z + OVERMAP_DEPTH];
+        for( int smx = minx; smx <= maxx; smx++ ) {
+            for( int smy = miny; smy <= maxy; smy++ ) {
+                const auto &bucket = layer[smx * MAPSIZE + smy];
+                if( !bucket.empty() ) {
+                    func( bucket );
+                }
+            }
+        }
+    }
+}
+
+void Creature_tracker::for_each_in_radius( const tripoint &center, const int radius,
+        const std::function<void( monster & )> &func ) const
+{
+    // rl_dist is never shorter than square_dist, so the buckets in the square contain all
+    // the monsters in range.
+    for_each_bucket( center, radius, [&]( const std::vector<monster *> &bucket ) {
+        for( monster *critter : bucket ) {
+            if( !critter->is_dead() && rl_dist( center, critter->pos() ) <= radius ) {
+                func( *critter );
+            }
+        }
+    } );
+    for( const auto &elem : monsters_outside ) {
+        monster &critter = *monsters_list[elem.second];
+        if( !critter.is_dead() && rl_dist( center, critter.pos() ) <= radius ) {
+            func( critter );
+        }
+    }
+}
+
+monster *Creature_tracker::nearest_hostile( const Creature &observer, const int radius ) const
+{
+    // Seeing is the expensive part, so only check that from the closest monster outwards
+    std::vector<std::pair<int, monster *>> hostiles;
+    for_each_in_radius( observer.pos(), radius, [&]( monster & critter ) {
+        if( &critter != &observer && observer.attitude_to( critter ) == Creature::A_HOSTILE ) {
+            hostiles.emplace_back( rl_dist( observer.pos(), critter.pos() ), &critter );
+        }
+    } );
+    std::stable_sort( hostiles.begin(), hostiles.end(),
+    []( const std::pair<int, monster *> &a, const std::pair<int, monster *> &b ) {
+        return a.first < b.first;
+    } );
+    for( const auto &elem : hostiles ) {
+        if( observer.sees( *elem.second ) ) {
+            return elem.second;
+        }
+    }
+    return nullptr;
+}
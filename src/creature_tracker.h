@@ -2,11 +2,21 @@
 #define CREATURE_TRACKER_H
 
 #include "enums.h"
+#include "game_constants.h"
+
+#include <array>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
+class Creature;
 class monster;
 
+/**
+ * Owns all active monsters. Monsters inside the reality bubble are also indexed by
+ * tile (for @ref mon_at) and by submap (for radius queries).
+ */
 class Creature_tracker
 {
     public:
@@ -31,11 +41,41 @@ class Creature_tracker
         /** Swaps the positions of two monsters */
         void swap_positions( monster &first, monster &second );
 
+        /**
+         * Calls func for every living monster within the given distance (@ref rl_dist)
+         * of center, including those on other z-levels. Only the submaps in range are
+         * visited, the order of the calls is unspecified.
+         */
+        void for_each_in_radius( const tripoint &center, int radius,
+                                 const std::function<void( monster & )> &func ) const;
+        /**
+         * The closest living monster within radius that the observer can see and is hostile to
+         * (see @ref Creature::attitude_to), or nullptr if there is none.
+         */
+        monster *nearest_hostile( const Creature &observer, int radius ) const;
+
     private:
         std::vector<monster *> monsters_list;
-        std::unordered_map<tripoint, size_t> monsters_by_location;
-        /** Remove the monsters entry in @ref monsters_by_location */
+
+        /** Index + 1 of the monster on each tile of a z-level, 0 for none */
+        using location_layer = std::array<int, SEEX *MAPSIZE *SEEY *MAPSIZE>;
+        /** Indexed by z + OVERMAP_DEPTH, allocated on the first monster on that z-level */
+        std::array<std::unique_ptr<location_layer>, OVERMAP_LAYERS> monsters_by_location;
+        /** Monsters outside of the reality bubble, they are not in any bucket either */
+        std::unordered_map<tripoint, size_t> monsters_outside;
+        /** Monsters in each submap, indexed by z + OVERMAP_DEPTH and then submap x * MAPSIZE + y */
+        std::array<std::array<std::vector<monster *>, MAPSIZE *MAPSIZE>, OVERMAP_LAYERS> buckets;
+
+        /** Index of the monster at p in the location index, or -1 */
+        int location_index( const tripoint &p ) const;
+        /** Stores critter as the monster with the given index at p */
+        void add_to_location_map( monster &critter, const tripoint &p, size_t index );
+        /** Remove the monsters entry in the location index and its bucket */
         void remove_from_location_map( const monster &critter );
+        void remove_from_bucket( const monster &critter );
+        /** Calls func for each bucket overlapping the square [center - radius, center + radius] */
+        void for_each_bucket( const tripoint &center, int radius,
+                              const std::function<void( const std::vector<monster *> & )> &func ) const;
 };
 
 #endif
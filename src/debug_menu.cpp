@@ -12,6 +12,12 @@
 #include "overmapbuffer.h"
 #include "vitamin.h"
 #include "mission.h"
+#include "path_info.h"
+#include "turn_profiler.h"
+#include "map.h"
+#include "mapbuffer.h"
+#include "options.h"
+#include "worldfactory.h"
 
 #include <algorithm>
 #include <vector>
@@ -586,4 +592,58 @@ void mission_debug::edit_mission( mission &m )
     }
 }
 
+void turn_profile()
+{
+    enum { TP_DUMP, TP_RESET };
+
+    uimenu tpmenu;
+    tpmenu.return_invalid = true;
+    const auto &los = g->m.get_los_cache_stats();
+    const uint64_t los_queries = los.hits + los.misses;
+    tpmenu.text = turn_profiler::summary() + "\n" +
+                  string_format( _( "Line of sight cache: %llu hits, %llu misses (%.1f%%), "
+                                    "%llu invalidations, %llu fields of view" ),
+                                 static_cast<unsigned long long>( los.hits ),
+                                 static_cast<unsigned long long>( los.misses ),
+                                 los_queries > 0 ? 100.0 * los.hits / los_queries : 0.0,
+                                 static_cast<unsigned long long>( los.invalidations ),
+                                 static_cast<unsigned long long>( los.fields ) );
+    tpmenu.addentry( TP_DUMP, true, 'd', _( "Write to %s" ), FILENAMES["turn_profile"].c_str() );
+    tpmenu.addentry( TP_RESET, true, 'r', "%s", _( "Reset statistics" ) );
+
+    tpmenu.query();
+    switch( tpmenu.ret ) {
+        case TP_DUMP:
+            if( turn_profiler::dump( FILENAMES["turn_profile"] ) ) {
+                add_msg( m_info, _( "Turn profile written to %s." ), FILENAMES["turn_profile"].c_str() );
+            }
+            break;
+        case TP_RESET:
+            turn_profiler::reset();
+            g->m.reset_los_cache_stats();
+            break;
+    }
+}
+
+void convert_map_files()
+{
+    auto &format = get_options().get_world_option( "MAP_FORMAT" );
+
+    uimenu fmenu;
+    fmenu.return_invalid = true;
+    fmenu.text = string_format( _( "Map files are stored as %s. Convert them to:" ),
+                                format.getValueName().c_str() );
+    fmenu.addentry( 0, format.getValue() != "json", 'j', "%s", _( "JSON" ) );
+    fmenu.addentry( 1, format.getValue() != "binary", 'b', "%s", _( "Binary" ) );
+
+    fmenu.query();
+    if( fmenu.ret != 0 && fmenu.ret != 1 ) {
+        return;
+    }
+    format.setValue( fmenu.ret == 0 ? "json" : "binary" );
+    world_generator->save_world();
+    const int converted = MAPBUFFER.convert_files();
+    add_msg( m_info, _( "Converted %d map files to %s." ), converted, format.getValueName().c_str() );
+}
+
 }
@@ -18,6 +18,9 @@ void wishmutate( player *p );
 void wishskill( player *p );
 void mutation_wish();
 
+void turn_profile();
+void convert_map_files();
+
 class mission_debug;
 
 }
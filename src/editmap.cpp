@@ -1769,6 +1769,7 @@ int editmap::mapgen_preview( real_coords &tc, uimenu &gmenu )
                             submap *destsm = g->m.get_submap_at_grid( target_sub.x + x, target_sub.y + y, target.z );
                             submap *srcsm = tmpmap.get_submap_at_grid( x, y, target.z );
                             destsm->is_uniform = false;
+                            destsm->mark_dirty();
                             srcsm->is_uniform = false;
 
                             for( auto &v : destsm->vehicles ) {
@@ -1995,8 +1996,6 @@ void editmap::cleartmpmap( tinymap &tmpmap )
         delete smap;
     }
 
-    auto &ch = tmpmap.get_cache( target.z );
-    std::memset( ch.veh_exists_at, 0, sizeof( ch.veh_exists_at ) );
-    ch.veh_cached_parts.clear();
-    ch.vehicle_list.clear();
+    tmpmap.clear_vehicle_cache( target.z );
+    tmpmap.get_cache( target.z ).vehicle_list.clear();
 }
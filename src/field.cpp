@@ -469,29 +469,32 @@ bool map::process_fields()
     bool dirty_transparency_cache = false;
     const int minz = zlevels ? -OVERMAP_DEPTH : abs_sub.z;
     const int maxz = zlevels ? OVERMAP_HEIGHT : abs_sub.z;
-    bool zlev_dirty;
     for( int z = minz; z <= maxz; z++ ) {
-        zlev_dirty = false;
         for( int x = 0; x < my_MAPSIZE; x++ ) {
             for( int y = 0; y < my_MAPSIZE; y++ ) {
                 submap * const current_submap = get_submap_at_grid( x, y, z );
                 if( current_submap->field_count > 0 ) {
-                    const bool cur_dirty = process_fields_in_submap( current_submap, x, y, z );
-                    zlev_dirty |= cur_dirty;
+                    // Fields age every turn
+                    current_submap->mark_dirty();
+                }
+                if( current_submap->field_count > 0 &&
+                    process_fields_in_submap( current_submap, x, y, z ) ) {
+                    // For now, just always dirty the transparency cache
+                    // when a field might possibly be changed.
+                    // Fields spread and decay into the neighbouring submaps too.
+                    // TODO: check if there are any fields(mostly fire)
+                    //       that frequently change, if so set the dirty
+                    //       flag, otherwise only set the dirty flag if
+                    //       something actually changed
+                    for( int dx = -1; dx <= 1; dx++ ) {
+                        for( int dy = -1; dy <= 1; dy++ ) {
+                            set_transparency_cache_dirty( tripoint( ( x + dx ) * SEEX, ( y + dy ) * SEEY, z ) );
+                        }
+                    }
+                    dirty_transparency_cache = true;
                 }
             }
         }
-
-        if( zlev_dirty ) {
-            // For now, just always dirty the transparency cache
-            // when a field might possibly be changed.
-            // TODO: check if there are any fields(mostly fire)
-            //       that frequently change, if so set the dirty
-            //       flag, otherwise only set the dirty flag if
-            //       something actually changed
-            set_transparency_cache_dirty( z );
-            dirty_transparency_cache = true;
-        }
     }
 
     return dirty_transparency_cache;
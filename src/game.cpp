@@ -90,6 +90,8 @@
 #include "scent_map.h"
 #include "safemode_ui.h"
 #include "game_constants.h"
+#include "turn_profiler.h"
+#include "save_writer.h"
 
 #include <map>
 #include <set>
@@ -1031,6 +1033,7 @@ bool game::cleanup_at_end()
 
         // and the overmap, and the local map.
         save_maps(); //Omap also contains the npcs who need to be saved.
+        save_writer::get().flush();
     }
 
     if (uquit == QUIT_DIED || uquit == QUIT_SUICIDE) {
@@ -1293,6 +1296,24 @@ static int veh_lumi( vehicle &veh )
     return LIGHT_RANGE((veh_luminance * 3));
 }
 
+void game::generate_map_ahead()
+{
+    const vehicle *veh = u.in_vehicle ? m.veh_at( u.pos() ) : nullptr;
+    if( veh == nullptr || veh->velocity == 0 ) {
+        // On foot the map shifts rarely, one overmap terrain per turn keeps up with it.
+        m.generate_ahead( point( 0, 0 ), 1 );
+        return;
+    }
+    // Moving backwards has negative velocity
+    const rl_vec2d dir = veh->move_vec() * ( veh->velocity > 0 ? 1 : -1 );
+    // Both signs within 22.5 degrees of a diagonal
+    static const float min_component = 0.38f;
+    const point heading( std::fabs( dir.x ) > min_component ? sgn( dir.x ) : 0,
+                         std::fabs( dir.y ) > min_component ? sgn( dir.y ) : 0 );
+    // About one more per 30 mph, the map shifts once every few turns on a highway.
+    m.generate_ahead( heading, 1 + std::abs( veh->velocity ) / 3000 );
+}
+
 void game::calc_driving_offset(vehicle *veh)
 {
     if (veh == nullptr || !get_option<bool>( "DRIVING_VIEW_OFFSET" ) ) {
@@ -1396,6 +1417,8 @@ void game::calc_driving_offset(vehicle *veh)
 // Returns true if game is over (death, saved, quit, etc)
 bool game::do_turn()
 {
+    // Ends the profiled turn on every return below
+    turn_profiler::turn_guard profiled_turn;
     if (is_game_over()) {
         return cleanup_at_end();
     }
@@ -1411,7 +1434,10 @@ bool game::do_turn()
         load_npcs();
     }
 
-    process_events();
+    {
+        turn_profiler::scoped_timer timer( turn_phase::process_events );
+        process_events();
+    }
     mission::process_all();
     if (calendar::turn.hours() == 0 && calendar::turn.minutes() == 0 &&
         calendar::turn.seconds() == 0) { // Midnight!
@@ -1440,6 +1466,8 @@ bool game::do_turn()
         !u.is_dead_state()) {
         autosave();
     }
+    // Show errors of the saves that were written in the background
+    save_writer::get().report_errors();
 
     update_weather();
     reset_light_level();
@@ -1509,39 +1537,75 @@ bool game::do_turn()
         scent.set( u.pos(), u.scent );
         overmap_buffer.set_scent( u.global_omt_location(),  u.scent );
     }
-    scent.update( u.pos(), m );
+    {
+        turn_profiler::scoped_timer timer( turn_phase::scent_update );
+        scent.update( u.pos(), m );
+    }
 
     // We need floor cache before checking falling 'n stuff
-    m.build_floor_caches();
-
-    m.process_falling();
-    m.vehmove();
+    {
+        turn_profiler::scoped_timer timer( turn_phase::build_floor_caches );
+        m.build_floor_caches();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_phase::process_falling );
+        m.process_falling();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_phase::vehmove );
+        m.vehmove();
+    }
 
     // Process power and fuel consumption for all vehicles, including off-map ones.
     // m.vehmove used to do this, but now it only give them moves instead.
-    for( auto &elem : MAPBUFFER ) {
-        tripoint sm_loc = elem.first;
-        point sm_topleft = sm_to_ms_copy(sm_loc.x, sm_loc.y);
-        point in_reality = m.getlocal(sm_topleft);
+    {
+        turn_profiler::scoped_timer timer( turn_phase::vehicle_idle );
+        for( auto &elem : MAPBUFFER ) {
+            tripoint sm_loc = elem.first;
+            point sm_topleft = sm_to_ms_copy(sm_loc.x, sm_loc.y);
+            point in_reality = m.getlocal(sm_topleft);
 
-        submap *sm = elem.second;
+            submap *sm = elem.second;
 
-        const bool in_bubble_z = m.has_zlevels() || sm_loc.z == get_levz();
-        for( auto &veh : sm->vehicles ) {
-            veh->idle( in_bubble_z && m.inbounds(in_reality.x, in_reality.y) );
+            const bool in_bubble_z = m.has_zlevels() || sm_loc.z == get_levz();
+            for( auto &veh : sm->vehicles ) {
+                veh->idle( in_bubble_z && m.inbounds(in_reality.x, in_reality.y) );
+            }
         }
     }
-    m.process_fields();
-    m.process_active_items();
+    {
+        turn_profiler::scoped_timer timer( turn_phase::generate_ahead );
+        generate_map_ahead();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_phase::process_fields );
+        m.process_fields();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_phase::process_active_items );
+        m.process_active_items();
+    }
     m.creature_in_field( u );
 
     // Apply sounds from previous turn to monster and NPC AI.
-    sounds::process_sounds();
+    {
+        turn_profiler::scoped_timer timer( turn_phase::sound_processing );
+        sounds::process_sounds();
+    }
     // Update vision caches for monsters. If this turns out to be expensive,
     // consider a stripped down cache just for monsters.
-    m.build_map_cache( get_levz(), true );
-    monmove();
-    update_stair_monsters();
+    {
+        turn_profiler::scoped_timer timer( turn_phase::build_map_cache );
+        m.build_map_cache( get_levz(), true );
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_phase::monmove );
+        monmove();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_phase::update_stair_monsters );
+        update_stair_monsters();
+    }
     u.process_turn();
     if( u.moves < 0 && get_option<bool>( "FORCE_REDRAW" ) ) {
         draw();
@@ -1550,6 +1614,7 @@ bool game::do_turn()
     u.process_active_items();
 
     if (get_levz() >= 0 && !u.is_underwater()) {
+        turn_profiler::scoped_timer timer( turn_phase::weather_effects );
         weather_data(weather).effect();
     }
 
@@ -3290,7 +3355,8 @@ bool game::handle_action()
 
         case ACTION_SAVE:
             if (query_yn(_("Save and quit?"))) {
-                if(save()) {
+                // Rewrite everything, autosaves only write what changed
+                if( save( true ) && save_writer::get().flush() ) {
                     u.moves = 0;
                     uquit = QUIT_SAVED;
                 }
@@ -3791,7 +3857,7 @@ bool game::save_factions_missions_npcs()
     }
 
     std::string masterfile = world_generator->active_world->world_path + "/master.gsav";
-    return write_to_file_exclusive( masterfile, [&]( std::ostream &fout ) {
+    return write_to_file_exclusive_async( masterfile, [&]( std::ostream &fout ) {
         serialize_master(fout);
     }, _( "factions data" ) );
 }
@@ -3802,12 +3868,12 @@ bool game::save_artifacts()
     return ::save_artifacts( artfilename );
 }
 
-bool game::save_maps()
+bool game::save_maps( const bool save_all )
 {
     try {
         m.save();
         overmap_buffer.save(); // can throw
-        MAPBUFFER.save(); // can throw
+        MAPBUFFER.save( false, save_all ); // can throw
         return true;
     } catch( const std::exception &err ) {
         popup( _( "Failed to save the maps: %s" ), err.what() );
@@ -3818,7 +3884,7 @@ bool game::save_maps()
 bool game::save_uistate()
 {
     std::string savefile = world_generator->active_world->world_path + "/uistate.json";
-    return write_to_file_exclusive( savefile, [&]( std::ostream &fout ) {
+    return write_to_file_exclusive_async( savefile, [&]( std::ostream &fout ) {
         fout << uistate.serialize();
     }, _( "uistate data" ) );
 }
@@ -3827,26 +3893,26 @@ bool game::save_player_data()
 {
     const std::string playerfile = world_generator->active_world->world_path + "/" + base64_encode(u.name);
 
-    const bool saved_data = write_to_file( playerfile + ".sav", [&]( std::ostream &fout ) {
+    const bool saved_data = write_to_file_async( playerfile + ".sav", [&]( std::ostream &fout ) {
         serialize(fout);
     }, _( "player data" ) );
-    const bool saved_weather = write_to_file( playerfile + ".weather", [&]( std::ostream &fout ) {
+    const bool saved_weather = write_to_file_async( playerfile + ".weather", [&]( std::ostream &fout ) {
         save_weather(fout);
     }, _( "weather state" ) );
-    const bool saved_log = write_to_file( playerfile + ".log", [&]( std::ostream &fout ) {
+    const bool saved_log = write_to_file_async( playerfile + ".log", [&]( std::ostream &fout ) {
         fout << u.dump_memorial();
     }, _( "player memorial" ) );
 
     return saved_data && saved_weather && saved_log;
 }
 
-bool game::save()
+bool game::save( const bool save_all_maps )
 {
     try {
         if ( !save_player_data() ||
              !save_factions_missions_npcs() ||
              !save_artifacts() ||
-             !save_maps() ||
+             !save_maps( save_all_maps ) ||
              !get_auto_pickup().save_character() ||
              !get_safemode().save_character() ||
              !save_uistate()){
@@ -3875,6 +3941,8 @@ static bool isForbidden(std::string candidate)
 // If it's false, just avoid deleting the two config files and the directory itself.
 void game::delete_world(std::string worldname, bool delete_folder)
 {
+    // Don't let pending writes recreate the files
+    save_writer::get().flush();
     std::string worldpath = world_generator->all_worlds[worldname]->world_path;
     std::set<std::string> directory_paths;
 
@@ -4053,7 +4121,9 @@ void game::debug()
                        _( "Overmap editor" ),         // 30
                        _( "Draw benchmark (5 seconds)" ),    // 31
                        _( "Teleport - Adjacent overmap" ),   // 32
-                       _( "Quit to Main Menu" ),    // 33
+                       _( "Display turn profile" ),   // 33
+                       _( "Convert map files" ),    // 34
+                       _( "Quit to Main Menu" ),    // 35
                        _( "Cancel" ),
                        NULL );
     int veh_num;
@@ -4408,6 +4478,12 @@ void game::debug()
             debug_menu::teleport_overmap();
             break;
         case 33:
+            debug_menu::turn_profile();
+            break;
+        case 34:
+            debug_menu::convert_map_files();
+            break;
+        case 35:
             if( query_yn( _( "Quit without saving? This may cause issues such as duplicated or missing items and vehicles!" ) ) ) {
                 u.moves = 0;
                 uquit = QUIT_NOSAVED;
@@ -5552,9 +5628,13 @@ Creature *game::is_hostile_very_close()
 
 Creature *game::is_hostile_within(int distance)
 {
-    for( auto &critter : u.get_visible_creatures( distance ) ) {
-        if( u.attitude_to( *critter ) == Creature::A_HOSTILE ) {
-            return critter;
+    if( monster *const critter = critter_tracker->nearest_hostile( u, distance ) ) {
+        return critter;
+    }
+    for( npc *const p : active_npc ) {
+        if( p->pos() != u.pos() && rl_dist( u.pos(), p->pos() ) <= distance &&
+            u.attitude_to( *p ) == Creature::A_HOSTILE && u.sees( *p ) ) {
+            return p;
         }
     }
 
@@ -5929,29 +6009,14 @@ void game::monmove()
 {
     cleanup_dead();
 
-    // Make sure these don't match the first time around.
-    tripoint cached_lev = m.get_abs_sub() + tripoint( 1, 0, 0 );
-
+    // monster::plan() only looks for monsters of the factions that are around. Monsters
+    // that appear or change sides during the turn are noticed from the next turn on.
     mfactions monster_factions;
-    const auto &playerfaction = mfaction_str_id( "player" );
-    for (size_t i = 0; i < num_zombies(); i++) {
-        // The first time through, and any time the map has been shifted,
-        // recalculate monster factions.
-        if( cached_lev != m.get_abs_sub() ) {
-            // monster::plan() needs to know about all monsters on the same team as the monster.
-            monster_factions.clear();
-            for( int i = 0, numz = num_zombies(); i < numz; i++ ) {
-                monster &critter = zombie( i );
-                if( critter.friendly == 0 ) {
-                    // Only 1 faction per mon at the moment.
-                    monster_factions[ critter.faction ].insert( i );
-                } else {
-                    monster_factions[ playerfaction ].insert( i );
-                }
-            }
-            cached_lev = m.get_abs_sub();
-        }
+    for( size_t i = 0; i < num_zombies(); i++ ) {
+        monster_factions.insert( zombie( i ).planning_faction() );
+    }
 
+    for (size_t i = 0; i < num_zombies(); i++) {
         monster &critter = critter_tracker->find(i);
         while (!critter.is_dead() && !critter.can_move_to(critter.pos())) {
             // If we can't move to our current position, assign us to a new one
@@ -6409,6 +6474,8 @@ void game::use_computer( const tripoint &p )
     }
 
     used->use();
+    // Hacking may have changed the security of the computer
+    m.set_submap_dirty( p );
 
     refresh_all();
 }
@@ -12969,7 +13036,10 @@ void game::vertical_shift( const int z_after )
     u.grab_point = tripoint_zero;
     u.grab_type = OBJECT_NONE;
 
-    scent.reset();
+    // With z-levels, the scent of the other levels stays valid
+    if( !m.has_zlevels() ) {
+        scent.reset();
+    }
 
     u.setz( z_after );
     const int z_before = get_levz();
@@ -13109,6 +13179,8 @@ void game::update_map(int &x, int &y)
 
     // Update what parts of the world map we can see
     update_overmap_seen();
+    // Have the next overmap ready before the player gets there
+    overmap_buffer.generate_ahead( u.global_omt_location() );
 }
 
 void game::update_overmap_seen()
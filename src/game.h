@@ -196,8 +196,11 @@ class game
         /** write statisics to stdout and @return true if sucessful */
         bool dump_stats( const std::string& what, dump_mode mode, const std::vector<std::string> &opts );
 
-        /** Returns false if saving failed. */
-        bool save();
+        /**
+         * Returns false if saving failed.
+         * @param save_all_maps Write all loaded map quads, not only the changed ones.
+         */
+        bool save( bool save_all_maps = false );
         /** Deletes the given world. If delete_folder is true delete all the files and directories
          *  of the given world folder. Else just avoid deleting the two config files and the directory
          *  itself. */
@@ -555,6 +558,9 @@ class game
         // the options for this feautre is dactivated or if veh is NULL,
         // the function set the driving offset to (0,0)
         void calc_driving_offset(vehicle *veh = NULL);
+        // Generates the map ahead of the player, in the direction of travel,
+        // so moving the reality bubble only has to load it (see map::generate_ahead).
+        void generate_map_ahead();
 
         /**
          * @name Liquid handling
@@ -707,13 +713,14 @@ class game
 
         /** Attempt to load first valid save (if any) in world */
         bool load( const std::string &world );
+        /** Starts a new game in a world, the player must have been created already. */
+        bool start_game( std::string worldname );
 
     private:
         // Game-start procedures
         void load( std::string worldname, std::string name ); // Load a player-specific save file
         bool load_master(std::string worldname); // Load the master data file, with factions &c
         void load_weather(std::istream &fin);
-        bool start_game(std::string worldname); // Starts a new game in a world
         void start_special_game(special_game_id gametype); // See gamemode.cpp
 
         //private save functions.
@@ -723,7 +730,7 @@ class game
         // returns false if saving failed for whatever reason
         bool save_artifacts();
         // returns false if saving failed for whatever reason
-        bool save_maps();
+        bool save_maps( bool save_all = false );
         void save_weather(std::ostream &fout);
         // returns false if saving failed for whatever reason
         bool save_uistate();
@@ -272,13 +272,13 @@ void DynamicDataLoader::load_data_from_path( const std::string &path, const std:
         const std::string &file = files_i;
         // open the file as a stream
         std::ifstream infile(file.c_str(), std::ifstream::in | std::ifstream::binary);
-        // and stuff it into ram
-        std::istringstream iss(
-            std::string(
-                (std::istreambuf_iterator<char>(infile)),
-                std::istreambuf_iterator<char>()
-            )
+        // and stuff it into ram, JsonIn parses from memory much faster
+        const std::string data(
+            (std::istreambuf_iterator<char>(infile)),
+            std::istreambuf_iterator<char>()
         );
+        memory_streambuf buffer( data.data(), data.size() );
+        std::istream iss( &buffer );
         try {
             // parse it
             JsonIn jsin(iss);
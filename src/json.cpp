@@ -691,33 +691,113 @@ bool JsonArray::has_object(int i)
     return jsin->test_object();
 }
 
+memory_streambuf::pos_type memory_streambuf::seekoff( off_type off, std::ios_base::seekdir dir,
+        std::ios_base::openmode which )
+{
+    const off_type base = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ?
+                          gptr() - eback() : egptr() - eback();
+    const off_type pos = base + off;
+    if( ( which & std::ios_base::in ) == 0 || pos < 0 || pos > egptr() - eback() ) {
+        return pos_type( off_type( -1 ) );
+    }
+    set_cursor( eback() + pos );
+    return pos_type( pos );
+}
+
+memory_streambuf::pos_type memory_streambuf::seekpos( pos_type pos, std::ios_base::openmode which )
+{
+    return seekoff( off_type( pos ), std::ios_base::beg, which );
+}
+
+JsonIn::JsonIn( std::istream &s ) : stream( &s ),
+    buffer( dynamic_cast<memory_streambuf *>( s.rdbuf() ) )
+{
+}
+
 int JsonIn::tell()
 {
+    if( buffer != nullptr ) {
+        return buffer->cursor() - buffer->begin();
+    }
     return stream->tellg();
 }
 char JsonIn::peek()
 {
+    if( buffer != nullptr ) {
+        if( buffer->cursor() < buffer->end() ) {
+            return *buffer->cursor();
+        }
+        // Like peeking at the end of a stream
+        stream->setstate( std::ios::eofbit );
+        return (char)EOF;
+    }
     return (char)stream->peek();
 }
 bool JsonIn::good()
 {
+    if( buffer != nullptr && buffer->cursor() == buffer->end() ) {
+        return false;
+    }
     return stream->good();
 }
 
 void JsonIn::seek(int pos)
 {
     stream->clear();
-    stream->seekg(pos);
+    if( buffer != nullptr && pos >= 0 && pos <= buffer->end() - buffer->begin() ) {
+        buffer->set_cursor( buffer->begin() + pos );
+    } else {
+        stream->seekg(pos);
+    }
     ate_separator = false;
 }
 
+void JsonIn::advance()
+{
+    if( buffer != nullptr ) {
+        buffer->set_cursor( buffer->cursor() + 1 );
+    } else {
+        stream->get();
+    }
+}
+
 void JsonIn::eat_whitespace()
 {
+    if( buffer != nullptr ) {
+        const char *pos = buffer->cursor();
+        const char *const end = buffer->end();
+        while( pos < end && is_whitespace( *pos ) ) {
+            ++pos;
+        }
+        buffer->set_cursor( pos );
+        if( pos == end ) {
+            stream->setstate( std::ios::eofbit );
+        }
+        return;
+    }
     while (is_whitespace(peek())) {
         stream->get();
     }
 }
 
+const char *JsonIn::find_plain_string_end() const
+{
+    // The cursor is at the opening quote
+    const char *const begin = buffer->cursor() + 1;
+    const char *const end = buffer->end();
+    const char *const quote = static_cast<const char *>( memchr( begin, '"', end - begin ) );
+    if( quote == nullptr ) {
+        return nullptr;
+    }
+    for( const char *pos = begin; pos < quote; ++pos ) {
+        // Escapes, line breaks and control characters
+        if( *pos == '\\' || static_cast<unsigned char>( *pos ) < 0x20 ) {
+            return nullptr;
+        }
+    }
+    return quote;
+}
+
 void JsonIn::uneat_whitespace()
 {
     while (tell() > 0) {
@@ -750,7 +830,7 @@ void JsonIn::skip_separator()
         if( ate_separator ) {
             error("duplicate separator");
         }
-        stream->get();
+        advance();
         ate_separator = true;
     } else if (ch == ']' || ch == '}' || ch == ':') {
         // okay
@@ -779,6 +859,11 @@ void JsonIn::skip_pair_separator()
 {
     char ch;
     eat_whitespace();
+    if( buffer != nullptr && !ate_separator && peek() == ':' ) {
+        advance();
+        ate_separator = true;
+        return;
+    }
     stream->get(ch);
     if (ch != ':') {
         std::stringstream err;
@@ -794,6 +879,13 @@ void JsonIn::skip_string()
 {
     char ch;
     eat_whitespace();
+    if( buffer != nullptr && peek() == '"' ) {
+        if( const char *const quote = find_plain_string_end() ) {
+            buffer->set_cursor( quote + 1 );
+            end_value();
+            return;
+        }
+    }
     stream->get(ch);
     if (ch != '"') {
         std::stringstream err;
@@ -908,6 +1000,17 @@ void JsonIn::skip_number()
 {
     char ch;
     eat_whitespace();
+    if( buffer != nullptr ) {
+        const char *pos = buffer->cursor();
+        const char *const end = buffer->end();
+        while( pos < end && ( *pos == '+' || *pos == '-' || ( *pos >= '0' && *pos <= '9' ) ||
+                              *pos == 'e' || *pos == 'E' || *pos == '.' ) ) {
+            ++pos;
+        }
+        buffer->set_cursor( pos );
+        end_value();
+        return;
+    }
     // skip all of (+-0123456789.eE)
     while (stream->good()) {
         stream->get(ch);
@@ -934,6 +1037,15 @@ std::string JsonIn::get_string()
     bool backslash = false;
     char unihex[5] = "0000";
     eat_whitespace();
+    if( buffer != nullptr && peek() == '"' ) {
+        // Most strings have no escapes, take them from the buffer as they are
+        if( const char *const quote = find_plain_string_end() ) {
+            s.assign( buffer->cursor() + 1, quote );
+            buffer->set_cursor( quote + 1 );
+            end_value();
+            return s;
+        }
+    }
     int startpos = tell();
     // the first character had better be a '"'
     stream->get(ch);
@@ -1023,6 +1135,62 @@ long JsonIn::get_long()
     return (long)get_float();
 }
 
+/**
+ * Parses a number at the cursor of the buffer the same way as @ref JsonIn::get_float.
+ * @return false if the number is malformed, the stream path reports the error then.
+ */
+static bool get_float_from_buffer( memory_streambuf &buffer, int &i, int &e, int &mod_e )
+{
+    const auto is_digit = []( const char ch ) {
+        return ch >= '0' && ch <= '9';
+    };
+    const char *pos = buffer.cursor();
+    const char *const end = buffer.end();
+    bool neg = false;
+    if( pos < end && *pos == '-' ) {
+        neg = true;
+        ++pos;
+    }
+    if( pos == end || ( *pos != '.' && !is_digit( *pos ) ) ) {
+        return false;
+    }
+    if( *pos == '0' && pos + 1 < end && is_digit( pos[1] ) ) {
+        // leading zeros
+        return false;
+    }
+    for( ; pos < end && is_digit( *pos ); ++pos ) {
+        i *= 10;
+        i += *pos - '0';
+    }
+    if( pos < end && *pos == '.' ) {
+        for( ++pos; pos < end && is_digit( *pos ); ++pos ) {
+            i *= 10;
+            i += *pos - '0';
+            mod_e -= 1;
+        }
+    }
+    if( neg ) {
+        i *= -1;
+    }
+    if( pos < end && ( *pos == 'e' || *pos == 'E' ) ) {
+        ++pos;
+        bool neg_e = false;
+        if( pos < end && ( *pos == '-' || *pos == '+' ) ) {
+            neg_e = *pos == '-';
+            ++pos;
+        }
+        for( ; pos < end && is_digit( *pos ); ++pos ) {
+            e *= 10;
+            e += *pos - '0';
+        }
+        if( neg_e ) {
+            e *= -1;
+        }
+    }
+    buffer.set_cursor( pos );
+    return true;
+}
+
 double JsonIn::get_float()
 {
     // this could maybe be prettier?
@@ -1032,6 +1200,10 @@ double JsonIn::get_float()
     int e = 0;
     int mod_e = 0;
     eat_whitespace();
+    if( buffer != nullptr && get_float_from_buffer( *buffer, i, e, mod_e ) ) {
+        end_value();
+        return i * std::pow(10.0f, e + mod_e);
+    }
     stream->get(ch);
     if (ch == '-') {
         neg = true;
@@ -1137,7 +1309,7 @@ void JsonIn::start_array()
 {
     eat_whitespace();
     if (peek() == '[') {
-        stream->get();
+        advance();
         ate_separator = false;
         return;
     } else {
@@ -1157,7 +1329,7 @@ bool JsonIn::end_array()
             uneat_whitespace();
             error("separator not strictly allowed at end of array");
         }
-        stream->get();
+        advance();
         end_value();
         return true;
     } else {
@@ -1170,7 +1342,7 @@ void JsonIn::start_object()
 {
     eat_whitespace();
     if (peek() == '{') {
-        stream->get();
+        advance();
         ate_separator = false; // not that we want to
         return;
     } else {
@@ -1190,7 +1362,7 @@ bool JsonIn::end_object()
             uneat_whitespace();
             error("separator not strictly allowed at end of object");
         }
-        stream->get();
+        advance();
         end_value();
         return true;
     } else {
@@ -10,6 +10,7 @@
 #include <map>
 #include <set>
 #include <stdexcept>
+#include <streambuf>
 
 /* Cataclysm-DDA homegrown JSON tools
  * copyright CC-BY-SA-3.0 2013 CleverRaven
@@ -77,6 +78,42 @@ inline E string_to_enum_look_up( const C &container, const std::string &data )
 /*@}*/
 }
 
+/**
+ * A stream buffer reading from a block of memory, without copying it. The memory must
+ * outlive the buffer.
+ *
+ * A @ref JsonIn reading from a stream that uses one of these scans the memory directly
+ * instead of getting every character through the stream, which is a lot faster. See
+ * @ref read_from_file, which reads whole files into memory for that reason.
+ */
+class memory_streambuf : public std::streambuf
+{
+    public:
+        memory_streambuf( const char *data, size_t size ) {
+            char *const begin = const_cast<char *>( data );
+            setg( begin, begin, begin + size );
+        }
+
+        const char *begin() const {
+            return eback();
+        }
+        const char *end() const {
+            return egptr();
+        }
+        /** The position of the next character to read */
+        const char *cursor() const {
+            return gptr();
+        }
+        void set_cursor( const char *pos ) {
+            setg( eback(), const_cast<char *>( pos ), egptr() );
+        }
+
+    protected:
+        pos_type seekoff( off_type off, std::ios_base::seekdir dir,
+                          std::ios_base::openmode which = std::ios_base::in ) override;
+        pos_type seekpos( pos_type pos, std::ios_base::openmode which = std::ios_base::in ) override;
+};
+
 /* JsonIn
  * ======
  *
@@ -161,14 +198,25 @@ class JsonIn
 {
     private:
         std::istream *stream;
+        /** The buffer of the stream, if it reads from memory, nullptr otherwise */
+        memory_streambuf *buffer;
         bool ate_separator = false;
 
         void skip_separator();
         void skip_pair_separator();
         void end_value();
+        /** Consumes the next character, which must have been peeked at. */
+        void advance();
+        /**
+         * Scans the string at the cursor of the buffer.
+         * @return The end quote, or nullptr if the string isn't plain characters up to the
+         * end quote on the same line. Those are left to the slow path, which handles
+         * escapes and errors.
+         */
+        const char *find_plain_string_end() const;
 
     public:
-        JsonIn( std::istream &s ) : stream( &s ) {}
+        JsonIn( std::istream &s );
 
         bool get_ate_separator()
         {
@@ -13,9 +13,14 @@
 #include "weather.h"
 #include "shadowcasting.h"
 #include "messages.h"
+#include "thread_pool.h"
 
+#include <algorithm>
+#include <bitset>
 #include <cmath>
 #include <cstring>
+#include <iterator>
+#include <memory>
 
 #define INBOUNDS(x, y) \
     (x >= 0 && x < SEEX * MAPSIZE && y >= 0 && y < SEEY * MAPSIZE)
@@ -38,7 +43,7 @@ void map::add_light_from_items( const tripoint &p, std::list<item>::iterator beg
         int idir = 0;   // otherwise, it's a light_arc pointed in this direction
         if( itm_it->getlight( ilum, iwidth, idir ) ) {
             if( iwidth > 0 ) {
-                apply_light_arc( p, idir, ilum, iwidth );
+                add_light_emitter( light_emitter( light_emitter::LIGHT_ARC, p, ilum, idir, iwidth ) );
             } else {
                 add_light_source( p, ilum );
             }
@@ -57,13 +62,13 @@ void map::build_transparency_cache( const int zlev )
         return;
     }
 
-    // Default to just barely not transparent.
-    std::uninitialized_fill_n(
-        &transparency_cache[0][0], MAPSIZE*SEEX * MAPSIZE*SEEY, LIGHT_TRANSPARENCY_OPEN_AIR);
-
-    // Traverse the submaps in order
+    auto &dirty_submaps = map_cache.transparency_dirty_submaps;
+    // Traverse the submaps in order, skipping those that didn't change
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
+            if( !dirty_submaps[smx * MAPSIZE + smy] ) {
+                continue;
+            }
             auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
 
             for( int sx = 0; sx < SEEX; ++sx ) {
@@ -72,6 +77,8 @@ void map::build_transparency_cache( const int zlev )
                     const int y = sy + smy * SEEY;
 
                     auto &value = transparency_cache[x][y];
+                    // Default to just barely not transparent.
+                    value = LIGHT_TRANSPARENCY_OPEN_AIR;
 
                     if( !(cur_submap->ter[sx][sy].obj().transparent &&
                           cur_submap->frn[sx][sy].obj().transparent) ) {
@@ -127,70 +134,129 @@ void map::build_transparency_cache( const int zlev )
             }
         }
     }
+    // Light passing through the changed submaps has to be cast again
+    map_cache.lightmap_dirty_submaps |= dirty_submaps;
+    dirty_submaps.reset();
     map_cache.transparency_cache_dirty = false;
+    sight_cache.invalidate();
 }
 
 void map::apply_character_light( player &p )
 {
     if( p.has_effect( effect_onfire ) ) {
-        apply_light_source( p.pos(), 8 );
+        add_light_emitter( light_emitter( light_emitter::LIGHT_POINT, p.pos(), 8 ) );
     } else if( p.has_effect( effect_haslight ) ) {
-        apply_light_source( p.pos(), 4 );
+        add_light_emitter( light_emitter( light_emitter::LIGHT_POINT, p.pos(), 4 ) );
     }
 
     float const held_luminance = p.active_light();
     if( held_luminance > LIGHT_AMBIENT_LOW ) {
-        apply_light_source( p.pos(), held_luminance );
+        add_light_emitter( light_emitter( light_emitter::LIGHT_POINT, p.pos(), held_luminance ) );
     }
 
-    if( held_luminance >= 4 && held_luminance > ambient_light_at( p.pos() ) - 0.5f ) {
+    // Compared to sunlight only, the lightmap isn't done yet
+    const float natural_light = g->natural_light_level( p.posz() );
+    const float ambient_light = get_cache_ref( p.posz() ).outside_cache[p.posx()][p.posy()] ?
+                                natural_light : inside_light_level( natural_light );
+    if( held_luminance >= 4 && held_luminance > ambient_light - 0.5f ) {
         p.add_effect( effect_haslight, 1 );
     }
 }
 
+float map::inside_light_level( const float natural_light )
+{
+    // In bright light indoor light exists to some degree
+    return ( natural_light > LIGHT_SOURCE_BRIGHT ) ? LIGHT_AMBIENT_LOW + 1.0 : LIGHT_AMBIENT_MINIMAL;
+}
+
+int light_emitter::radius() const
+{
+    if( type == LIGHT_ARC ) {
+        return luminance > LIGHT_SOURCE_LOCAL ? std::max( LIGHT_RANGE( luminance ), 1 ) : 0;
+    } else if( luminance <= LIGHT_SOURCE_LOCAL ) {
+        return 0;
+    }
+    // Shadowcasting stops after the first row where the light, which falls off
+    // at least linearly, is too weak to be seen
+    return std::min( 60, static_cast<int>( luminance / LIGHT_AMBIENT_LOW ) + 1 );
+}
+
+// Light cast by a share of the light sources, merged into the lightmap afterwards
+struct light_buffer {
+    float lm[MAPSIZE*SEEX][MAPSIZE*SEEY];
+    float sm[MAPSIZE*SEEX][MAPSIZE*SEEY];
+};
+
+// Submaps (inclusive, in grid coordinates) the emitter might light
+static void submaps_in_reach( const light_emitter &e, const int max_submap,
+                              point &sm_min, point &sm_max )
+{
+    // One more, as buffered sources skip directions covered by a brighter neighbour
+    const int r = e.radius() + 1;
+    sm_min = point( std::max( e.p.x - r, 0 ) / SEEX, std::max( e.p.y - r, 0 ) / SEEY );
+    sm_max = point( std::min( ( e.p.x + r ) / SEEX, max_submap ),
+                    std::min( ( e.p.y + r ) / SEEY, max_submap ) );
+}
+
+void map::add_light_emitter( const light_emitter &emitter )
+{
+    get_cache( emitter.p.z ).light_emitters.push_back( emitter );
+}
+
+void map::apply_light_emitter( const light_emitter &emitter,
+                               float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY],
+                               float (&sm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const
+{
+    switch( emitter.type ) {
+        case light_emitter::LIGHT_POINT:
+        case light_emitter::LIGHT_BUFFERED:
+            apply_light_source( emitter.p, emitter.luminance, lm, sm );
+            break;
+        case light_emitter::LIGHT_DIRECTIONAL:
+            apply_directional_light( emitter.p, emitter.direction, emitter.luminance, lm );
+            break;
+        case light_emitter::LIGHT_ARC:
+            apply_light_arc( emitter.p, emitter.direction, emitter.luminance, emitter.width, lm, sm );
+            break;
+    }
+}
+
 void map::generate_lightmap( const int zlev )
 {
     auto &map_cache = get_cache( zlev );
     auto &lm = map_cache.lm;
     auto &sm = map_cache.sm;
     auto &outside_cache = map_cache.outside_cache;
-    std::memset(lm, 0, sizeof(lm));
-    std::memset(sm, 0, sizeof(sm));
-
-    /* Bulk light sources wastefully cast rays into neighbors; a burning hospital can produce
-         significant slowdown, so for stuff like fire and lava:
-     * Step 1: Store the position and luminance in buffer via add_light_source, for efficient
-         checking of neighbors.
-     * Step 2: After everything else, iterate buffer and apply_light_source only in non-redundant
-         directions
-     * Step 3: ????
-     * Step 4: Profit!
+    auto &dirty_submaps = map_cache.lightmap_dirty_submaps;
+
+    /* Only the parts of the map where something changed since the last lightmap are lit again:
+     * Step 1: Collect all light sources, without casting any light yet.
+     * Step 2: Mark the submaps in reach of the sources that were added, removed or changed,
+         and of all sources that reach a submap where the transparency changed.
+     * Step 3: Reset the marked submaps to ambient light and cast all sources reaching them.
+         Light only ever takes the maximum, so casting an unchanged source again doesn't
+         change anything outside of the marked submaps.
      */
-    auto &light_source_buffer = map_cache.light_source_buffer;
-    std::memset(light_source_buffer, 0, sizeof(light_source_buffer));
+    std::vector<light_emitter> last_emitters;
+    last_emitters.swap( map_cache.light_emitters );
+    map_cache.light_emitters.clear();
 
     constexpr int dir_x[] = {  0, -1 , 1, 0 };   //    [0]
     constexpr int dir_y[] = { -1,  0 , 0, 1 };   // [1][X][2]
     constexpr int dir_d[] = { 90, 0, 180, 270 }; //    [3]
 
     const float natural_light  = g->natural_light_level( zlev );
-    const float inside_light = (natural_light > LIGHT_SOURCE_BRIGHT) ?
-        LIGHT_AMBIENT_LOW + 1.0 : LIGHT_AMBIENT_MINIMAL;
-    // Apply sunlight, first light source so just assign
-    for( int sx = 0; sx < LIGHTMAP_CACHE_X; ++sx ) {
-        for( int sy = 0; sy < LIGHTMAP_CACHE_Y; ++sy ) {
-            // In bright light indoor light exists to some degree
-            if( !outside_cache[sx][sy] ) {
-                lm[sx][sy] = inside_light;
-            } else {
-                lm[sx][sy] = natural_light;
-            }
-        }
-    }
+    const float inside_light = inside_light_level( natural_light );
+    const bool bio_night = g->u.has_active_bionic( "bio_night" );
 
-    apply_character_light( g->u );
+    // Sources on other z-levels would be cast into their lightmaps, which aren't reset here
+    if( g->u.posz() == zlev ) {
+        apply_character_light( g->u );
+    }
     for( auto &n : g->active_npc ) {
-        apply_character_light( *n );
+        if( n->posz() == zlev ) {
+            apply_character_light( *n );
+        }
     }
 
     // Traverse the submaps in order
@@ -204,16 +270,14 @@ void map::generate_lightmap( const int zlev )
                     const int y = sy + smy * SEEY;
                     const tripoint p( x, y, zlev );
                     // Project light into any openings into buildings.
-                    if (natural_light > LIGHT_SOURCE_BRIGHT && !outside_cache[p.x][p.y]) {
+                    if( natural_light > LIGHT_SOURCE_BRIGHT && !outside_cache[p.x][p.y] &&
+                        light_transparency( p ) > LIGHT_TRANSPARENCY_SOLID ) {
                         // Apply light sources for external/internal divide
                         for(int i = 0; i < 4; ++i) {
                             if (INBOUNDS(p.x + dir_x[i], p.y + dir_y[i]) &&
                                 outside_cache[p.x + dir_x[i]][p.y + dir_y[i]]) {
-                                lm[p.x][p.y] = natural_light;
-
-                                if (light_transparency( p ) > LIGHT_TRANSPARENCY_SOLID) {
-                                    apply_directional_light( p, dir_d[i], natural_light );
-                                }
+                                add_light_emitter( light_emitter( light_emitter::LIGHT_DIRECTIONAL,
+                                                                  p, natural_light, dir_d[i] ) );
                             }
                         }
                     }
@@ -257,7 +321,8 @@ void map::generate_lightmap( const int zlev )
                                 add_light_source( p, 4 );
                             } else {
                                 // Kinda a hack as the square will still get marked.
-                                apply_light_source( p, LIGHT_SOURCE_LOCAL );
+                                add_light_emitter( light_emitter( light_emitter::LIGHT_POINT, p,
+                                                                  LIGHT_SOURCE_LOCAL ) );
                             }
                             break;
                         case fd_incendiary:
@@ -270,7 +335,7 @@ void map::generate_lightmap( const int zlev )
                             }
                             break;
                         case fd_laser:
-                            apply_light_source( p, 4 );
+                            add_light_emitter( light_emitter( light_emitter::LIGHT_POINT, p, 4 ) );
                             break;
                         case fd_spotlight:
                             add_light_source( p, 80 );
@@ -294,15 +359,16 @@ void map::generate_lightmap( const int zlev )
             continue;
         }
         const tripoint &mp = critter.pos();
-        if( inbounds( mp ) ) {
+        if( mp.z == zlev && inbounds( mp ) ) {
             if (critter.has_effect( effect_onfire)) {
-                apply_light_source( mp, 8 );
+                add_light_emitter( light_emitter( light_emitter::LIGHT_POINT, mp, 8 ) );
             }
             // TODO: [lightmap] Attach natural light brightness to creatures
             // TODO: [lightmap] Allow creatures to have light attacks (ie: eyebot)
             // TODO: [lightmap] Allow creatures to have facing and arc lights
             if (critter.type->luminance > 0) {
-                apply_light_source( mp, critter.type->luminance );
+                add_light_emitter( light_emitter( light_emitter::LIGHT_POINT, mp,
+                                                  critter.type->luminance ) );
             }
         }
     }
@@ -310,6 +376,9 @@ void map::generate_lightmap( const int zlev )
     // Apply any vehicle light sources
     VehicleList vehs = get_vehicles();
     for( auto &vv : vehs ) {
+        if( vv.z != zlev ) {
+            continue;
+        }
         vehicle *v = vv.v;
 
         auto lights = v->lights( true );
@@ -336,7 +405,8 @@ void map::generate_lightmap( const int zlev )
             if( vp.has_flag( VPFLAG_CONE_LIGHT ) ) {
                 if( veh_luminance > LL_LIT ) {
                     add_light_source( src, SQRT_2 ); // Add a little surrounding light
-                    apply_light_arc( src, v->face.dir() + pt->direction, veh_luminance, 45 );
+                    add_light_emitter( light_emitter( light_emitter::LIGHT_ARC, src, veh_luminance,
+                                                      v->face.dir() + pt->direction, 45 ) );
                 }
 
             } else if( vp.has_flag( VPFLAG_CIRCLE_LIGHT ) ) {
@@ -364,33 +434,210 @@ void map::generate_lightmap( const int zlev )
         }
     }
 
+    auto &emitters = map_cache.light_emitters;
+    std::sort( emitters.begin(), emitters.end() );
+
+    // Night vision overwrites the light around the player, wherever they were
+    if( natural_light != map_cache.lightmap_natural_light || bio_night ||
+        map_cache.lightmap_bio_night ) {
+        dirty_submaps.set();
+    }
+
+    const int max_submap = my_MAPSIZE - 1;
+    const auto reaches = [max_submap]( const light_emitter & e,
+    const std::bitset<MAPSIZE *MAPSIZE> &submaps ) {
+        point sm_min;
+        point sm_max;
+        submaps_in_reach( e, max_submap, sm_min, sm_max );
+        for( int smx = sm_min.x; smx <= sm_max.x; smx++ ) {
+            for( int smy = sm_min.y; smy <= sm_max.y; smy++ ) {
+                if( submaps[smx * MAPSIZE + smy] ) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    const auto mark = [max_submap, &dirty_submaps]( const light_emitter & e ) {
+        point sm_min;
+        point sm_max;
+        submaps_in_reach( e, max_submap, sm_min, sm_max );
+        for( int smx = sm_min.x; smx <= sm_max.x; smx++ ) {
+            for( int smy = sm_min.y; smy <= sm_max.y; smy++ ) {
+                dirty_submaps.set( smx * MAPSIZE + smy );
+            }
+        }
+    };
+
+    if( !dirty_submaps.all() ) {
+        // Sources whose light now passes through different terrain
+        const auto transparency_changed = dirty_submaps;
+        if( transparency_changed.any() ) {
+            for( const auto &e : emitters ) {
+                if( reaches( e, transparency_changed ) ) {
+                    mark( e );
+                }
+            }
+        }
+
+        // Sources that appeared, disappeared or changed
+        std::vector<light_emitter> changed;
+        std::set_symmetric_difference( last_emitters.begin(), last_emitters.end(),
+                                       emitters.begin(), emitters.end(),
+                                       std::back_inserter( changed ) );
+        for( const auto &e : changed ) {
+            mark( e );
+        }
+    }
+
+    map_cache.lightmap_natural_light = natural_light;
+    map_cache.lightmap_bio_night = bio_night;
+    if( dirty_submaps.none() ) {
+        return;
+    }
+
+    // Apply sunlight, first light source so just assign
+    for( int smx = 0; smx <= max_submap; ++smx ) {
+        for( int smy = 0; smy <= max_submap; ++smy ) {
+            if( !dirty_submaps[smx * MAPSIZE + smy] ) {
+                continue;
+            }
+            for( int x = smx * SEEX; x < ( smx + 1 ) * SEEX; ++x ) {
+                for( int y = smy * SEEY; y < ( smy + 1 ) * SEEY; ++y ) {
+                    sm[x][y] = 0.0f;
+                    if( outside_cache[x][y] ) {
+                        lm[x][y] = natural_light;
+                        continue;
+                    }
+                    lm[x][y] = inside_light;
+                    // Openings into buildings are lit like outside
+                    if( natural_light > LIGHT_SOURCE_BRIGHT ) {
+                        for( int i = 0; i < 4; ++i ) {
+                            if( INBOUNDS( x + dir_x[i], y + dir_y[i] ) &&
+                                outside_cache[x + dir_x[i]][y + dir_y[i]] ) {
+                                lm[x][y] = natural_light;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /* Bulk light sources wastefully cast rays into neighbors; a burning hospital can produce
+         significant slowdown, so for stuff like fire and lava:
+     * Step 1: Store the position and luminance in buffer via add_light_source, for efficient
+         checking of neighbors.
+     * Step 2: After everything else, iterate buffer and apply_light_source only in non-redundant
+         directions
+     * Step 3: ????
+     * Step 4: Profit!
+     */
+    auto &light_source_buffer = map_cache.light_source_buffer;
+    std::memset(light_source_buffer, 0, sizeof(light_source_buffer));
+
+    std::vector<const light_emitter *> unbuffered;
+    std::vector<const light_emitter *> buffered;
+    for( size_t i = 0; i < emitters.size(); i++ ) {
+        const auto &e = emitters[i];
+        if( e.type != light_emitter::LIGHT_BUFFERED ) {
+            if( reaches( e, dirty_submaps ) ) {
+                unbuffered.push_back( &e );
+            }
+            continue;
+        }
+        // Sorted by luminance, only the brightest source on a tile counts
+        const bool brightest = i + 1 == emitters.size() || emitters[i + 1].p != e.p ||
+                               emitters[i + 1].type != e.type;
+        if( brightest && e.luminance > 0.0 && reaches( e, dirty_submaps ) ) {
+            buffered.push_back( &e );
+        }
+    }
+
+    /* The sources are split between the threads of the pool, each casting into its own
+       buffers. Light only ever takes the maximum, so merging the buffers by taking the
+       maximum gives exactly the same lightmap as casting everything serially.
+       For a handful of sources that isn't worth it, they're cast straight into the lightmap.
+    */
+    auto &pool = thread_pool::get();
+    constexpr size_t min_sources_per_thread = 8;
+    const size_t num_buffers = std::min( pool.size(),
+                                         ( unbuffered.size() + buffered.size() ) / min_sources_per_thread );
+    static std::vector<std::unique_ptr<light_buffer>> buffers;
+    while( buffers.size() < num_buffers ) {
+        buffers.emplace_back( new light_buffer() );
+    }
+    for( size_t i = 0; i < num_buffers; i++ ) {
+        std::memset( buffers[i]->lm, 0, sizeof( buffers[i]->lm ) );
+        std::memset( buffers[i]->sm, 0, sizeof( buffers[i]->sm ) );
+    }
+    const auto cast = [this, num_buffers, &lm, &sm]( const std::vector<const light_emitter *> &sources ) {
+        if( num_buffers <= 1 ) {
+            for( const auto e : sources ) {
+                apply_light_emitter( *e, lm, sm );
+            }
+            return;
+        }
+        thread_pool::get().run( num_buffers, [this, num_buffers, &sources]( size_t b ) {
+            // Interleaved, as bright sources tend to be next to each other
+            for( size_t i = b; i < sources.size(); i += num_buffers ) {
+                apply_light_emitter( *sources[i], buffers[b]->lm, buffers[b]->sm );
+            }
+        } );
+    };
+
+    // Unbuffered sources first, so that buffered ones don't hide their rays
+    cast( unbuffered );
+
+    for( const auto &e : emitters ) {
+        if( e.type == light_emitter::LIGHT_BUFFERED ) {
+            light_source_buffer[e.p.x][e.p.y] = std::max( e.luminance, light_source_buffer[e.p.x][e.p.y] );
+        }
+    }
+
     /* Now that we have position and intensity of all bulk light sources, apply_ them
       This may seem like extra work, but take a 12x12 raging inferno:
         unbuffered: (12^2)*(160*4) = apply_light_ray x 92160
         buffered:   (12*4)*(160)   = apply_light_ray x 7680
     */
-    const tripoint cache_start( 0, 0, zlev );
-    const tripoint cache_end( LIGHTMAP_CACHE_X, LIGHTMAP_CACHE_Y, zlev );
-    for( const tripoint &p : points_in_rectangle( cache_start, cache_end ) ) {
-        if( light_source_buffer[p.x][p.y] > 0.0 ) {
-            apply_light_source( p, light_source_buffer[p.x][p.y] );
+    cast( buffered );
+
+    if( num_buffers > 1 ) {
+        // Light cast outside of the dirty submaps is already in the lightmap
+        for( int smx = 0; smx <= max_submap; ++smx ) {
+            for( int smy = 0; smy <= max_submap; ++smy ) {
+                if( !dirty_submaps[smx * MAPSIZE + smy] ) {
+                    continue;
+                }
+                for( size_t b = 0; b < num_buffers; b++ ) {
+                    const auto &buf = *buffers[b];
+                    for( int x = smx * SEEX; x < ( smx + 1 ) * SEEX; ++x ) {
+                        for( int y = smy * SEEY; y < ( smy + 1 ) * SEEY; ++y ) {
+                            lm[x][y] = std::max( lm[x][y], buf.lm[x][y] );
+                            sm[x][y] = std::max( sm[x][y], buf.sm[x][y] );
+                        }
+                    }
+                }
+            }
         }
     }
 
-
-    if (g->u.has_active_bionic("bio_night") ) {
+    if( bio_night ) {
+        const tripoint cache_start( 0, 0, zlev );
+        const tripoint cache_end( LIGHTMAP_CACHE_X, LIGHTMAP_CACHE_Y, zlev );
         for( const tripoint &p : points_in_rectangle( cache_start, cache_end ) ) {
             if( rl_dist( p, g->u.pos() ) < 15 ) {
                 lm[p.x][p.y] = LIGHT_AMBIENT_MINIMAL;
             }
         }
     }
+
+    dirty_submaps.reset();
 }
 
 void map::add_light_source( const tripoint &p, float luminance )
 {
-    auto &light_source_buffer = get_cache( p.z ).light_source_buffer;
-    light_source_buffer[p.x][p.y] = std::max(luminance, light_source_buffer[p.x][p.y]);
+    add_light_emitter( light_emitter( light_emitter::LIGHT_BUFFERED, p, luminance ) );
 }
 
 // Tile light/transparency: 3D
@@ -683,25 +930,71 @@ void map::build_seen_cache( const tripoint &origin, const int target_z )
     if( !fov_3d ) {
         seen_cache[origin.x][origin.y] = LIGHT_TRANSPARENCY_CLEAR;
 
-        castLight<0, 1, 1, 0, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-        castLight<1, 0, 0, 1, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-
-        castLight<0, -1, 1, 0, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-        castLight<-1, 0, 0, 1, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-
-        castLight<0, 1, -1, 0, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-        castLight<1, 0, 0, -1, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
+        const auto cast_octant = [&transparency_cache, &origin]( const size_t octant,
+        float (&output)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) {
+            switch( octant ) {
+                case 0:
+                    castLight<0, 1, 1, 0, sight_calc, sight_check>(
+                        output, transparency_cache, origin.x, origin.y, 0 );
+                    break;
+                case 1:
+                    castLight<1, 0, 0, 1, sight_calc, sight_check>(
+                        output, transparency_cache, origin.x, origin.y, 0 );
+                    break;
+                case 2:
+                    castLight<0, -1, 1, 0, sight_calc, sight_check>(
+                        output, transparency_cache, origin.x, origin.y, 0 );
+                    break;
+                case 3:
+                    castLight<-1, 0, 0, 1, sight_calc, sight_check>(
+                        output, transparency_cache, origin.x, origin.y, 0 );
+                    break;
+                case 4:
+                    castLight<0, 1, -1, 0, sight_calc, sight_check>(
+                        output, transparency_cache, origin.x, origin.y, 0 );
+                    break;
+                case 5:
+                    castLight<1, 0, 0, -1, sight_calc, sight_check>(
+                        output, transparency_cache, origin.x, origin.y, 0 );
+                    break;
+                case 6:
+                    castLight<0, -1, -1, 0, sight_calc, sight_check>(
+                        output, transparency_cache, origin.x, origin.y, 0 );
+                    break;
+                case 7:
+                    castLight<-1, 0, 0, -1, sight_calc, sight_check>(
+                        output, transparency_cache, origin.x, origin.y, 0 );
+                    break;
+            }
+        };
 
-        castLight<0, -1, -1, 0, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-        castLight<-1, 0, 0, -1, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
+        constexpr size_t num_octants = 8;
+        auto &pool = thread_pool::get();
+        if( pool.size() == 1 ) {
+            for( size_t octant = 0; octant < num_octants; octant++ ) {
+                cast_octant( octant, seen_cache );
+            }
+        } else {
+            // Octants overlap on their edges, so each gets its own buffer.
+            // Casting only takes the maximum, so merging them the same way is exact.
+            static std::array<std::unique_ptr<light_buffer>, num_octants> octant_buffers;
+            pool.run( num_octants, [&cast_octant]( const size_t octant ) {
+                auto &buf = octant_buffers[octant];
+                if( buf == nullptr ) {
+                    buf.reset( new light_buffer() );
+                }
+                std::uninitialized_fill_n( &buf->lm[0][0], MAPSIZE*SEEX * MAPSIZE*SEEY,
+                                           static_cast<float>( LIGHT_TRANSPARENCY_SOLID ) );
+                cast_octant( octant, buf->lm );
+            } );
+            for( const auto &buf : octant_buffers ) {
+                for( int x = 0; x < MAPSIZE*SEEX; x++ ) {
+                    for( int y = 0; y < MAPSIZE*SEEY; y++ ) {
+                        seen_cache[x][y] = std::max( seen_cache[x][y], buf->lm[x][y] );
+                    }
+                }
+            }
+        }
     } else {
         if( origin.z == target_z ) {
             seen_cache[origin.x][origin.y] = LIGHT_TRANSPARENCY_CLEAR;
@@ -836,6 +1129,49 @@ void map::build_seen_cache( const tripoint &origin, const int target_z )
     }
 }
 
+void map::build_vision_field( const tripoint &origin, const int radius,
+                              los_cache::vision_field &field ) const
+{
+    const auto &transparency_cache = get_cache_ref( origin.z ).transparency_cache;
+    static std::unique_ptr<light_buffer> buffer;
+    if( buffer == nullptr ) {
+        buffer.reset( new light_buffer() );
+    }
+    auto &seen = buffer->lm;
+    std::uninitialized_fill_n( &seen[0][0], MAPSIZE*SEEX * MAPSIZE*SEEY,
+                               static_cast<float>( LIGHT_TRANSPARENCY_SOLID ) );
+    seen[origin.x][origin.y] = LIGHT_TRANSPARENCY_CLEAR;
+
+    // castLight goes 60 squares minus the offset far, like for mirrors in build_seen_cache
+    const int max_radius = los_cache::max_field_radius;
+    const int offset_distance = max_radius - std::min( std::max( radius, 0 ), max_radius );
+    castLight<0, 1, 1, 0, sight_calc, sight_check>(
+        seen, transparency_cache, origin.x, origin.y, offset_distance );
+    castLight<1, 0, 0, 1, sight_calc, sight_check>(
+        seen, transparency_cache, origin.x, origin.y, offset_distance );
+    castLight<0, -1, 1, 0, sight_calc, sight_check>(
+        seen, transparency_cache, origin.x, origin.y, offset_distance );
+    castLight<-1, 0, 0, 1, sight_calc, sight_check>(
+        seen, transparency_cache, origin.x, origin.y, offset_distance );
+    castLight<0, 1, -1, 0, sight_calc, sight_check>(
+        seen, transparency_cache, origin.x, origin.y, offset_distance );
+    castLight<1, 0, 0, -1, sight_calc, sight_check>(
+        seen, transparency_cache, origin.x, origin.y, offset_distance );
+    castLight<0, -1, -1, 0, sight_calc, sight_check>(
+        seen, transparency_cache, origin.x, origin.y, offset_distance );
+    castLight<-1, 0, 0, -1, sight_calc, sight_check>(
+        seen, transparency_cache, origin.x, origin.y, offset_distance );
+
+    field.reset();
+    for( int x = 0; x < MAPSIZE*SEEX; x++ ) {
+        for( int y = 0; y < MAPSIZE*SEEY; y++ ) {
+            if( seen[x][y] > LIGHT_TRANSPARENCY_SOLID ) {
+                field.set( x * MAPSIZE*SEEY + y );
+            }
+        }
+    }
+}
+
 template<int xx, int xy, int yx, int yy, float(*calc)(const float &, const float &, const int &),
          bool(*check)(const float &, const float &)>
 void castLight( float (&output_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY],
@@ -923,13 +1259,13 @@ static bool light_check( const float &transparency, const float &intensity ) {
     return transparency > LIGHT_TRANSPARENCY_SOLID && intensity > LIGHT_AMBIENT_LOW;
 }
 
-void map::apply_light_source( const tripoint &p, float luminance )
+void map::apply_light_source( const tripoint &p, float luminance,
+                              float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY],
+                              float (&sm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const
 {
-    auto &cache = get_cache( p.z );
-    float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.lm;
-    float (&sm)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.sm;
-    float (&transparency_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.transparency_cache;
-    float (&light_source_buffer)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.light_source_buffer;
+    const auto &cache = get_cache_ref( p.z );
+    const float (&transparency_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.transparency_cache;
+    const float (&light_source_buffer)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.light_source_buffer;
 
     const int x = p.x;
     const int y = p.y;
@@ -991,14 +1327,14 @@ void map::apply_light_source( const tripoint &p, float luminance )
     }
 }
 
-void map::apply_directional_light( const tripoint &p, int direction, float luminance )
+void map::apply_directional_light( const tripoint &p, int direction, float luminance,
+                                   float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const
 {
     const int x = p.x;
     const int y = p.y;
 
-    auto &cache = get_cache( p.z );
-    float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.lm;
-    float (&transparency_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.transparency_cache;
+    const auto &cache = get_cache_ref( p.z );
+    const float (&transparency_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.transparency_cache;
 
     if( direction == 90 ) {
         castLight<1, 0, 0, -1, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
@@ -1015,7 +1351,9 @@ void map::apply_directional_light( const tripoint &p, int direction, float lumin
     }
 }
 
-void map::apply_light_arc( const tripoint &p, int angle, float luminance, int wideangle )
+void map::apply_light_arc( const tripoint &p, int angle, float luminance, int wideangle,
+                           float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY],
+                           float (&sm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const
 {
     if (luminance <= LIGHT_SOURCE_LOCAL) {
         return;
@@ -1023,7 +1361,7 @@ void map::apply_light_arc( const tripoint &p, int angle, float luminance, int wi
 
     bool lit[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y] {};
 
-    apply_light_source( p, LIGHT_SOURCE_LOCAL );
+    apply_light_source( p, LIGHT_SOURCE_LOCAL, lm, sm );
 
     // Normalise (should work with negative values too)
     const double wangle = wideangle / 2.0;
@@ -1034,7 +1372,7 @@ void map::apply_light_arc( const tripoint &p, int angle, float luminance, int wi
     double rad = PI * (double)nangle / 180;
     int range = LIGHT_RANGE(luminance);
     calc_ray_end( nangle, range, p, end );
-    apply_light_ray(lit, p, end , luminance);
+    apply_light_ray( lit, p, end, luminance, lm );
 
     tripoint test;
     calc_ray_end(wangle + nangle, range, p, test );
@@ -1053,16 +1391,16 @@ void map::apply_light_arc( const tripoint &p, int angle, float luminance, int wi
             double orad = ( PI * ao / 180.0 );
             end.x = int( p.x + ( (double)range - fdist * 2.0) * cos(rad + orad) );
             end.y = int( p.y + ( (double)range - fdist * 2.0) * sin(rad + orad) );
-            apply_light_ray( lit, p, end, luminance );
+            apply_light_ray( lit, p, end, luminance, lm );
 
             end.x = int( p.x + ( (double)range - fdist * 2.0) * cos(rad - orad) );
             end.y = int( p.y + ( (double)range - fdist * 2.0) * sin(rad - orad) );
-            apply_light_ray( lit, p, end, luminance );
+            apply_light_ray( lit, p, end, luminance, lm );
         } else {
             calc_ray_end( nangle + ao, range, p, end );
-            apply_light_ray( lit, p, end, luminance );
+            apply_light_ray( lit, p, end, luminance, lm );
             calc_ray_end( nangle - ao, range, p, end );
-            apply_light_ray( lit, p, end, luminance );
+            apply_light_ray( lit, p, end, luminance, lm );
         }
     }
 }
@@ -1093,7 +1431,8 @@ void map::calc_ray_end(int angle, int range, const tripoint &p, tripoint &out )
 }
 
 void map::apply_light_ray(bool lit[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y],
-                          const tripoint &s, const tripoint &e, float luminance)
+                          const tripoint &s, const tripoint &e, float luminance,
+                          float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const
 {
     int ax = abs(e.x - s.x) * 2;
     int ay = abs(e.y - s.y) * 2;
@@ -1107,8 +1446,7 @@ void map::apply_light_ray(bool lit[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y],
         return;
     }
 
-    auto &lm = get_cache( s.z ).lm;
-    auto &transparency_cache = get_cache( s.z ).transparency_cache;
+    auto &transparency_cache = get_cache_ref( s.z ).transparency_cache;
 
     float distance = 1.0;
     float transparency = LIGHT_TRANSPARENCY_OPEN_AIR;
@@ -1,6 +1,8 @@
 #ifndef LIGHTMAP_H
 #define LIGHTMAP_H
 
+#include "enums.h"
+
 #define LIGHT_SOURCE_LOCAL  0.1f
 #define LIGHT_SOURCE_BRIGHT 10
 
@@ -32,4 +34,54 @@ enum lit_level {
     LL_BLANK // blank space, not an actual light level
 };
 
+/**
+ * A light source found while generating the lightmap. The sources of the last
+ * lightmap are kept, so that light only needs to be cast again around sources
+ * that changed and where the transparency changed.
+ */
+struct light_emitter {
+    enum emitter_type : int {
+        LIGHT_POINT,       // See map::apply_light_source
+        LIGHT_BUFFERED,    // See map::add_light_source
+        LIGHT_DIRECTIONAL, // See map::apply_directional_light
+        LIGHT_ARC          // See map::apply_light_arc
+    };
+
+    emitter_type type;
+    tripoint p;
+    float luminance;
+    int direction;
+    int width;
+
+    light_emitter( emitter_type t, const tripoint &p, float luminance, int direction = 0,
+                   int width = 0 )
+        : type( t ), p( p ), luminance( luminance ), direction( direction ), width( width ) {}
+
+    /** Distance from p beyond which this source can't light anything. */
+    int radius() const;
+};
+
+inline bool operator==( const light_emitter &a, const light_emitter &b )
+{
+    return a.type == b.type && a.p == b.p && a.luminance == b.luminance &&
+           a.direction == b.direction && a.width == b.width;
+}
+
+inline bool operator<( const light_emitter &a, const light_emitter &b )
+{
+    if( a.type != b.type ) {
+        return a.type < b.type;
+    }
+    if( a.p != b.p ) {
+        return a.p < b.p;
+    }
+    if( a.luminance != b.luminance ) {
+        return a.luminance < b.luminance;
+    }
+    if( a.direction != b.direction ) {
+        return a.direction < b.direction;
+    }
+    return a.width < b.width;
+}
+
 #endif
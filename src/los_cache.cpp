@@ -0,0 +1,117 @@
+#include "los_cache.h"
+
+#include "enums.h"
+
+namespace
+{
+
+// Enough for a turn full of monsters, the cache starts over when it is reached.
+constexpr size_t max_results = 1 << 16;
+// A field takes 2 kB
+constexpr size_t max_fields = 256;
+
+bool fits( const int value, const int bits )
+{
+    return value >= 0 && value < ( 1 << bits );
+}
+
+}
+
+constexpr int los_cache::max_field_radius;
+
+bool los_cache::make_key( const tripoint &from, const tripoint &to, const int range,
+                          uint64_t &key )
+{
+    // Map coordinates take 8 bits, z-levels are shifted to be positive, range -1 (unlimited) to 0.
+    if( !fits( from.x, 8 ) || !fits( from.y, 8 ) || !fits( to.x, 8 ) || !fits( to.y, 8 ) ||
+        !fits( from.z + 16, 5 ) || !fits( to.z + 16, 5 ) || !fits( range + 1, 16 ) ) {
+        return false;
+    }
+    key = static_cast<uint64_t>( from.x ) |
+          static_cast<uint64_t>( from.y ) << 8 |
+          static_cast<uint64_t>( to.x ) << 16 |
+          static_cast<uint64_t>( to.y ) << 24 |
+          static_cast<uint64_t>( from.z + 16 ) << 32 |
+          static_cast<uint64_t>( to.z + 16 ) << 37 |
+          static_cast<uint64_t>( range + 1 ) << 42;
+    return true;
+}
+
+void los_cache::start_turn( const int current_turn )
+{
+    if( current_turn != turn ) {
+        results.clear();
+        fields.clear();
+        turn = current_turn;
+    }
+}
+
+bool los_cache::find( const tripoint &from, const tripoint &to, const int range,
+                      const int current_turn, bool &visible )
+{
+    start_turn( current_turn );
+    uint64_t key;
+    if( !make_key( from, to, range, key ) ) {
+        counts.misses++;
+        return false;
+    }
+    const auto it = results.find( key );
+    if( it == results.end() ) {
+        counts.misses++;
+        return false;
+    }
+    counts.hits++;
+    visible = it->second;
+    return true;
+}
+
+void los_cache::insert( const tripoint &from, const tripoint &to, const int range,
+                        const bool visible )
+{
+    uint64_t key;
+    if( !make_key( from, to, range, key ) ) {
+        return;
+    }
+    if( results.size() >= max_results ) {
+        results.clear();
+    }
+    results[key] = visible;
+}
+
+const los_cache::vision_field *los_cache::find_field( const tripoint &origin, const int radius,
+        const int current_turn )
+{
+    start_turn( current_turn );
+    uint64_t key;
+    if( !make_key( origin, origin, radius, key ) ) {
+        return nullptr;
+    }
+    const auto it = fields.find( key );
+    return it != fields.end() ? &it->second : nullptr;
+}
+
+const los_cache::vision_field &los_cache::insert_field( const tripoint &origin, const int radius,
+        const vision_field &field )
+{
+    counts.fields++;
+    uint64_t key;
+    if( !make_key( origin, origin, radius, key ) ) {
+        // Not remembered, but the caller still needs a place for it.
+        static vision_field uncached;
+        uncached = field;
+        return uncached;
+    }
+    if( fields.size() >= max_fields ) {
+        fields.clear();
+    }
+    return fields[key] = field;
+}
+
+void los_cache::invalidate()
+{
+    if( !results.empty() || !fields.empty() ) {
+        results.clear();
+        fields.clear();
+        counts.invalidations++;
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef LOS_CACHE_H
+#define LOS_CACHE_H
+
+#include "game_constants.h"
+
+#include <bitset>
+#include <cstdint>
+#include <unordered_map>
+
+struct tripoint;
+
+/**
+ * Results of @ref map::sees during one turn, keyed by the two points and the range.
+ *
+ * Monsters, NPCs and turrets ask for the same lines several times per turn; each of
+ * those walks the line through the transparency cache. The results are forgotten when
+ * the turn changes and whenever the map invalidates them (the transparency cache was
+ * marked dirty or rebuilt, the map was shifted).
+ * Points that don't fit into the key (far outside of the map) are not cached.
+ *
+ * It also holds the fields of view built by @ref map::sees_in_field, which are kept and
+ * dropped the same way.
+ */
+class los_cache
+{
+    public:
+        struct stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t invalidations = 0;
+            /** Number of fields of view built */
+            uint64_t fields = 0;
+        };
+
+        /** The squares of the map seen from a point, indexed by x * MAPSIZE * SEEY + y. */
+        using vision_field = std::bitset<MAPSIZE * SEEX * MAPSIZE * SEEY>;
+        /** Fields of view reach at most this far, like all shadowcasting (see castLight). */
+        static constexpr int max_field_radius = 60;
+
+        /**
+         * Looks up a result of the given turn, results of other turns are dropped.
+         * @return false if the result is not known.
+         */
+        bool find( const tripoint &from, const tripoint &to, int range, int turn, bool &visible );
+        /** Stores a result for the turn given to the last @ref find. */
+        void insert( const tripoint &from, const tripoint &to, int range, bool visible );
+        /** The field of view from origin up to the radius during the turn, nullptr if unknown. */
+        const vision_field *find_field( const tripoint &origin, int radius, int turn );
+        /** Stores a field of view for the turn given to the last @ref find_field. */
+        const vision_field &insert_field( const tripoint &origin, int radius,
+                                          const vision_field &field );
+        /** Forgets all results. */
+        void invalidate();
+
+        const stats &get_stats() const {
+            return counts;
+        }
+        void reset_stats() {
+            counts = stats();
+        }
+
+    private:
+        /** @return false if the points don't fit into a key. */
+        static bool make_key( const tripoint &from, const tripoint &to, int range, uint64_t &key );
+
+        /** Drops the results if they are from another turn. */
+        void start_turn( int current_turn );
+
+        std::unordered_map<uint64_t, bool> results;
+        std::unordered_map<uint64_t, vision_field> fields;
+        int turn = -1;
+        stats counts;
+};
+
+#endif
@@ -432,6 +432,7 @@ int main(int argc, char *argv[])
     set_escdelay(10); // Make escape actually responsive
 
     srand(seed);
+    rng_set_engine_seed(seed);
 
     g = new game;
     // First load and initialize everything that does not
@@ -197,6 +197,24 @@ void map::add_vehicle_to_cache( vehicle *veh )
 
     auto &ch = get_cache( veh->smz );
     ch.veh_in_active_range = true;
+    // A vehicle added twice would leave its old squares behind
+    remove_vehicle_from_cache( veh, veh->smz );
+
+    uint16_t index;
+    if( !ch.free_cached_vehicles.empty() ) {
+        index = ch.free_cached_vehicles.back();
+        ch.free_cached_vehicles.pop_back();
+    } else if( ch.cached_vehicles.size() < UINT16_MAX ) {
+        index = ch.cached_vehicles.size();
+        ch.cached_vehicles.emplace_back();
+    } else {
+        debugmsg( "Too many vehicles in the vehicle cache of z-level %d", veh->smz );
+        return;
+    }
+    ch.cached_vehicle_index[veh] = index;
+    cached_vehicle &cached = ch.cached_vehicles[index];
+    cached.veh = veh;
+
     // Get parts
     std::vector<vehicle_part> &parts = veh->parts;
     const tripoint gpos = veh->global_pos3();
@@ -207,14 +225,39 @@ void map::add_vehicle_to_cache( vehicle *veh )
             continue;
         }
         const tripoint p = gpos + it->precalc[0];
-        ch.veh_cached_parts.insert( std::make_pair( p,
-                                    std::make_pair( veh, partid ) ) );
-        if( inbounds( p.x, p.y ) ) {
-            ch.veh_exists_at[p.x][p.y] = true;
+        if( !inbounds( p.x, p.y ) ) {
+            continue;
+        }
+        veh_cache_cell &cell = ch.veh_parts[p.x][p.y];
+        if( cell.veh == 0 ) {
+            cell.veh = index + 1;
+            cell.part = partid;
+            cached.squares.emplace_back( p.x, p.y );
         }
     }
 }
 
+void map::remove_vehicle_from_cache( const vehicle *veh, const int zlev )
+{
+    auto &ch = get_cache( zlev );
+    const auto found = ch.cached_vehicle_index.find( veh );
+    if( found == ch.cached_vehicle_index.end() ) {
+        return;
+    }
+    const uint16_t index = found->second;
+    ch.cached_vehicle_index.erase( found );
+
+    cached_vehicle &cached = ch.cached_vehicles[index];
+    for( const point &p : cached.squares ) {
+        ch.veh_parts[p.x][p.y] = veh_cache_cell{ 0, 0 };
+        // If something was resting on veh, drop it
+        support_dirty( tripoint( p.x, p.y, zlev + 1 ) );
+    }
+    cached.squares.clear();
+    cached.veh = nullptr;
+    ch.free_cached_vehicles.push_back( index );
+}
+
 void map::update_vehicle_cache( vehicle *veh, const int old_zlevel )
 {
     if( veh == nullptr ) {
@@ -223,37 +266,22 @@ void map::update_vehicle_cache( vehicle *veh, const int old_zlevel )
     }
 
     // Existing must be cleared
-    auto &ch = get_cache( old_zlevel );
-    auto it = ch.veh_cached_parts.begin();
-    const auto end = ch.veh_cached_parts.end();
-    while( it != end ) {
-        if( it->second.first == veh ) {
-            const auto &p = it->first;
-            if( inbounds( p.x, p.y ) ) {
-                ch.veh_exists_at[p.x][p.y] = false;
-            }
-            ch.veh_cached_parts.erase( it++ );
-            // If something was resting on veh, drop it
-            support_dirty( tripoint( p.x, p.y, old_zlevel + 1 ) );
-        } else {
-            ++it;
-        }
-    }
-
+    remove_vehicle_from_cache( veh, old_zlevel );
     add_vehicle_to_cache( veh );
 }
 
 void map::clear_vehicle_cache( const int zlev )
 {
     auto &ch = get_cache( zlev );
-    while( !ch.veh_cached_parts.empty() ) {
-        const auto part = ch.veh_cached_parts.begin();
-        const auto &p = part->first;
-        if( inbounds( p ) ) {
-            ch.veh_exists_at[p.x][p.y] = false;
+    // The vehicles may already be deleted, only the squares are looked at
+    for( cached_vehicle &cached : ch.cached_vehicles ) {
+        for( const point &p : cached.squares ) {
+            ch.veh_parts[p.x][p.y] = veh_cache_cell{ 0, 0 };
         }
-        ch.veh_cached_parts.erase( part );
     }
+    ch.cached_vehicles.clear();
+    ch.free_cached_vehicles.clear();
+    ch.cached_vehicle_index.clear();
 }
 
 void map::clear_vehicle_list( const int zlev )
@@ -293,10 +321,12 @@ std::unique_ptr<vehicle> map::detach_vehicle( vehicle *veh )
             ch.vehicle_list.erase(veh);
             reset_vehicle_cache( zlev );
             current_submap->vehicles.erase (current_submap->vehicles.begin() + i);
+            current_submap->mark_dirty();
             if( veh->tracking_on ) {
                 overmap_buffer.remove_vehicle( veh );
             }
             dirty_vehicle_list.erase(veh);
+            moving_vehicles.remove( veh );
             return std::unique_ptr<vehicle>( veh );
         }
     }
@@ -309,11 +339,11 @@ void map::destroy_vehicle( vehicle *veh )
     detach_vehicle( veh );
 }
 
-void map::on_vehicle_moved( const int smz ) {
-    set_outside_cache_dirty( smz );
-    set_transparency_cache_dirty( smz );
-    set_floor_cache_dirty( smz );
-    set_pathfinding_cache_dirty( smz );
+void map::on_vehicle_moved( const vehicle &veh ) {
+    set_outside_cache_dirty( veh.smz );
+    set_transparency_cache_dirty( veh.smz );
+    set_floor_cache_dirty( veh.smz );
+    set_pathfinding_cache_dirty( veh );
 }
 
 void map::vehmove()
@@ -321,10 +351,12 @@ void map::vehmove()
     // give vehicles movement points
     {
         VehicleList vehs = get_vehicles();
+        moving_vehicles.clear();
         for( auto &vehs_v : vehs ) {
             vehicle *veh = vehs_v.v;
             veh->gain_moves();
             veh->slow_leak();
+            moving_vehicles.update( *veh );
         }
     }
 
@@ -346,34 +378,25 @@ void map::vehmove()
 
 bool map::vehproceed()
 {
-    VehicleList vehs = get_vehicles();
-    vehicle* cur_veh = nullptr;
-    float max_of_turn = 0;
-    tripoint pt;
-    // First horizontal movement
-    for( auto &vehs_v : vehs ) {
-        if( vehs_v.v->of_turn > max_of_turn ) {
-            cur_veh = vehs_v.v;
-            max_of_turn = cur_veh->of_turn;
-        }
-    }
-
-    // Then vertical-only movement
+    vehicle *cur_veh = moving_vehicles.next();
     if( cur_veh == nullptr ) {
-        for( auto &vehs_v : vehs ) {
-            vehicle &cveh = *vehs_v.v;
-            if( cveh.falling ) {
-                cur_veh = vehs_v.v;
-                break;
+        // Shifting the map forgets the schedule, and movement may have been given without
+        // an update. Look at all vehicles once more before giving up.
+        for( auto &vehs_v : get_vehicles() ) {
+            if( vehs_v.v->of_turn > 0 || vehs_v.v->falling ) {
+                moving_vehicles.update( *vehs_v.v );
             }
         }
+        cur_veh = moving_vehicles.next();
     }
 
     if( cur_veh == nullptr ) {
         return false;
     }
 
-    return vehact( *cur_veh );
+    const bool result = vehact( *cur_veh );
+    moving_vehicles.moved( cur_veh );
+    return result;
 }
 
 bool map::vehact( vehicle &veh )
@@ -467,7 +490,7 @@ bool map::vehact( vehicle &veh )
             g->setremoteveh( nullptr );
         }
 
-        on_vehicle_moved( veh.smz );
+        on_vehicle_moved( veh );
         // Destroy vehicle (sank to nowhere)
         destroy_vehicle( &veh );
         return true;
@@ -1017,6 +1040,7 @@ float map::vehicle_vehicle_collision( vehicle &veh, vehicle &veh2,
 
         veh.of_turn = avg_of_turn * .9;
         veh2.of_turn = avg_of_turn * 1.1;
+        moving_vehicles.update( veh2 );
 
         //Energy after collision
         float E_a = 0.5 * m1 * final1.norm() * final1.norm() +
@@ -1145,20 +1169,14 @@ const vehicle* map::veh_at_internal( const tripoint &p, int &part_num ) const
 {
     // This function is called A LOT. Move as much out of here as possible.
     const auto &ch = get_cache_ref( p.z );
-    if( !ch.veh_in_active_range || !ch.veh_exists_at[p.x][p.y] ) {
+    const veh_cache_cell &cell = ch.veh_parts[p.x][p.y];
+    if( !ch.veh_in_active_range || cell.veh == 0 ) {
         part_num = -1;
         return nullptr; // Clear cache indicates no vehicle. This should optimize a great deal.
     }
 
-    const auto it = ch.veh_cached_parts.find( p );
-    if( it != ch.veh_cached_parts.end() ) {
-        part_num = it->second.second;
-        return it->second.first;
-    }
-
-    debugmsg( "vehicle part cache indicated vehicle not found: %d %d %d", p.x, p.y, p.z );
-    part_num = -1;
-    return nullptr;
+    part_num = cell.part;
+    return ch.cached_vehicles[cell.veh - 1].veh;
 }
 
 vehicle* map::veh_at_internal( const tripoint &p, int &part_num )
@@ -1333,6 +1351,8 @@ vehicle *map::displace_vehicle( tripoint &p, const tripoint &dp )
 
     bool need_update = false;
     int z_change = 0;
+    // The squares it leaves, on_vehicle_moved handles the ones it enters
+    set_pathfinding_cache_dirty( *veh );
     // Move passengers
     const tripoint old_veh_pos = veh->global_pos3();
     for( size_t i = 0; i < psg_parts.size(); i++ ) {
@@ -1390,6 +1410,8 @@ vehicle *map::displace_vehicle( tripoint &p, const tripoint &dp )
         dst_submap->vehicles.push_back( veh );
         src_submap->vehicles.erase( src_submap->vehicles.begin() + our_i );
         dst_submap->is_uniform = false;
+        src_submap->mark_dirty();
+        dst_submap->mark_dirty();
     }
 
     p = p2;
@@ -1413,7 +1435,7 @@ vehicle *map::displace_vehicle( tripoint &p, const tripoint &dp )
         veh->falling = vehicle_falling( *veh );
     }
 
-    on_vehicle_moved( veh->smz );
+    on_vehicle_moved( *veh );
     return veh;
 }
 
@@ -1568,7 +1590,7 @@ void map::furn_set( const tripoint &p, const furn_id new_furniture )
     const furn_t &new_t = new_furniture.obj();
 
     if( old_t.transparent != new_t.transparent ) {
-        set_transparency_cache_dirty( p.z );
+        set_transparency_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_INDOORS ) != new_t.has_flag( TFLAG_INDOORS ) ) {
@@ -1580,7 +1602,7 @@ void map::furn_set( const tripoint &p, const furn_id new_furniture )
     }
 
     // @todo Limit to changes that affect move cost, traps and stairs
-    set_pathfinding_cache_dirty( p.z );
+    set_pathfinding_cache_dirty( p );
 
     // Make sure the furniture falls if it needs to
     support_dirty( p );
@@ -1771,7 +1793,7 @@ void map::ter_set( const tripoint &p, const ter_id new_terrain )
     }
 
     if( old_t.transparent != new_t.transparent ) {
-        set_transparency_cache_dirty( p.z );
+        set_transparency_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_INDOORS ) != new_t.has_flag( TFLAG_INDOORS ) ) {
@@ -1785,7 +1807,7 @@ void map::ter_set( const tripoint &p, const ter_id new_terrain )
     }
 
     // @todo Limit to changes that affect move cost, traps and stairs
-    set_pathfinding_cache_dirty( p.z );
+    set_pathfinding_cache_dirty( p );
 
     tripoint above( p.x, p.y, p.z + 1 );
     // Make sure that if we supported something and no longer do so, it falls down
@@ -2319,6 +2341,7 @@ void map::drop_vehicle( const tripoint &p )
     }
 
     veh->falling = true;
+    moving_vehicles.update( *veh );
 }
 
 void map::support_dirty( const tripoint &p )
@@ -4225,6 +4248,10 @@ void map::set_temperature( const tripoint &p, int new_temperature )
     temperature( tripoint( p.x + SEEX, p.y, p.z ) ) = new_temperature;
     temperature( tripoint( p.x, p.y + SEEY, p.z ) ) = new_temperature;
     temperature( tripoint( p.x + SEEX, p.y + SEEY, p.z ) ) = new_temperature;
+    set_submap_dirty( p );
+    set_submap_dirty( tripoint( p.x + SEEX, p.y, p.z ) );
+    set_submap_dirty( tripoint( p.x, p.y + SEEY, p.z ) );
+    set_submap_dirty( tripoint( p.x + SEEX, p.y + SEEY, p.z ) );
 }
 
 void map::set_temperature( const int x, const int y, int new_temperature )
@@ -4369,6 +4396,7 @@ void map::i_clear(const tripoint &p)
 
     current_submap->lum[lx][ly] = 0;
     current_submap->itm[lx][ly].clear();
+    current_submap->mark_dirty();
 }
 
 item &map::spawn_an_item(const tripoint &p, item new_item,
@@ -4719,6 +4747,7 @@ void map::process_items( bool const active, T processor, std::string const &sign
                     process_items_in_vehicles(current_submap, processor, signal);
                 }
                 if( !active || !current_submap->active_items.empty() ) {
+                    current_submap->mark_dirty();
                     process_items_in_submap(current_submap, gp, processor, signal);
                 }
             }
@@ -5359,6 +5388,7 @@ int map::set_field_age( const tripoint &p, const field_id t, const int age, bool
     if( field_ptr != nullptr ) {
         int adj = ( isoffset ? field_ptr->getFieldAge() : 0 ) + age;
         field_ptr->setFieldAge( adj );
+        set_submap_dirty( p );
         return adj;
     }
 
@@ -5375,6 +5405,7 @@ int map::set_field_strength( const tripoint &p, const field_id t, const int str,
         int adj = ( isoffset ? field_ptr->getFieldDensity() : 0 ) + str;
         if( adj > 0 ) {
             field_ptr->setFieldDensity( adj );
+            set_submap_dirty( p );
             return adj;
         } else {
             remove_field( p, t );
@@ -5429,6 +5460,7 @@ bool map::add_field(const tripoint &p, const field_id t, int density, const int
 
     submap *const current_submap = get_submap_at( p, lx, ly );
     current_submap->is_uniform = false;
+    current_submap->mark_dirty();
 
     if( current_submap->fld[lx][ly].addField( t, density, age ) ) {
         //Only adding it to the count if it doesn't exist.
@@ -5441,10 +5473,10 @@ bool map::add_field(const tripoint &p, const field_id t, int density, const int
 
     // Dirty the transparency cache now that field processing doesn't always do it
     // TODO: Make it skip transparent fields
-    set_transparency_cache_dirty( p.z );
+    set_transparency_cache_dirty( p );
 
     if( field_type_dangerous( t ) ) {
-        set_pathfinding_cache_dirty( p.z );
+        set_pathfinding_cache_dirty( p );
     }
 
     return true;
@@ -5462,17 +5494,18 @@ void map::remove_field( const tripoint &p, const field_id field_to_remove )
     if( current_submap->fld[lx][ly].removeField( field_to_remove ) ) {
         // Only adjust the count if the field actually existed.
         current_submap->field_count--;
+        current_submap->mark_dirty();
         const auto &fdata = fieldlist[ field_to_remove ];
         for( int i = 0; i < 3; ++i ) {
             if( !fdata.transparent[i] ) {
-                set_transparency_cache_dirty( p.z );
+                set_transparency_cache_dirty( p );
                 break;
             }
         }
 
         for( int i = 0; i < 3; ++i ) {
             if( fdata.dangerous[i] ) {
-                set_pathfinding_cache_dirty( p.z );
+                set_pathfinding_cache_dirty( p );
                 break;
             }
         }
@@ -5567,6 +5600,7 @@ basecamp* map::camp_at( const tripoint &p, const int radius)
             submap * const current_submap = get_submap_at( p );
             if( current_submap->camp.is_valid() ) {
                 // we only allow on camp per size radius, kinda
+                current_submap->mark_dirty();
                 return &(current_submap->camp);
             }
         }
@@ -5582,7 +5616,9 @@ void map::add_camp( const tripoint &p, const std::string& name )
         return;
     }
 
-    get_submap_at( p )->camp = basecamp( name, p.x, p.y );
+    submap *const current_submap = get_submap_at( p );
+    current_submap->camp = basecamp( name, p.x, p.y );
+    current_submap->mark_dirty();
 }
 
 void map::debug()
@@ -6111,8 +6147,34 @@ void map::draw_from_above( WINDOW* w, player &u, const tripoint &p,
 
 bool map::sees( const tripoint &F, const tripoint &T, const int range ) const
 {
+    bool visible = false;
+    if( sight_cache.find( F, T, range, calendar::turn, visible ) ) {
+        return visible;
+    }
     int dummy = 0;
-    return sees( F, T, range, dummy );
+    visible = sees( F, T, range, dummy );
+    sight_cache.insert( F, T, range, visible );
+    return visible;
+}
+
+bool map::sees_in_field( const tripoint &F, const tripoint &T, const int range,
+                         const int radius ) const
+{
+    const int dist = rl_dist( F, T );
+    if( F.z != T.z || dist > std::min( radius, los_cache::max_field_radius ) || !inbounds( F ) ) {
+        return sees( F, T, range );
+    }
+    if( ( range >= 0 && range < dist ) || !inbounds( T ) ) {
+        return false;
+    }
+
+    const los_cache::vision_field *field = sight_cache.find_field( F, radius, calendar::turn );
+    if( field == nullptr ) {
+        los_cache::vision_field built;
+        build_vision_field( F, radius, built );
+        field = &sight_cache.insert_field( F, radius, built );
+    }
+    return field->test( T.x * MAPSIZE * SEEY + T.y );
 }
 
 /**
@@ -6398,6 +6460,7 @@ void map::shift( const int sx, const int sy )
     const int wz = get_abs_sub().z;
 
     set_abs_sub( absx + sx, absy + sy, wz );
+    last_shift = point( sgn( sx ), sgn( sy ) );
 
 // if player is in vehicle, (s)he must be shifted with vehicle too
     if( g->u.in_vehicle ) {
@@ -6601,12 +6664,29 @@ static void generate_uniform( const int x, const int y, const int z, const oter_
     }
 }
 
-void map::loadn( const int gridx, const int gridy, const int gridz, const bool update_vehicles )
+// Generates the overmap terrain whose top left submap is at x,y,z (x and y even), which
+// must not exist yet. Returns whether that took the full mapgen.
+static bool generate_missing( const int x, const int y, const int z )
 {
     // Cache empty overmap types
     static const oter_id rock("empty_rock");
     static const oter_id air("open_air");
 
+    int overx = x;
+    int overy = y;
+    sm_to_omt( overx, overy );
+    const oter_id terrain_type = overmap_buffer.ter( overx, overy, z );
+    if( terrain_type == rock || terrain_type == air ) {
+        generate_uniform( x, y, z, terrain_type );
+        return false;
+    }
+    tinymap tmp_map;
+    tmp_map.generate( x, y, z, calendar::turn );
+    return true;
+}
+
+void map::loadn( const int gridx, const int gridy, const int gridz, const bool update_vehicles )
+{
     dbg(D_INFO) << "map::loadn(game[" << g << "], worldx[" << abs_sub.x << "], worldy[" << abs_sub.y << "], gridx["
                 << gridx << "], gridy[" << gridy << "], gridz[" << gridz << "])";
 
@@ -6629,17 +6709,7 @@ void map::loadn( const int gridx, const int gridy, const int gridz, const bool u
         //  squares divisible by 2.
         const int newmapx = absx - ( abs( absx ) % 2 );
         const int newmapy = absy - ( abs( absy ) % 2 );
-        // Short-circuit if the map tile is uniform
-        int overx = newmapx;
-        int overy = newmapy;
-        sm_to_omt( overx, overy );
-        oter_id terrain_type = overmap_buffer.ter( overx, overy, gridz );
-        if( terrain_type == rock || terrain_type == air ) {
-            generate_uniform( newmapx, newmapy, gridz, terrain_type );
-        } else {
-            tinymap tmp_map;
-            tmp_map.generate( newmapx, newmapy, gridz, calendar::turn );
-        }
+        generate_missing( newmapx, newmapy, gridz );
 
         // This is the same call to MAPBUFFER as above!
         tmpsub = MAPBUFFER.lookup_submap( absx, absy, gridz );
@@ -6681,6 +6751,63 @@ void map::loadn( const int gridx, const int gridy, const int gridz, const bool u
     abs_sub.z = old_abs_z;
 }
 
+int map::generate_ahead( const point &dir, const int max_quads )
+{
+    // How far beyond the edge of the map to look, in submaps
+    static const int lookahead = 4;
+
+    const bool use_dir = dir.x != 0 || dir.y != 0;
+    const int dx = use_dir ? sgn( dir.x ) : last_shift.x;
+    const int dy = use_dir ? sgn( dir.y ) : last_shift.y;
+    if( ( dx == 0 && dy == 0 ) || max_quads <= 0 ) {
+        return 0;
+    }
+
+    const int minx = abs_sub.x - lookahead - ( abs( abs_sub.x - lookahead ) % 2 );
+    const int miny = abs_sub.y - lookahead - ( abs( abs_sub.y - lookahead ) % 2 );
+    const int endx = abs_sub.x + my_MAPSIZE;
+    const int endy = abs_sub.y + my_MAPSIZE;
+    const int minz = zlevels ? -OVERMAP_DEPTH : abs_sub.z;
+    const int maxz = zlevels ? OVERMAP_HEIGHT : abs_sub.z;
+    // Missing overmap terrains (their top left submap) by distance from the map
+    std::vector<std::pair<int, tripoint>> missing;
+    for( int x = minx; x < endx + lookahead; x += 2 ) {
+        // Side of the map the overmap terrain is on (-1, 0 or 1) and how far away it is
+        const int sidex = x + 1 < abs_sub.x ? -1 : ( x >= endx ? 1 : 0 );
+        const int distx = sidex < 0 ? abs_sub.x - x - 1 : ( sidex > 0 ? x - endx + 1 : 0 );
+        for( int y = miny; y < endy + lookahead; y += 2 ) {
+            const int sidey = y + 1 < abs_sub.y ? -1 : ( y >= endy ? 1 : 0 );
+            const int disty = sidey < 0 ? abs_sub.y - y - 1 : ( sidey > 0 ? y - endy + 1 : 0 );
+            const bool ahead = ( sidex != 0 && sidex == dx ) || ( sidey != 0 && sidey == dy );
+            const bool behind = ( sidex != 0 && sidex == -dx ) || ( sidey != 0 && sidey == -dy );
+            if( !ahead || behind ) {
+                continue;
+            }
+            for( int z = minz; z <= maxz; z++ ) {
+                if( MAPBUFFER.lookup_submap( x, y, z ) == nullptr ) {
+                    missing.emplace_back( std::max( distx, disty ), tripoint( x, y, z ) );
+                }
+            }
+        }
+    }
+    std::stable_sort( missing.begin(), missing.end(),
+    []( const std::pair<int, tripoint> &a, const std::pair<int, tripoint> &b ) {
+        return a.first < b.first;
+    } );
+
+    // Uniform ones (solid rock, open air) are cheap and don't count.
+    int generated = 0;
+    for( const auto &m : missing ) {
+        if( generated >= max_quads ) {
+            break;
+        }
+        if( generate_missing( m.second.x, m.second.y, m.second.z ) ) {
+            generated++;
+        }
+    }
+    return generated;
+}
+
 bool map::has_rotten_away( item &itm, const tripoint &pnt ) const
 {
     if( itm.is_corpse() ) {
@@ -7017,6 +7144,8 @@ void map::actualize( const int gridx, const int gridy, const int gridz )
 
     // the last time we touched the submap, is right now.
     tmpsub->turn_last_touched = calendar::turn;
+    // Catching up may have removed rotten items, filled funnels etc.
+    tmpsub->mark_dirty();
 }
 
 void map::add_roofs( const int gridx, const int gridy, const int gridz )
@@ -7064,6 +7193,7 @@ void map::add_roofs( const int gridx, const int gridy, const int gridz )
             }
         }
     }
+    sub_here->mark_dirty();
 }
 
 void map::copy_grid( const tripoint &to, const tripoint &from )
@@ -7246,7 +7376,10 @@ void map::spawn_monsters_submap( const tripoint &gp, bool ignore_sight )
             }
         }
     }
-    current_submap->spawns.clear();
+    if( !current_submap->spawns.empty() ) {
+        current_submap->spawns.clear();
+        current_submap->mark_dirty();
+    }
     overmap_buffer.spawn_monster( abs_sub.x + gp.x, abs_sub.y + gp.y, gp.z );
 }
 
@@ -7270,7 +7403,10 @@ void map::spawn_monsters(bool ignore_sight)
 void map::clear_spawns()
 {
     for( auto & smap : grid ) {
-        smap->spawns.clear();
+        if( !smap->spawns.empty() ) {
+            smap->spawns.clear();
+            smap->mark_dirty();
+        }
     }
 }
 
@@ -7403,6 +7539,9 @@ void map::build_outside_cache( const int zlev )
         return;
     }
 
+    // Sunlight depends on it everywhere
+    ch.lightmap_dirty_submaps.set();
+
     // Make a bigger cache to avoid bounds checking
     // We will later copy it to our regular cache
     const size_t padded_w = ( MAPSIZE * SEEX ) + 2;
@@ -7414,6 +7553,7 @@ void map::build_outside_cache( const int zlev )
     {
         std::uninitialized_fill_n(
             &outside_cache[0][0], ( MAPSIZE * SEEX ) * ( MAPSIZE * SEEY ), false );
+        ch.outside_cache_dirty = false;
         return;
     }
 
@@ -7626,6 +7766,9 @@ tripoint map::getlocal( const tripoint &p ) const
 void map::set_abs_sub(const int x, const int y, const int z)
 {
     abs_sub = tripoint( x, y, z );
+    // Vehicles that left the map must not move on, vehproceed finds the others again.
+    moving_vehicles.clear();
+    sight_cache.invalidate();
 }
 
 tripoint map::get_abs_sub() const
@@ -7970,7 +8113,8 @@ template<typename Functor>
 
 void map::scent_blockers( std::array<std::array<bool, SEEX * MAPSIZE>, SEEY * MAPSIZE> &blocks_scent,
                           std::array<std::array<bool, SEEX * MAPSIZE>, SEEY * MAPSIZE> &reduces_scent,
-                          const int minx, const int miny, const int maxx, const int maxy )
+                          const int minx, const int miny, const int maxx, const int maxy,
+                          const int zlev )
 {
     auto reduce = TFLAG_REDUCE_SCENT;
     auto block = TFLAG_WALL;
@@ -7992,7 +8136,7 @@ void map::scent_blockers( std::array<std::array<bool, SEEX * MAPSIZE>, SEEY * MA
         return ITER_CONTINUE;
     };
 
-    function_over( minx, miny, abs_sub.z, maxx, maxy, abs_sub.z, fill_values );
+    function_over( minx, miny, zlev, maxx, maxy, zlev, fill_values );
 
     // Now vehicles
 
@@ -8001,7 +8145,7 @@ void map::scent_blockers( std::array<std::array<bool, SEEX * MAPSIZE>, SEEY * MA
         return coord.x >= minx && coord.x <= maxx && coord.y >= miny && coord.y <= maxy;
     };
 
-    auto vehs = get_vehicles();
+    auto vehs = get_vehicles( tripoint( 0, 0, zlev ), tripoint( SEEX * my_MAPSIZE, SEEY * my_MAPSIZE, zlev ) );
     for( auto &wrapped_veh : vehs ) {
         vehicle &veh = *(wrapped_veh.v);
         auto obstacles = veh.all_parts_with_feature( VPFLAG_OBSTACLE, true );
@@ -8073,11 +8217,15 @@ level_cache::level_cache()
 {
     transparency_cache_dirty = true;
     outside_cache_dirty = true;
+    transparency_dirty_submaps.set();
+    lightmap_dirty_submaps.set();
+    lightmap_natural_light = 0.0f;
+    lightmap_bio_night = false;
     veh_in_active_range = false;
-    std::fill_n( &veh_exists_at[0][0], SEEX * MAPSIZE * SEEY * MAPSIZE, false );
+    std::fill_n( &veh_parts[0][0], SEEX * MAPSIZE * SEEY * MAPSIZE, veh_cache_cell{ 0, 0 } );
 }
 
-pathfinding_cache::pathfinding_cache()
+pathfinding_cache::pathfinding_cache() : abstraction( false ), obstacle_abstraction( true )
 {
     dirty = true;
 }
@@ -8090,9 +8238,49 @@ pathfinding_cache &map::get_pathfinding_cache( int zlev ) const {
     return *pathfinding_caches[zlev + OVERMAP_DEPTH];
 }
 
+void map::set_transparency_cache_dirty( const tripoint &p )
+{
+    if( inbounds( p ) ) {
+        auto &ch = get_cache( p.z );
+        ch.transparency_cache_dirty = true;
+        ch.transparency_dirty_submaps.set( ( p.x / SEEX ) * MAPSIZE + p.y / SEEY );
+        sight_cache.invalidate();
+    }
+}
+
 void map::set_pathfinding_cache_dirty( const int zlev ) {
     if( inbounds_z( zlev ) ) {
-        get_pathfinding_cache( zlev ).dirty = true;
+        auto &cache = get_pathfinding_cache( zlev );
+        cache.dirty = true;
+        cache.abstraction.set_all_dirty();
+        cache.obstacle_abstraction.set_all_dirty();
+    }
+}
+
+void map::set_pathfinding_cache_dirty( const tripoint &p ) {
+    if( inbounds( p ) ) {
+        auto &cache = get_pathfinding_cache( p.z );
+        cache.dirty = true;
+        cache.abstraction.set_dirty( p.x / SEEX, p.y / SEEY );
+        cache.obstacle_abstraction.set_dirty( p.x / SEEX, p.y / SEEY );
+    }
+}
+
+void map::set_pathfinding_cache_dirty( const vehicle &veh )
+{
+    for( const vehicle_part &part : veh.parts ) {
+        set_pathfinding_cache_dirty( veh.global_part_pos3( part ) );
+    }
+}
+
+void map::set_submap_dirty( const tripoint &p )
+{
+    if( !inbounds( p ) ) {
+        return;
+    }
+    submap *const sm = get_submap_at( p );
+    if( sm != nullptr ) {
+        sm->mark_dirty();
     }
 }
 
@@ -8110,6 +8298,17 @@ const pathfinding_cache &map::get_pathfinding_cache_ref( int zlev ) const
     return cache;
 }
 
+const pathfinding_abstraction &map::get_pathfinding_abstraction_ref( int zlev,
+        bool through_obstacles ) const
+{
+    const auto &cache = get_pathfinding_cache_ref( zlev );
+    auto &level_cache = get_pathfinding_cache( inbounds_z( zlev ) ? zlev : 0 );
+    auto &abstraction = through_obstacles ? level_cache.obstacle_abstraction :
+                        level_cache.abstraction;
+    abstraction.update( cache, my_MAPSIZE );
+    return abstraction;
+}
+
 void map::update_pathfinding_cache( int zlev ) const
 {
     auto &cache = get_pathfinding_cache( zlev );
@@ -8145,6 +8344,14 @@ void map::update_pathfinding_cache( int zlev ) const
                         cur_value |= PF_SLOW;
                     } else if( cost <= 0 ) {
                         cur_value |= PF_WALL;
+                        // Same obstacles as in route_step and bash_rating_internal
+                        const map_bash_info &bash = furniture.id && furniture.bash.str_max != -1 ?
+                                                    furniture.bash : terrain.bash;
+                        const bool flimsy = bash.str_max != -1 && !bash.bash_below &&
+                                            bash.str_min <= flimsy_bash_strength;
+                        if( terrain.open || flimsy ) {
+                            cur_value |= PF_OBSTACLE;
+                        }
                     }
 
                     if( veh != nullptr ) {
@@ -6,6 +6,9 @@
 #include <set>
 #include <map>
 #include <memory>
+#include <bitset>
+#include <unordered_map>
+#include <cstdint>
 
 #include "game_constants.h"
 #include "cursesdef.h"
@@ -19,6 +22,8 @@
 #include "enums.h"
 #include "pathfinding.h"
 #include "emit.h"
+#include "vehicle_schedule.h"
+#include "los_cache.h"
 
 //TODO: include comments about how these variables work. Where are they used. Are they constant etc.
 #define CAMPSIZE 1
@@ -85,6 +90,10 @@ enum ter_bitflags : int;
 template<typename T>
 struct id_or_id;
 struct pathfinding_cache;
+struct pathfinding_settings;
+struct flow_field;
+class pathfinding_abstraction;
+enum pf_special : char;
 
 class map_stack : public item_stack {
 private:
@@ -132,6 +141,20 @@ struct bash_params {
     bool bashed_solid; // Did we bash furniture, terrain or vehicle
 };
 
+// A square in the vehicle cache of a z-level (see level_cache::veh_parts)
+struct veh_cache_cell {
+    // Index of the vehicle in level_cache::cached_vehicles plus one, 0 if there is none
+    uint16_t veh;
+    uint16_t part;
+};
+
+// A vehicle in the vehicle cache and the squares it was entered at,
+// so it can be taken out again without looking at the whole map.
+struct cached_vehicle {
+    vehicle *veh = nullptr;
+    std::vector<point> squares;
+};
+
 struct level_cache {
     level_cache(); // Zeroes all relevant values
     level_cache( const level_cache &other ) = default;
@@ -140,6 +163,15 @@ struct level_cache {
     bool outside_cache_dirty;
     bool floor_cache_dirty;
 
+    // Submaps (indexed x * MAPSIZE + y) that need to be rebuilt, see map::build_transparency_cache
+    std::bitset<MAPSIZE*MAPSIZE> transparency_dirty_submaps;
+    // Submaps where the lightmap must be cast again, see map::generate_lightmap
+    std::bitset<MAPSIZE*MAPSIZE> lightmap_dirty_submaps;
+    // Light sources and conditions the lightmap was last generated with
+    std::vector<light_emitter> light_emitters;
+    float lightmap_natural_light;
+    bool lightmap_bio_night;
+
     float lm[MAPSIZE*SEEX][MAPSIZE*SEEY];
     float sm[MAPSIZE*SEEX][MAPSIZE*SEEY];
     // To prevent redundant ray casting into neighbors: precalculate bulk light source positions.
@@ -152,8 +184,13 @@ struct level_cache {
     lit_level visibility_cache[MAPSIZE*SEEX][MAPSIZE*SEEY];
 
     bool veh_in_active_range;
-    bool veh_exists_at[SEEX * MAPSIZE][SEEY * MAPSIZE];
-    std::map< tripoint, std::pair<vehicle*,int> > veh_cached_parts;
+    // The vehicle part at each square. With several parts on a square, the first one
+    // of the vehicle that was added first.
+    veh_cache_cell veh_parts[SEEX * MAPSIZE][SEEY * MAPSIZE];
+    // Unused entries have no vehicle and are listed in free_cached_vehicles.
+    std::vector<cached_vehicle> cached_vehicles;
+    std::vector<uint16_t> free_cached_vehicles;
+    std::unordered_map<const vehicle *, uint16_t> cached_vehicle_index;
     std::set<vehicle*> vehicle_list;
 };
 
@@ -206,9 +243,14 @@ class map
     /*@{*/
     void set_transparency_cache_dirty( const int zlev ) {
         if( inbounds_z( zlev ) ) {
-            get_cache( zlev ).transparency_cache_dirty = true;
+            auto &ch = get_cache( zlev );
+            ch.transparency_cache_dirty = true;
+            ch.transparency_dirty_submaps.set();
+            sight_cache.invalidate();
         }
     }
+    /** Like above, but only the submap containing the point needs to be rebuilt. */
+    void set_transparency_cache_dirty( const tripoint &p );
 
     void set_outside_cache_dirty( const int zlev ) {
         if( inbounds_z( zlev ) ) {
@@ -223,13 +265,24 @@ class map
     }
 
     void set_pathfinding_cache_dirty( const int zlev );
+    /** Like above, but only the submap containing the point needs a new path abstraction. */
+    void set_pathfinding_cache_dirty( const tripoint &p );
+    /** Like above, for the submaps under the parts of the vehicle. */
+    void set_pathfinding_cache_dirty( const vehicle &veh );
     /*@}*/
 
+    /**
+     * Marks the submap containing the point as changed since it was last saved.
+     * For changes that don't go through the map, like using a computer.
+     * Does nothing if no submap is loaded there, e.g. for vehicle prototypes.
+     */
+    void set_submap_dirty( const tripoint &p );
+
 
     /**
      * Callback invoked when a vehicle has moved.
      */
-    void on_vehicle_moved( const int zlev );
+    void on_vehicle_moved( const vehicle &veh );
 
     /** Determine the visible light level for a tile, based on light_at
      * for the tile, vision distance, etc
@@ -301,6 +354,16 @@ class map
      * Note: the map must have been loaded before this can be called.
      */
     void shift( const int sx, const int sy );
+    /**
+     * Generates the submaps next to the map in the direction of travel that don't exist
+     * yet, so @ref shift only has to load them once the map moves there.
+     * At most max_quads overmap terrains (2x2 submaps each) go through mapgen, the ones
+     * closest to the map first. Call it again on later turns for the rest.
+     * @param dir Direction of travel, only the signs count. (0,0) means the direction
+     * of the last @ref shift.
+     * @return The number of overmap terrains that went through mapgen.
+     */
+    int generate_ahead( const point &dir, int max_quads );
     /**
      * Moves the map vertically to (not by!) newz.
      * Does not actually shift anything, only forces cache updates.
@@ -378,6 +441,22 @@ public:
     * Returns whether `F` sees `T` with a view range of `range`.
     */
     bool sees( const tripoint &F, const tripoint &T, int range ) const;
+    /**
+     * Like @ref sees, but answered from a shadowcast field of view from `F` up to `radius`
+     * squares, which is built once per turn and kept like the results of @ref sees.
+     * Cheaper than @ref sees for observers that check many points, the results match
+     * those of @ref build_seen_cache instead of single lines.
+     * Points on other z-levels or farther than `radius` (or than fields of view can reach,
+     * see @ref los_cache::max_field_radius) are checked with @ref sees.
+     */
+    bool sees_in_field( const tripoint &F, const tripoint &T, int range, int radius ) const;
+    /** Hit rate of the results of @ref sees remembered during a turn. */
+    const los_cache::stats &get_los_cache_stats() const {
+        return sight_cache.get_stats();
+    }
+    void reset_los_cache_stats() {
+        sight_cache.reset_stats();
+    }
  private:
     /**
      * Don't expose the slope adjust outside map functions.
@@ -441,6 +520,16 @@ public:
     std::vector<tripoint> route( const tripoint &f, const tripoint &t,
                                  const pathfinding_settings &settings,
                                  const std::set<tripoint> &pre_closed = {{ }} ) const;
+    /**
+     * Like @ref route, but for destinations that many creatures are heading to at once,
+     * e.g. a horde chasing the player. Instead of one A* search per creature, a single
+     * flow field holding the distance to the destination of every tile on its z-level
+     * is built per turn and movement settings, and each path just follows it downhill.
+     * Falls back to @ref route for destinations on another z-level or that can only
+     * be reached through another z-level.
+     */
+    std::vector<tripoint> route_flow( const tripoint &f, const tripoint &t,
+                                      const pathfinding_settings &settings ) const;
 
  int coord_to_angle(const int x, const int y, const int tgtx, const int tgty) const;
 // Vehicles: Common to 2D and 3D
@@ -449,6 +538,8 @@ public:
     void update_vehicle_cache( vehicle *, int old_zlevel );
     void reset_vehicle_cache( int zlev );
     void clear_vehicle_cache( int zlev );
+    // Takes the vehicle out of the vehicle cache of that z-level, if it's there.
+    void remove_vehicle_from_cache( const vehicle *veh, int zlev );
     void clear_vehicle_list( int zlev );
     void update_vehicle_list( submap * const to, const int zlev );
 
@@ -1004,12 +1095,12 @@ void add_corpse( const tripoint &p );
 
 // Scent propagation helpers
     /**
-     * Build the map of scent-resistant tiles.
+     * Build the map of scent-resistant tiles on the given z-level.
      * Should be way faster than if done in `game.cpp` using public map functions.
      */
     void scent_blockers( std::array<std::array<bool, SEEX * MAPSIZE>, SEEY * MAPSIZE> &blocks_scent,
                          std::array<std::array<bool, SEEX * MAPSIZE>, SEEY * MAPSIZE> &reduces_scent,
-                         int minx, int miny, int maxx, int maxy );
+                         int minx, int miny, int maxx, int maxy, int zlev );
 
 // Computers
     computer* computer_at( const tripoint &p );
@@ -1118,6 +1209,8 @@ public:
          */
         bool pl_line_of_sight( const tripoint &t, int max_range ) const;
     std::set<vehicle*> dirty_vehicle_list;
+    /** The vehicles that still move this turn, see @ref vehproceed */
+    vehicle_schedule moving_vehicles;
 
     /** return @ref abs_sub */
     tripoint get_abs_sub() const;
@@ -1265,7 +1358,11 @@ public:
 protected:
  void generate_lightmap( int zlev );
  void build_seen_cache( const tripoint &origin, int target_z );
+ void build_vision_field( const tripoint &origin, int radius,
+                          los_cache::vision_field &field ) const;
  void apply_character_light( player &p );
+    /** Ambient light indoors when the natural light outside is the given one */
+    static float inside_light_level( float natural_light );
 
  int my_MAPSIZE;
  bool zlevels;
@@ -1279,6 +1376,8 @@ protected:
      * - shifting the map with @ref shift
      */
     tripoint abs_sub;
+    /** Direction (signs only) of the last @ref shift, used by @ref generate_ahead */
+    point last_shift;
     /**
      * Sets @ref abs_sub, see there. Uses the same coordinate system as @ref abs_sub.
      */
@@ -1360,16 +1459,29 @@ private:
 
     long determine_wall_corner( const tripoint &p ) const;
     void cache_seen( const int fx, const int fy, const int tx, const int ty, const int max_range );
+    // The apply_ functions cast light into the given arrays (lm and sm of the level cache,
+    // or per-thread buffers), they only read the map and are safe to call concurrently.
     // apply a circular light pattern immediately, however it's best to use...
-    void apply_light_source( const tripoint &p, float luminance);
+    void apply_light_source( const tripoint &p, float luminance,
+                             float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY],
+                             float (&sm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const;
     // ...this, which will apply the light after at the end of generate_lightmap, and prevent redundant
     // light rays from causing massive slowdowns, if there's a huge amount of light.
     void add_light_source( const tripoint &p, float luminance);
+    // Sources are only collected while generating the lightmap and cast at its end, if needed
+    void add_light_emitter( const light_emitter &emitter );
+    void apply_light_emitter( const light_emitter &emitter,
+                              float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY],
+                              float (&sm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const;
     // Handle just cardinal directions and 45 deg angles.
-    void apply_directional_light( const tripoint &p, int direction, float luminance );
-    void apply_light_arc( const tripoint &p, int angle, float luminance, int wideangle = 30 );
+    void apply_directional_light( const tripoint &p, int direction, float luminance,
+                                  float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const;
+    void apply_light_arc( const tripoint &p, int angle, float luminance, int wideangle,
+                          float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY],
+                          float (&sm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const;
     void apply_light_ray( bool lit[MAPSIZE*SEEX][MAPSIZE*SEEY],
-                          const tripoint &s, const tripoint &e, float luminance );
+                          const tripoint &s, const tripoint &e, float luminance,
+                          float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const;
     void add_light_from_items( const tripoint &p, std::list<item>::iterator begin,
                                std::list<item>::iterator end );
     void calc_ray_end( int angle, int range, const tripoint &p, tripoint &out ) const;
@@ -1447,6 +1559,25 @@ private:
 
     pathfinding_cache &get_pathfinding_cache( int zlev ) const;
 
+    /** Flow fields built during the current turn, see @ref route_flow */
+    mutable std::vector< std::unique_ptr<flow_field> > flow_fields;
+    /** Results of @ref sees, follows the transparency caches. */
+    mutable los_cache sight_cache;
+    const flow_field &get_flow_field( const tripoint &t, const pathfinding_settings &settings ) const;
+
+    enum path_step_result {
+        PATH_STEP_OK,     // Step can be made at the returned cost
+        PATH_STEP_SKIP,   // Can't step onto the tile from here, but maybe from elsewhere
+        PATH_STEP_CLOSED, // Tile can't be entered from anywhere
+        PATH_STEP_LEDGE,  // Tile is a hole that can be dropped through
+    };
+    /**
+     * Cost of a single step from a tile onto the adjacent tile p, shared by
+     * @ref route and the flow fields. The penalty for diagonal steps is not included.
+     */
+    path_step_result route_step( const tripoint &from, const tripoint &p, pf_special p_special,
+                                 const pathfinding_settings &settings, int &cost ) const;
+
     visibility_variables visibility_variables_cache;
 
   public:
@@ -1455,6 +1586,12 @@ private:
     }
 
     const pathfinding_cache &get_pathfinding_cache_ref( int zlev ) const;
+    /**
+     * Submap-level path graph of the z-level, see @ref pathfinding_abstraction
+     * @param through_obstacles Whether the graph is for creatures that open doors or bash.
+     */
+    const pathfinding_abstraction &get_pathfinding_abstraction_ref( int zlev,
+            bool through_obstacles ) const;
 
     void update_pathfinding_cache( int zlev ) const;
 
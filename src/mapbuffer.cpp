@@ -14,14 +14,467 @@
 #include "trap.h"
 #include "vehicle.h"
 #include "submap.h"
+#include "save_writer.h"
+#include "segment_pack.h"
+#include "mapsharing.h"
+#include "options.h"
 
+#include <iterator>
+#include <set>
 #include <sstream>
+#include <stdexcept>
+#include <unordered_map>
 
 #define dbg(x) DebugLog((DebugLevel)(x),D_MAP) << __FILE__ << ":" << __LINE__ << ": "
 
 mapbuffer MAPBUFFER;
 
-mapbuffer::mapbuffer()
+namespace
+{
+
+/**
+ * Binary map files
+ *
+ * Worlds with the MAP_FORMAT option set to "binary" store the submap quads in ".bmap"
+ * files instead of the JSON ".map" files. The content is the same, only smaller and
+ * faster to read. JSON stays the format to look at and edit map data, the debug menu
+ * converts the files of a world both ways.
+ *
+ * Numbers are stored as varints (7 bits per byte, least significant first), signed
+ * numbers zigzag encoded. Strings are a varint length followed by the bytes.
+ *
+ * File: the magic "CDMB", binary_version, savegame_version, the id table (count and
+ * strings) and the submaps (count and submaps). Terrain, furniture, trap and monster
+ * ids are stored as index into the id table, each id is stored only once per file.
+ *
+ * Submap: coordinates, turn_last_touched, temperature; terrain, furniture, traps and
+ * radiation as runs of (count, value) in the same order as the JSON terrain array;
+ * items, fields and cosmetics as (count, then x, y and the content per tile); spawns;
+ * vehicles; the computer and the camp data. Items and vehicles are length prefixed
+ * JSON, their serialization is too involved to duplicate.
+ */
+const char binary_magic[] = { 'C', 'D', 'M', 'B' };
+/** Increase when the layout changes and keep reading the old one. */
+const unsigned int binary_version = 1;
+
+const std::string json_extension = ".map";
+const std::string binary_extension = ".bmap";
+
+bool use_binary_format()
+{
+    return get_world_option<std::string>( "MAP_FORMAT" ) == "binary";
+}
+
+/**
+ * Whether quads are stored in the packs of their segment, see @ref segment_packs.
+ * Other processes write to shared worlds, the pack indices in memory would get outdated.
+ * Those keep using a file per quad and drop the packed copy when they write it. The packs
+ * are still read for the quads that have no file of their own.
+ */
+bool use_packs()
+{
+    return !MAP_SHARING::isSharing();
+}
+
+std::string quad_directory( const tripoint &om_addr )
+{
+    const tripoint segment_addr = omt_to_seg_copy( om_addr );
+    std::ostringstream dirname;
+    dirname << world_generator->active_world->world_path << "/maps/" <<
+            segment_addr.x << "." << segment_addr.y << "." << segment_addr.z;
+    return dirname.str();
+}
+
+std::string quad_path( const tripoint &om_addr, const bool binary )
+{
+    std::ostringstream path;
+    path << quad_directory( om_addr ) << "/" << om_addr.x << "." << om_addr.y << "." << om_addr.z <<
+         ( binary ? binary_extension : json_extension );
+    return path.str();
+}
+
+class binary_out
+{
+    public:
+        std::string data;
+
+        void write( unsigned long long value ) {
+            while( value >= 0x80 ) {
+                data.push_back( static_cast<char>( ( value & 0x7f ) | 0x80 ) );
+                value >>= 7;
+            }
+            data.push_back( static_cast<char>( value ) );
+        }
+        void write_signed( const long long value ) {
+            write( ( static_cast<unsigned long long>( value ) << 1 ) ^
+                   static_cast<unsigned long long>( value >> 63 ) );
+        }
+        void write( const std::string &value ) {
+            write( static_cast<unsigned long long>( value.size() ) );
+            data += value;
+        }
+        template<typename T>
+        void write_json( const T &value ) {
+            std::ostringstream buffer;
+            JsonOut jsout( buffer );
+            jsout.write( value );
+            write( buffer.str() );
+        }
+};
+
+class binary_in
+{
+    public:
+        binary_in( const std::string &data ) : data( data ) {}
+
+        unsigned long long read() {
+            unsigned long long result = 0;
+            for( int shift = 0; ; shift += 7 ) {
+                if( pos >= data.size() ) {
+                    throw std::runtime_error( "unexpected end of file" );
+                }
+                if( shift > 63 ) {
+                    throw std::runtime_error( "malformed number" );
+                }
+                const unsigned char byte = data[pos++];
+                result |= static_cast<unsigned long long>( byte & 0x7f ) << shift;
+                if( ( byte & 0x80 ) == 0 ) {
+                    return result;
+                }
+            }
+        }
+        long long read_signed() {
+            const unsigned long long value = read();
+            return static_cast<long long>( value >> 1 ) ^ -static_cast<long long>( value & 1 );
+        }
+        /** Reads a number that must be below limit, like a coordinate or an index. */
+        int read_below( const unsigned long long limit ) {
+            const unsigned long long value = read();
+            if( value >= limit ) {
+                throw std::runtime_error( "value out of range" );
+            }
+            return static_cast<int>( value );
+        }
+        std::string read_string() {
+            const unsigned long long size = read();
+            if( size > data.size() - pos ) {
+                throw std::runtime_error( "unexpected end of file" );
+            }
+            std::string result = data.substr( pos, size );
+            pos += size;
+            return result;
+        }
+        bool read_magic() {
+            if( data.size() < sizeof( binary_magic ) ||
+                data.compare( 0, sizeof( binary_magic ), binary_magic, sizeof( binary_magic ) ) != 0 ) {
+                return false;
+            }
+            pos = sizeof( binary_magic );
+            return true;
+        }
+        bool at_end() const {
+            return pos == data.size();
+        }
+
+    private:
+        const std::string &data;
+        size_t pos = 0;
+};
+
+/** Maps the ids of a file to indices into its id table. */
+class id_table
+{
+    public:
+        std::vector<std::string> ids;
+
+        unsigned int index( const std::string &id ) {
+            const auto iter = indices.find( id );
+            if( iter != indices.end() ) {
+                return iter->second;
+            }
+            ids.push_back( id );
+            indices[id] = ids.size() - 1;
+            return ids.size() - 1;
+        }
+
+    private:
+        std::unordered_map<std::string, unsigned int> indices;
+};
+
+/** Writes value_at( i, j ) of all the tiles of a submap as runs of (count, value). */
+template<typename F>
+void write_runs( binary_out &out, F value_at )
+{
+    unsigned long long last = 0;
+    int count = 0;
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            const unsigned long long value = value_at( i, j );
+            if( count > 0 && value != last ) {
+                out.write( count );
+                out.write( last );
+                count = 0;
+            }
+            last = value;
+            count++;
+        }
+    }
+    out.write( count );
+    out.write( last );
+}
+
+/** Reads what @ref write_runs wrote, calling set( i, j, value ) for all the tiles. */
+template<typename F>
+void read_runs( binary_in &in, F set )
+{
+    int tile = 0;
+    while( tile < SEEX * SEEY ) {
+        const int count = in.read_below( SEEX * SEEY - tile + 1 );
+        const unsigned long long value = in.read();
+        if( count == 0 ) {
+            throw std::runtime_error( "empty run" );
+        }
+        for( const int end = tile + count; tile < end; tile++ ) {
+            set( tile % SEEX, tile / SEEX, value );
+        }
+    }
+}
+
+/** Zigzag encoding, so negative radiation stays small in @ref write_runs */
+unsigned long long zigzag( const int value )
+{
+    return ( static_cast<unsigned long long>( value ) << 1 ) ^
+           static_cast<unsigned long long>( static_cast<long long>( value ) >> 63 );
+}
+
+int unzigzag( const unsigned long long value )
+{
+    return static_cast<int>( static_cast<long long>( value >> 1 ) ^ -static_cast<long long>( value & 1 ) );
+}
+
+/** Reads an array of items into the tile i, j of the submap. */
+void read_items( submap &sm, const int i, const int j, JsonIn &jsin )
+{
+    jsin.start_array();
+    while( !jsin.end_array() ) {
+        item tmp;
+        jsin.read( tmp );
+
+        if( tmp.is_emissive() ) {
+            sm.update_lum_add(tmp, i, j);
+        }
+
+        tmp.visit_items( [ &sm, i, j ]( item *it ) {
+            for( auto& e: it->magazine_convert() ) {
+                sm.itm[i][j].push_back( e );
+            }
+            return VisitResponse::NEXT;
+        } );
+
+        sm.itm[i][j].push_back( tmp );
+        if( tmp.needs_processing() ) {
+            sm.active_items.add( std::prev(sm.itm[i][j].end()), point( i, j ) );
+        }
+    }
+}
+
+void write_binary_submap( binary_out &out, id_table &ids, const tripoint &submap_addr,
+                          submap &sm )
+{
+    out.write_signed( submap_addr.x );
+    out.write_signed( submap_addr.y );
+    out.write_signed( submap_addr.z );
+    out.write_signed( sm.turn_last_touched );
+    out.write_signed( sm.temperature );
+
+    write_runs( out, [&sm, &ids]( int i, int j ) {
+        return ids.index( sm.ter[i][j].obj().id.str() );
+    } );
+    write_runs( out, [&sm, &ids]( int i, int j ) {
+        return ids.index( sm.get_furn( i, j ).obj().id.str() );
+    } );
+    write_runs( out, [&sm, &ids]( int i, int j ) {
+        return ids.index( sm.get_trap( i, j ).id().str() );
+    } );
+    write_runs( out, [&sm]( int i, int j ) {
+        return zigzag( sm.get_radiation( i, j ) );
+    } );
+
+    std::vector<point> tiles;
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            if( !sm.itm[i][j].empty() ) {
+                tiles.push_back( point( i, j ) );
+            }
+        }
+    }
+    out.write( tiles.size() );
+    for( const point &p : tiles ) {
+        out.write( p.x );
+        out.write( p.y );
+        out.write_json( sm.itm[p.x][p.y] );
+    }
+
+    tiles.clear();
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            if( sm.fld[i][j].fieldCount() > 0 ) {
+                tiles.push_back( point( i, j ) );
+            }
+        }
+    }
+    out.write( tiles.size() );
+    for( const point &p : tiles ) {
+        const field &fields = sm.fld[p.x][p.y];
+        out.write( p.x );
+        out.write( p.y );
+        out.write( fields.fieldCount() );
+        for( auto &fld : fields ) {
+            const field_entry &cur = fld.second;
+            out.write( cur.getFieldType() );
+            out.write_signed( cur.getFieldDensity() );
+            out.write_signed( cur.getFieldAge() );
+        }
+    }
+
+    tiles.clear();
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            if( !sm.cosmetics[i][j].empty() ) {
+                tiles.push_back( point( i, j ) );
+            }
+        }
+    }
+    out.write( tiles.size() );
+    for( const point &p : tiles ) {
+        out.write( p.x );
+        out.write( p.y );
+        out.write( sm.cosmetics[p.x][p.y].size() );
+        for( auto &cosmetic : sm.cosmetics[p.x][p.y] ) {
+            out.write( cosmetic.first );
+            out.write( cosmetic.second );
+        }
+    }
+
+    out.write( sm.spawns.size() );
+    for( auto &elem : sm.spawns ) {
+        out.write( ids.index( elem.type.str() ) );
+        out.write_signed( elem.count );
+        out.write_signed( elem.posx );
+        out.write_signed( elem.posy );
+        out.write_signed( elem.faction_id );
+        out.write_signed( elem.mission_id );
+        out.write( elem.friendly ? 1 : 0 );
+        out.write( elem.name );
+    }
+
+    out.write( sm.vehicles.size() );
+    for( auto &elem : sm.vehicles ) {
+        out.write_json( *elem );
+    }
+
+    out.write( sm.comp.name != "" ? sm.comp.save_data() : std::string() );
+    out.write( sm.camp.is_valid() ? sm.camp.save_data() : std::string() );
+}
+
+std::unique_ptr<submap> read_binary_submap( binary_in &in, const std::vector<std::string> &ids,
+        tripoint &submap_addr )
+{
+    std::unique_ptr<submap> sm( new submap() );
+    submap_addr.x = in.read_signed();
+    submap_addr.y = in.read_signed();
+    submap_addr.z = in.read_signed();
+    sm->turn_last_touched = in.read_signed();
+    sm->temperature = in.read_signed();
+
+    const auto id_at = [&ids]( const unsigned long long index ) -> const std::string & {
+        if( index >= ids.size() ) {
+            throw std::runtime_error( "invalid id index" );
+        }
+        return ids[index];
+    };
+    read_runs( in, [&sm, &id_at]( int i, int j, unsigned long long value ) {
+        sm->ter[i][j] = ter_str_id( id_at( value ) ).id();
+    } );
+    read_runs( in, [&sm, &id_at]( int i, int j, unsigned long long value ) {
+        sm->frn[i][j] = furn_str_id( id_at( value ) ).id();
+    } );
+    read_runs( in, [&sm, &id_at]( int i, int j, unsigned long long value ) {
+        sm->trp[i][j] = trap_str_id( id_at( value ) ).id();
+    } );
+    read_runs( in, [&sm]( int i, int j, unsigned long long value ) {
+        sm->set_radiation( i, j, unzigzag( value ) );
+    } );
+
+    for( unsigned long long tiles = in.read(); tiles > 0; tiles-- ) {
+        const int i = in.read_below( SEEX );
+        const int j = in.read_below( SEEY );
+        const std::string json = in.read_string();
+        memory_streambuf buffer( json.data(), json.size() );
+        std::istream fin( &buffer );
+        JsonIn jsin( fin );
+        read_items( *sm, i, j, jsin );
+    }
+
+    for( unsigned long long tiles = in.read(); tiles > 0; tiles-- ) {
+        const int i = in.read_below( SEEX );
+        const int j = in.read_below( SEEY );
+        for( unsigned long long n = in.read(); n > 0; n-- ) {
+            const field_id type = field_id( in.read_below( num_fields ) );
+            const int density = in.read_signed();
+            const int age = in.read_signed();
+            if( sm->fld[i][j].findField( type ) == NULL ) {
+                sm->field_count++;
+            }
+            sm->fld[i][j].addField( type, density, age );
+        }
+    }
+
+    for( unsigned long long tiles = in.read(); tiles > 0; tiles-- ) {
+        const int i = in.read_below( SEEX );
+        const int j = in.read_below( SEEY );
+        for( unsigned long long n = in.read(); n > 0; n-- ) {
+            std::string key = in.read_string();
+            sm->cosmetics[i][j][key] = in.read_string();
+        }
+    }
+
+    for( unsigned long long n = in.read(); n > 0; n-- ) {
+        const mtype_id type( id_at( in.read() ) );
+        const int count = in.read_signed();
+        const int i = in.read_signed();
+        const int j = in.read_signed();
+        const int faction_id = in.read_signed();
+        const int mission_id = in.read_signed();
+        const bool friendly = in.read() != 0;
+        const std::string name = in.read_string();
+        sm->spawns.push_back( spawn_point( type, count, i, j, faction_id, mission_id, friendly, name ) );
+    }
+
+    for( unsigned long long n = in.read(); n > 0; n-- ) {
+        const std::string json = in.read_string();
+        memory_streambuf buffer( json.data(), json.size() );
+        std::istream fin( &buffer );
+        JsonIn jsin( fin );
+        std::unique_ptr<vehicle> veh( new vehicle() );
+        jsin.read( *veh );
+        sm->vehicles.push_back( veh.release() );
+    }
+
+    const std::string computer_data = in.read_string();
+    if( !computer_data.empty() ) {
+        sm->comp.load_data( computer_data );
+    }
+    const std::string camp_data = in.read_string();
+    if( !camp_data.empty() ) {
+        sm->camp.load_data( camp_data );
+    }
+    return sm;
+}
+
+} // namespace
+
+mapbuffer::mapbuffer() : packs( new segment_packs() )
 {
 }
 
@@ -36,6 +489,7 @@ void mapbuffer::reset()
         delete elem.second;
     }
     submaps.clear();
+    packs->reset();
 }
 
 bool mapbuffer::add_submap(const tripoint &p, submap *sm)
@@ -99,7 +553,7 @@ submap *mapbuffer::lookup_submap( const tripoint &p )
     return iter->second;
 }
 
-void mapbuffer::save( bool delete_after_save )
+void mapbuffer::save( bool delete_after_save, bool save_all )
 {
     std::stringstream map_directory;
     map_directory << world_generator->active_world->world_path << "/maps";
@@ -110,6 +564,11 @@ void mapbuffer::save( bool delete_after_save )
 
     const tripoint map_origin = sm_to_omt_copy( g->m.get_abs_sub() );
     const bool map_has_zlevels = g != nullptr && g->m.has_zlevels();
+    const bool binary = use_binary_format();
+    if( !use_packs() ) {
+        // Other processes may have dropped quads from the packs since the indices were read
+        packs->reset();
+    }
 
     // A set of already-saved submaps, in global overmap coordinates.
     std::set<tripoint> saved_submaps;
@@ -133,36 +592,92 @@ void mapbuffer::save( bool delete_after_save )
         }
         saved_submaps.insert( om_addr );
 
-        // A segment is a chunk of 32x32 submap quads.
-        // We're breaking them into subdirectories so there aren't too many files per directory.
-        // Might want to make a set for this one too so it's only checked once per save().
-        std::stringstream dirname;
-        tripoint segment_addr = omt_to_seg_copy( om_addr );
-        dirname << map_directory.str() << "/" << segment_addr.x << "." <<
-                     segment_addr.y << "." << segment_addr.z;
-
-        std::stringstream quad_path;
-        quad_path << dirname.str() << "/" << om_addr.x << "." <<
-                  om_addr.y << "." << om_addr.z << ".map";
-
         // delete_on_save deletes everything, otherwise delete submaps
         // outside the current map.
         const bool zlev_del = !map_has_zlevels && om_addr.z != g->get_levz();
-        save_quad( dirname.str(), quad_path.str(), om_addr, submaps_to_delete,
+        save_quad( om_addr, binary, submaps_to_delete,
                    delete_after_save || zlev_del ||
                    om_addr.x < map_origin.x || om_addr.y < map_origin.y ||
                    om_addr.x > map_origin.x + (MAPSIZE / 2) ||
-                   om_addr.y > map_origin.y + (MAPSIZE / 2) );
+                   om_addr.y > map_origin.y + (MAPSIZE / 2), save_all );
         num_saved_submaps += 4;
     }
     for( auto &elem : submaps_to_delete ) {
         remove_submap( elem );
     }
+    packs->flush();
 }
 
-void mapbuffer::save_quad( const std::string &dirname, const std::string &filename,
-                           const tripoint &om_addr, std::list<tripoint> &submaps_to_delete,
-                           bool delete_after_save )
+int mapbuffer::convert_files()
+{
+    const bool binary = use_binary_format();
+    // What's in memory may be newer than the files
+    save( false, true );
+
+    // Quads in files of their own (in either format) and packed quads in the other format
+    std::set<tripoint> to_convert;
+    const std::string map_directory = world_generator->active_world->world_path + "/maps";
+    for( const std::string &extension : {
+             json_extension, binary_extension
+         } ) {
+        for( const std::string &file : get_files_from_path( extension, map_directory, true, true ) ) {
+            // The file name is the overmap terrain position, x.y.z.map
+            std::istringstream name( file.substr( file.find_last_of( "/\\" ) + 1 ) );
+            tripoint om_addr;
+            char dot1 = 0;
+            char dot2 = 0;
+            name >> om_addr.x >> dot1 >> om_addr.y >> dot2 >> om_addr.z;
+            if( name && dot1 == '.' && dot2 == '.' ) {
+                to_convert.insert( om_addr );
+            }
+        }
+    }
+    for( const std::string &index : get_files_from_path( segment_packs::index_name, map_directory,
+            true, true ) ) {
+        for( auto &quad : packs->contents( index.substr( 0, index.find_last_of( "/\\" ) ) ) ) {
+            if( quad.second != binary ) {
+                to_convert.insert( quad.first );
+            }
+        }
+    }
+
+    int num_converted = 0;
+    for( const tripoint &om_addr : to_convert ) {
+        if( num_converted % 100 == 0 ) {
+            popup_nowait( _( "Please wait as the map files are converted [%d/%d]" ), num_converted,
+                          int( to_convert.size() ) );
+        }
+        // The quads that were in memory have just been saved, don't overwrite them
+        if( submaps.count( omt_to_sm_copy( om_addr ) ) > 0 || !load_quad( om_addr ) ) {
+            continue;
+        }
+        std::list<tripoint> submaps_to_delete;
+        save_quad( om_addr, binary, submaps_to_delete, true, true );
+        for( auto &elem : submaps_to_delete ) {
+            remove_submap( elem );
+        }
+        num_converted++;
+    }
+    packs->flush();
+    save_writer::get().flush();
+    return num_converted;
+}
+
+/**
+ * Whether the submap differs from what was last written to disk.
+ * Vehicles change all the time without going through the submap, so submaps with
+ * vehicles always count as changed. The map sets turn_last_touched of all the submaps
+ * it holds on every save, that alone is written only when the submap gets unloaded.
+ */
+static bool needs_saving( const submap &sm, const bool unloading )
+{
+    return sm.is_dirty() || !sm.vehicles.empty() ||
+           ( unloading && sm.turn_last_touched != sm.saved_turn_last_touched );
+}
+
+void mapbuffer::save_quad( const tripoint &om_addr, bool binary,
+                           std::list<tripoint> &submaps_to_delete,
+                           bool delete_after_save, bool save_all )
 {
     std::vector<point> offsets;
     std::vector<tripoint> submap_addrs;
@@ -172,6 +687,7 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
     offsets.push_back( point(1, 1) );
 
     bool all_uniform = true;
+    bool changed = save_all;
     for( auto &offsets_offset : offsets ) {
         tripoint submap_addr = omt_to_sm_copy( om_addr );
         submap_addr.x += offsets_offset.x;
@@ -181,10 +697,14 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
         if( sm != nullptr && !sm->is_uniform ) {
             all_uniform = false;
         }
+        if( sm != nullptr && needs_saving( *sm, delete_after_save ) ) {
+            changed = true;
+        }
     }
 
-    if( all_uniform ) {
-        // Nothing to save - this quad will be regenerated faster than it would be re-read
+    if( all_uniform || !changed ) {
+        // Nothing to save - this quad will be regenerated faster than it would be re-read,
+        // or the file already has the current content
         if( delete_after_save ) {
             for( auto &submap_addr : submap_addrs ) {
                 if( submaps.count( submap_addr ) > 0 && submaps[submap_addr] != nullptr ) {
@@ -196,9 +716,69 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
         return;
     }
 
+    // A segment is a chunk of 32x32 submap quads.
+    // We're breaking them into subdirectories so there aren't too many files per directory.
     // Don't create the directory if it would be empty
-    assure_dir_exist( dirname.c_str() );
-    ofstream_wrapper_exclusive fout( filename );
+    assure_dir_exist( quad_directory( om_addr ) );
+    // Only serialize here, the file is written in the background
+    std::string data = binary ? serialize_quad_binary( submap_addrs ) :
+                       serialize_quad_json( submap_addrs );
+    if( use_packs() ) {
+        packs->write( quad_directory( om_addr ), om_addr, binary, std::move( data ) );
+        // The quad may have been stored in a file of its own before
+        save_writer::get().remove( quad_path( om_addr, false ) );
+        save_writer::get().remove( quad_path( om_addr, true ) );
+    } else {
+        save_writer::get().write( quad_path( om_addr, binary ), std::move( data ), true,
+                                  _( "map data" ) );
+        // Once written, the file in the other format and the packed copy are outdated
+        save_writer::get().remove( quad_path( om_addr, !binary ) );
+        packs->remove( quad_directory( om_addr ), om_addr );
+    }
+
+    for( auto &submap_addr : submap_addrs ) {
+        submap *sm = submaps[submap_addr];
+        if( sm == nullptr ) {
+            continue;
+        }
+        sm->mark_saved();
+        if( delete_after_save ) {
+            submaps_to_delete.push_back( submap_addr );
+        }
+    }
+}
+
+std::string mapbuffer::serialize_quad_binary( const std::vector<tripoint> &submap_addrs )
+{
+    // The id table goes first, but is only complete after the submaps
+    id_table ids;
+    binary_out body;
+    int count = 0;
+    for( auto &submap_addr : submap_addrs ) {
+        const auto iter = submaps.find( submap_addr );
+        if( iter == submaps.end() || iter->second == nullptr ) {
+            continue;
+        }
+        write_binary_submap( body, ids, submap_addr, *iter->second );
+        count++;
+    }
+
+    binary_out fout;
+    fout.data.assign( binary_magic, sizeof( binary_magic ) );
+    fout.write( binary_version );
+    fout.write( savegame_version );
+    fout.write( ids.ids.size() );
+    for( auto &id : ids.ids ) {
+        fout.write( id );
+    }
+    fout.write( count );
+    fout.data += body.data;
+    return fout.data;
+}
+
+std::string mapbuffer::serialize_quad_json( const std::vector<tripoint> &submap_addrs )
+{
+    std::ostringstream fout;
     JsonOut jsout( fout );
     jsout.start_array();
     for( auto &submap_addr : submap_addrs ) {
@@ -243,7 +823,7 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
         int count = 0;
         for(int j = 0; j < SEEY; j++) {
             for(int i = 0; i < SEEX; i++) {
-                // Save radiation, re-examine this because it doesn't look like it works right
+                // Save radiation
                 int r = sm->get_radiation(i, j);
                 if (r == lastrad) {
                     count++;
@@ -380,14 +960,11 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
             jsout.member( "camp" );
             jsout.write( sm->camp.save_data() );
         }
-        if( delete_after_save ) {
-            submaps_to_delete.push_back( submap_addr );
-        }
         jsout.end_object();
     }
 
     jsout.end_array();
-    fout.close();
+    return fout.str();
 }
 
 // We're reading in way too many entities here to mess around with creating sub-objects and
@@ -396,25 +973,101 @@ submap *mapbuffer::unserialize_submaps( const tripoint &p )
 {
     // Map the tripoint to the submap quad that stores it.
     const tripoint om_addr = sm_to_omt_copy( p );
-    const tripoint segment_addr = omt_to_seg_copy( om_addr );
-    std::stringstream quad_path;
-    quad_path << world_generator->active_world->world_path << "/maps/" <<
-              segment_addr.x << "." << segment_addr.y << "." << segment_addr.z << "/" <<
-              om_addr.x << "." << om_addr.y << "." << om_addr.z << ".map";
-
-    using namespace std::placeholders;
-    if( !read_from_file_optional_json( quad_path.str(), std::bind( &mapbuffer::deserialize, this, _1 ) ) ) {
+    if( !load_quad( om_addr ) ) {
         // If it doesn't exist, trigger generating it.
         return NULL;
     }
     if( submaps.count( p ) == 0 ) {
-        debugmsg("file %s did not contain the expected submap %d,%d,%d", quad_path.str().c_str(), p.x, p.y,
-                 p.z);
+        debugmsg( "map quad %d,%d,%d did not contain the expected submap %d,%d,%d", om_addr.x, om_addr.y,
+                  om_addr.z, p.x, p.y, p.z );
         return NULL;
     }
     return submaps[ p ];
 }
 
+bool mapbuffer::load_quad( const tripoint &om_addr )
+{
+    // Saving removes the other copies. Until then, the one that is written is newer.
+    if( use_packs() ) {
+        return read_packed_quad( om_addr ) || read_quad_file( om_addr );
+    }
+    return read_quad_file( om_addr ) || read_packed_quad( om_addr );
+}
+
+bool mapbuffer::read_packed_quad( const tripoint &om_addr )
+{
+    bool binary = false;
+    std::string data;
+    if( !packs->read( quad_directory( om_addr ), om_addr, binary, data ) ) {
+        return false;
+    }
+    if( binary ) {
+        deserialize_binary( data );
+    } else {
+        memory_streambuf buffer( data.data(), data.size() );
+        std::istream fin( &buffer );
+        JsonIn jsin( fin );
+        deserialize( jsin );
+    }
+    return true;
+}
+
+bool mapbuffer::read_quad_file( const tripoint &om_addr )
+{
+    // The world may have been switched to the other format, its files are converted when saved
+    const bool binary = use_binary_format();
+    return read_quad_file( quad_path( om_addr, binary ), binary ) ||
+           read_quad_file( quad_path( om_addr, !binary ), !binary );
+}
+
+bool mapbuffer::read_quad_file( const std::string &path, const bool binary )
+{
+    if( !binary ) {
+        using namespace std::placeholders;
+        return read_from_file_optional_json( path, std::bind( &mapbuffer::deserialize, this, _1 ) );
+    }
+    return read_from_file_optional( path, [this]( std::istream & fin ) {
+        const std::string data( ( std::istreambuf_iterator<char>( fin ) ),
+                                std::istreambuf_iterator<char>() );
+        deserialize_binary( data );
+    } );
+}
+
+void mapbuffer::deserialize_binary( const std::string &data )
+{
+    binary_in in( data );
+    if( !in.read_magic() ) {
+        throw std::runtime_error( "not a binary map file" );
+    }
+    if( in.read() > binary_version ) {
+        throw std::runtime_error( "map file is from a newer version" );
+    }
+    // savegame_version, only files of the current version are written in this format so far
+    in.read();
+
+    std::vector<std::string> ids( in.read_below( data.size() + 1 ) );
+    for( auto &id : ids ) {
+        id = in.read_string();
+    }
+    // Don't add anything from a broken file
+    std::vector<std::pair<tripoint, std::unique_ptr<submap>>> loaded;
+    for( unsigned long long count = in.read(); count > 0; count-- ) {
+        tripoint submap_coordinates;
+        std::unique_ptr<submap> sm = read_binary_submap( in, ids, submap_coordinates );
+        loaded.emplace_back( submap_coordinates, std::move( sm ) );
+    }
+    if( !in.at_end() ) {
+        throw std::runtime_error( "unexpected data at end of file" );
+    }
+
+    for( auto &elem : loaded ) {
+        elem.second->mark_saved();
+        if( !add_submap( elem.first, elem.second ) ) {
+            debugmsg( "submap %d,%d,%d was already loaded", elem.first.x, elem.first.y, elem.first.z );
+        }
+    }
+}
+
 void mapbuffer::deserialize( JsonIn &jsin )
 {
     jsin.start_array();
@@ -491,9 +1144,9 @@ void mapbuffer::deserialize( JsonIn &jsin )
                     int rad_strength = jsin.get_int();
                     int rad_num = jsin.get_int();
                     for( int i = 0; i < rad_num; ++i ) {
-                        // A little array trick here, assign to it as a 1D array.
+                        // Same order as the terrain, rows of SEEX tiles.
                         // If it's not in bounds we're kinda hosed anyway.
-                        sm->set_radiation(0, rad_cell, rad_strength);
+                        sm->set_radiation( rad_cell % SEEX, rad_cell / SEEX, rad_strength );
                         rad_cell++;
                     }
                 }
@@ -511,27 +1164,7 @@ void mapbuffer::deserialize( JsonIn &jsin )
                 while( !jsin.end_array() ) {
                     int i = jsin.get_int();
                     int j = jsin.get_int();
-                    jsin.start_array();
-                    while( !jsin.end_array() ) {
-                        item tmp;
-                        jsin.read( tmp );
-
-                        if( tmp.is_emissive() ) {
-                            sm->update_lum_add(tmp, i, j);
-                        }
-
-                        tmp.visit_items( [ &sm, i, j ]( item *it ) {
-                            for( auto& e: it->magazine_convert() ) {
-                                sm->itm[i][j].push_back( e );
-                            }
-                            return VisitResponse::NEXT;
-                        } );
-
-                        sm->itm[i][j].push_back( tmp );
-                        if( tmp.needs_processing() ) {
-                            sm->active_items.add( std::prev(sm->itm[i][j].end()), point( i, j ) );
-                        }
-                    }
+                    read_items( *sm, i, j, jsin );
                 }
             } else if( submap_member_name == "traps" ) {
                 jsin.start_array();
@@ -611,6 +1244,9 @@ void mapbuffer::deserialize( JsonIn &jsin )
                 jsin.skip_value();
             }
         }
+        if( !rubpow_update ) {
+            sm->mark_saved();
+        }
         if( !add_submap( submap_coordinates, sm ) ) {
             debugmsg( "submap %d,%d,%d was already loaded", submap_coordinates.x, submap_coordinates.y,
                       submap_coordinates.z );
@@ -5,10 +5,12 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 #include "enums.h"
 struct point;
 struct tripoint;
 struct submap;
+class segment_packs;
 
 /**
  * Store, buffer, save and load the entire world map.
@@ -21,11 +23,21 @@ class mapbuffer
 
         /** Load the entire world from savefiles into submaps in this instance. **/
         void load( std::string worldname );
-        /** Store all submaps in this instance into savefiles.
+        /** Store the submaps in this instance into savefiles.
+         * Only quads that changed since they were last written are stored,
+         * see @ref submap::generation.
          * @ref delete_after_save If true, the saved submaps are removed
          * from the mapbuffer (and deleted).
+         * @ref save_all If true, all quads are stored, changed or not.
          **/
-        void save( bool delete_after_save = false );
+        void save( bool delete_after_save = false, bool save_all = false );
+
+        /**
+         * Rewrites all map files of the world in the format set by the MAP_FORMAT
+         * world option, see mapbuffer.cpp.
+         * @return The number of quads read from files in the other format.
+         */
+        int convert_files();
 
         /** Delete all buffered submaps. **/
         void reset();
@@ -73,11 +85,20 @@ class mapbuffer
         // if not handled carefully, this can erase in-use submaps and crash the game.
         void remove_submap( tripoint addr );
         submap *unserialize_submaps( const tripoint &p );
+        /** Adds the submaps of the quad from its pack or file. @return false if there are none. */
+        bool load_quad( const tripoint &om_addr );
+        bool read_packed_quad( const tripoint &om_addr );
+        bool read_quad_file( const tripoint &om_addr );
+        /** Reads a quad file of the given format. @return false if it doesn't exist or is broken. */
+        bool read_quad_file( const std::string &path, bool binary );
         void deserialize( JsonIn &jsin );
-        void save_quad( const std::string &dirname, const std::string &filename,
-                        const tripoint &om_addr, std::list<tripoint> &submaps_to_delete,
-                        bool delete_after_save );
+        void deserialize_binary( const std::string &data );
+        void save_quad( const tripoint &om_addr, bool binary, std::list<tripoint> &submaps_to_delete,
+                        bool delete_after_save, bool save_all );
+        std::string serialize_quad_json( const std::vector<tripoint> &submap_addrs );
+        std::string serialize_quad_binary( const std::vector<tripoint> &submap_addrs );
         submap_map_t submaps;
+        std::unique_ptr<segment_packs> packs;
 };
 
 extern mapbuffer MAPBUFFER;
@@ -10331,6 +10331,7 @@ void map::add_spawn(const mtype_id& type, int count, int x, int y, bool friendly
     }
     spawn_point tmp(type, count, offset_x, offset_y, faction_id, mission_id, friendly, name);
     place_on_submap->spawns.push_back(tmp);
+    place_on_submap->mark_dirty();
 }
 
 vehicle *map::add_vehicle(const vproto_id &type, const int x, const int y, const int dir,
@@ -10388,6 +10389,7 @@ vehicle *map::add_vehicle(const vproto_id &type, const tripoint &p, const int di
         submap *place_on_submap = get_submap_at_grid( placed_vehicle->smx, placed_vehicle->smy, placed_vehicle->smz );
         place_on_submap->vehicles.push_back(placed_vehicle);
         place_on_submap->is_uniform = false;
+        place_on_submap->mark_dirty();
 
         auto &ch = get_cache( placed_vehicle->smz );
         ch.vehicle_list.insert(placed_vehicle);
@@ -10523,6 +10525,7 @@ computer *map::add_computer( const tripoint &p, std::string name, int security )
     ter_set( p, t_console ); // TODO: Turn this off?
     submap *place_on_submap = get_submap_at( p );
     place_on_submap->comp = computer(name, security);
+    place_on_submap->mark_dirty();
     return &(place_on_submap->comp);
 }
 
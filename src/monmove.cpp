@@ -5,6 +5,7 @@
 #include "map_iterator.h"
 #include "debug.h"
 #include "game.h"
+#include "creature_tracker.h"
 #include "line.h"
 #include "rng.h"
 #include "pldata.h"
@@ -20,6 +21,7 @@
 #include "field.h"
 #include "scent_map.h"
 
+#include <algorithm>
 #include <stdlib.h>
 //Used for e^(x) functions
 #include <stdio.h>
@@ -191,6 +193,13 @@ float monster::rate_target( Creature &c, float best, bool smart ) const
     return INT_MAX;
 }
 
+// Friendly monsters are on the player's side, whatever their own faction is
+mfaction_id monster::planning_faction() const
+{
+    static const mfaction_str_id playerfaction( "player" );
+    return friendly == 0 ? faction : playerfaction.id();
+}
+
 void monster::plan( const mfactions &factions )
 {
     // Bots are more intelligent than most living stuff
@@ -207,6 +216,10 @@ void monster::plan( const mfactions &factions )
     bool group_morale = has_flag( MF_GROUP_MORALE ) && morale < type->morale;
     bool swarms = has_flag( MF_SWARMS );
     auto mood = attitude();
+    // We can't see (so @ref rate_target won't pick) monsters farther away than that
+    const int max_sight_range = std::max( { 1, sight_range( DAYLIGHT_LEVEL ), sight_range( 0 ) } );
+    // Bots and friendly monsters rate every hostile in sight
+    set_vision_field( smart_planning || friendly != 0 );
 
     // If we can see the player, move toward them or flee.
     if( friendly == 0 && sees( g->u ) ) {
@@ -217,10 +230,10 @@ void monster::plan( const mfactions &factions )
             anger += angers_hostile_near;
             morale -= fears_hostile_near;
         }
-    } else if( friendly != 0 && !docile ) {
+    } else if( friendly != 0 && !docile &&
+               ( factions.size() > 1 || factions.count( planning_faction() ) == 0 ) ) {
         // Target unfriendly monsters, only if we aren't interacting with the player.
-        for( int i = 0, numz = g->num_zombies(); i < numz; i++ ) {
-            monster &tmp = g->zombie( i );
+        g->critter_tracker->for_each_in_radius( pos(), max_sight_range, [&]( monster & tmp ) {
             if( tmp.friendly == 0 ) {
                 float rating = rate_target( tmp, dist, smart_planning );
                 if( rating < dist ) {
@@ -228,7 +241,7 @@ void monster::plan( const mfactions &factions )
                     dist = rating;
                 }
             }
-        }
+        } );
     }
 
     if( docile ) {
@@ -263,43 +276,45 @@ void monster::plan( const mfactions &factions )
     }
 
     fleeing = fleeing || ( mood == MATT_FLEE );
+    // Only look for monsters of the factions we are hostile to, a horde of one faction
+    // doesn't look at itself at all.
+    std::vector<mfaction_id> hostile_factions;
     if( friendly == 0 ) {
-        for( const auto &fac : factions ) {
-            auto faction_att = faction.obj().attitude( fac.first );
-            if( faction_att == MFA_NEUTRAL || faction_att == MFA_FRIENDLY ) {
-                continue;
+        for( const mfaction_id &fac : factions ) {
+            const auto faction_att = faction.obj().attitude( fac );
+            if( faction_att != MFA_NEUTRAL && faction_att != MFA_FRIENDLY ) {
+                hostile_factions.push_back( fac );
+            }
+        }
+    }
+    if( !hostile_factions.empty() ) {
+        g->critter_tracker->for_each_in_radius( pos(), max_sight_range, [&]( monster & mon ) {
+            if( std::find( hostile_factions.begin(), hostile_factions.end(),
+                           mon.planning_faction() ) == hostile_factions.end() ) {
+                return;
             }
 
-            for( int i : fac.second ) { // mon indices
-                monster &mon = g->zombie( i );
-                float rating = rate_target( mon, dist, smart_planning );
-                if( rating < dist ) {
-                    target = &mon;
-                    dist = rating;
-                }
-                if( rating <= 5 ) {
-                    anger += angers_hostile_near;
-                    morale -= fears_hostile_near;
-                }
+            float rating = rate_target( mon, dist, smart_planning );
+            if( rating < dist ) {
+                target = &mon;
+                dist = rating;
             }
-        }
+            if( rating <= 5 ) {
+                anger += angers_hostile_near;
+                morale -= fears_hostile_near;
+            }
+        } );
     }
 
     // Friendly monsters here
     // Avoid for hordes of same-faction stuff or it could get expensive
-    const auto actual_faction = friendly == 0 ? faction : mfaction_str_id( "player" );
-    auto const &myfaction_iter = factions.find( actual_faction );
-    if( myfaction_iter == factions.end() ) {
-        DebugLog( D_ERROR, D_GAME ) << disp_name() << " tried to find faction "
-                                    << actual_faction.id().str()
-                                    << " which wasn't loaded in game::monmove";
-        swarms = false;
-        group_morale = false;
-    }
+    const mfaction_id actual_faction = planning_faction();
     swarms = swarms && target == nullptr; // Only swarm if we have no target
     if( group_morale || swarms ) {
-        for( const int i : myfaction_iter->second ) {
-            monster &mon = g->zombie( i );
+        g->critter_tracker->for_each_in_radius( pos(), max_sight_range, [&]( monster & mon ) {
+            if( mon.planning_faction() != actual_faction ) {
+                return;
+            }
             float rating = rate_target( mon, dist, smart_planning );
             if( group_morale && rating <= 10 ) {
                 morale += 10 - rating;
@@ -316,7 +331,7 @@ void monster::plan( const mfactions &factions )
                     dist = rating;
                 }
             }
-        }
+        } );
     }
 
     if( target != nullptr ) {
@@ -615,13 +630,17 @@ void monster::move()
 
     // Set attitude to attitude to our current target
     monster_attitude current_attitude = attitude( nullptr );
+    // Many monsters share these goals, so their paths come from a shared flow field
+    bool goal_is_creature = false;
     if( !wander() ) {
         if( goal == g->u.pos() ) {
             current_attitude = attitude( &( g->u ) );
+            goal_is_creature = true;
         } else {
             for( auto &i : g->active_npc ) {
                 if( goal == i->pos() ) {
                     current_attitude = attitude( i );
+                    goal_is_creature = true;
                 }
             }
         }
@@ -648,7 +667,12 @@ void monster::move()
         if( pf_settings.max_dist >= rl_dist( pos(), goal ) &&
             ( path.empty() || rl_dist( pos(), path.front() ) >= 2 || path.back() != goal ) ) {
             // We need a new path
-            path = g->m.route( pos(), goal, pf_settings, get_path_avoid() );
+            const auto &avoid = get_path_avoid();
+            if( goal_is_creature && avoid.empty() ) {
+                path = g->m.route_flow( pos(), goal, pf_settings );
+            } else {
+                path = g->m.route( pos(), goal, pf_settings, avoid );
+            }
         }
 
         // Try to respect old paths, even if we can't pathfind at the moment
@@ -835,11 +859,6 @@ void monster::footsteps( const tripoint &p )
 
 tripoint monster::scent_move()
 {
-    // @todo Remove when scentmap is 3D
-    if( abs( posz() - g->get_levz() ) > 1 ) {
-        return { -1, -1, INT_MIN };
-    }
-
     std::vector<tripoint> smoves;
 
     int bestsmell = 10; // Squares with smell 0 are not eligible targets.
@@ -4,6 +4,7 @@
 #include "creature.h"
 #include "enums.h"
 #include "int_id.h"
+#include <set>
 #include <vector>
 
 class map;
@@ -19,7 +20,8 @@ enum field_id : int;
 using mfaction_id = int_id<monfaction>;
 using mtype_id = string_id<mtype>;
 
-typedef std::map< mfaction_id, std::set< int > > mfactions;
+/** The factions that monsters plan for, see @ref monster::planning_faction */
+typedef std::set< mfaction_id > mfactions;
 
 class mon_special_attack : public JsonSerializer
 {
@@ -159,6 +161,8 @@ class monster : public Creature, public JsonSerializer, public JsonDeserializer
         // Pass all factions to mon, so that hordes of same-faction mons
         // do not iterate over each other
         void plan( const mfactions &factions );
+        /** The faction this monster acts for: its own, or the player's if it is friendly */
+        mfaction_id planning_faction() const;
         void move(); // Actual movement
         void footsteps( const tripoint &p ); // noise made by movement
 
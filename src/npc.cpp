@@ -99,6 +99,8 @@ npc::npc()
     last_updated = calendar::turn;
 
     path_settings = pathfinding_settings( 0, 1000, 1000, true, true, true );
+    // assess_danger and choose_target look at every monster each turn
+    set_vision_field( true );
 }
 
 standard_npc::standard_npc( const std::string &name, const std::vector<itype_id> &clothing,
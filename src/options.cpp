@@ -1298,6 +1298,13 @@ void options_manager::init()
         "no,yes,query", "no"
         );
 
+    optionNames["json"] = _("JSON");
+    optionNames["binary"] = _("Binary");
+    add("MAP_FORMAT", "world_default", _("Map file format"),
+        _("Format of the saved map files. Binary files are smaller and faster to load, JSON files can be read and edited by hand. Files in the other format are still read and get converted when they are saved again."),
+        "json,binary", "json"
+        );
+
     mOptionsSort["world_default"]++;
 
     add("CITY_SIZE", "world_default", _("Size of cities"),
@@ -32,6 +32,7 @@
 #include "mapbuffer.h"
 #include "map_iterator.h"
 #include "messages.h"
+#include "save_writer.h"
 
 #include <cassert>
 #include <stdlib.h>
@@ -1137,18 +1138,76 @@ void overmap_special::check() const
     }
 }
 
-// *** BEGIN overmap FUNCTIONS ***
+overmap_neighbors::overmap_neighbors( const overmap *north, const overmap *east,
+                                      const overmap *south, const overmap *west )
+{
+    // The row or column of each neighbor that touches the new overmap
+    if( north != nullptr ) {
+        border &b = borders[static_cast<int>( om_direction::type::north )];
+        for( int i = 0; i < OMAPX; i++ ) {
+            b.terrain.push_back( north->get_ter( i, OMAPY - 1, 0 ) );
+        }
+        for( const city &road : north->roads_out ) {
+            if( road.y == OMAPY - 1 ) {
+                b.roads.push_back( road.x );
+            }
+        }
+    }
+    if( east != nullptr ) {
+        border &b = borders[static_cast<int>( om_direction::type::east )];
+        for( int i = 0; i < OMAPY; i++ ) {
+            b.terrain.push_back( east->get_ter( 0, i, 0 ) );
+        }
+        for( const city &road : east->roads_out ) {
+            if( road.x == 0 ) {
+                b.roads.push_back( road.y );
+            }
+        }
+    }
+    if( south != nullptr ) {
+        border &b = borders[static_cast<int>( om_direction::type::south )];
+        for( int i = 0; i < OMAPX; i++ ) {
+            b.terrain.push_back( south->get_ter( i, 0, 0 ) );
+        }
+        for( const city &road : south->roads_out ) {
+            if( road.y == 0 ) {
+                b.roads.push_back( road.x );
+            }
+        }
+    }
+    if( west != nullptr ) {
+        border &b = borders[static_cast<int>( om_direction::type::west )];
+        for( int i = 0; i < OMAPY; i++ ) {
+            b.terrain.push_back( west->get_ter( OMAPX - 1, i, 0 ) );
+        }
+        for( const city &road : west->roads_out ) {
+            if( road.x == OMAPX - 1 ) {
+                b.roads.push_back( road.y );
+            }
+        }
+    }
+}
 
-overmap::overmap( int const x, int const y ) : loc( x, y )
+bool overmap_neighbors::has( const om_direction::type dir ) const
 {
-    const std::string rsettings_id = get_world_option<std::string>( "DEFAULT_REGION" );
-    t_regional_settings_map_citr rsit = region_settings_map.find( rsettings_id );
+    return !borders[static_cast<int>( dir )].terrain.empty();
+}
 
-    if ( rsit == region_settings_map.end() ) {
-        debugmsg("overmap(%d,%d): can't find region '%s'", x, y, rsettings_id.c_str() ); // gonna die now =[
-    }
-    settings = rsit->second;
+oter_id overmap_neighbors::ter( const om_direction::type dir, const int i ) const
+{
+    return borders[static_cast<int>( dir )].terrain[i];
+}
 
+const std::vector<int> &overmap_neighbors::roads( const om_direction::type dir ) const
+{
+    return borders[static_cast<int>( dir )].roads;
+}
+
+// *** BEGIN overmap FUNCTIONS ***
+
+overmap::overmap( int const x, int const y ) : loc( x, y )
+{
+    init_settings();
     init_layers();
     try {
         open();
@@ -1157,6 +1216,14 @@ overmap::overmap( int const x, int const y ) : loc( x, y )
     }
 }
 
+overmap::overmap( int const x, int const y, const overmap_neighbors &neighbors,
+                  unsigned const world_seed ) : loc( x, y )
+{
+    init_settings();
+    init_layers();
+    generate( neighbors, world_seed );
+}
+
 overmap::overmap()
 {
     t_regional_settings_map_citr rsit = region_settings_map.find( "default" );
@@ -1172,6 +1239,17 @@ overmap::~overmap()
 {
 }
 
+void overmap::init_settings()
+{
+    const std::string rsettings_id = get_world_option<std::string>( "DEFAULT_REGION" );
+    t_regional_settings_map_citr rsit = region_settings_map.find( rsettings_id );
+
+    if ( rsit == region_settings_map.end() ) {
+        debugmsg("overmap(%d,%d): can't find region '%s'", loc.x, loc.y, rsettings_id.c_str() ); // gonna die now =[
+    }
+    settings = rsit->second;
+}
+
 void overmap::init_layers()
 {
     for(int z = 0; z < OVERMAP_LAYERS; ++z) {
@@ -1428,10 +1506,15 @@ void overmap::set_scent( const tripoint &loc, scent_trace &new_scent )
     scents[loc] = new_scent;
 }
 
-void overmap::generate(const overmap *north, const overmap *east,
-                       const overmap *south, const overmap *west)
+void overmap::generate( const overmap_neighbors &neighbors, unsigned const world_seed )
 {
-    dbg(D_INFO) << "overmap::generate start...";
+    // Mix the position into the seed, so the overmaps of a world differ.
+    scoped_rng_seed seed( world_seed ^ ( loc.x * 73856093u ) ^ ( loc.y * 19349663u ) );
+    const om_direction::type north = om_direction::type::north;
+    const om_direction::type east = om_direction::type::east;
+    const om_direction::type south = om_direction::type::south;
+    const om_direction::type west = om_direction::type::west;
+
     std::vector<city> road_points; // cities and roads_out together
     std::vector<point> river_start;// West/North endpoints of rivers
     std::vector<point> river_end; // East/South endpoints of rivers
@@ -1439,117 +1522,109 @@ void overmap::generate(const overmap *north, const overmap *east,
     // Determine points where rivers & roads should connect w/ adjacent maps
     const oter_id river_center("river_center"); // optimized comparison.
 
-    if (north != NULL) {
+    if (neighbors.has( north )) {
         for (int i = 2; i < OMAPX - 2; i++) {
-            if (is_river(north->get_ter(i, OMAPY - 1, 0))) {
+            if (is_river(neighbors.ter( north, i ))) {
                 ter(i, 0, 0) = river_center;
             }
-            if (is_river(north->get_ter(i, OMAPY - 1, 0)) &&
-                is_river(north->get_ter(i - 1, OMAPY - 1, 0)) &&
-                is_river(north->get_ter(i + 1, OMAPY - 1, 0))) {
+            if (is_river(neighbors.ter( north, i )) &&
+                is_river(neighbors.ter( north, i - 1 )) &&
+                is_river(neighbors.ter( north, i + 1 ))) {
                 if (river_start.empty() ||
                     river_start[river_start.size() - 1].x < i - 6) {
                     river_start.push_back(point(i, 0));
                 }
             }
         }
-        for (auto &i : north->roads_out) {
-            if (i.y == OMAPY - 1) {
-                roads_out.push_back(city(i.x, 0, 0));
-            }
+        for( int x : neighbors.roads( north ) ) {
+            roads_out.push_back( city( x, 0, 0 ) );
         }
     }
     size_t rivers_from_north = river_start.size();
-    if (west != NULL) {
+    if (neighbors.has( west )) {
         for (int i = 2; i < OMAPY - 2; i++) {
-            if (is_river(west->get_ter(OMAPX - 1, i, 0))) {
+            if (is_river(neighbors.ter( west, i ))) {
                 ter(0, i, 0) = river_center;
             }
-            if (is_river(west->get_ter(OMAPX - 1, i, 0)) &&
-                is_river(west->get_ter(OMAPX - 1, i - 1, 0)) &&
-                is_river(west->get_ter(OMAPX - 1, i + 1, 0))) {
+            if (is_river(neighbors.ter( west, i )) &&
+                is_river(neighbors.ter( west, i - 1 )) &&
+                is_river(neighbors.ter( west, i + 1 ))) {
                 if (river_start.size() == rivers_from_north ||
                     river_start[river_start.size() - 1].y < i - 6) {
                     river_start.push_back(point(0, i));
                 }
             }
         }
-        for (auto &i : west->roads_out) {
-            if (i.x == OMAPX - 1) {
-                roads_out.push_back(city(0, i.y, 0));
-            }
+        for( int y : neighbors.roads( west ) ) {
+            roads_out.push_back( city( 0, y, 0 ) );
         }
     }
-    if (south != NULL) {
+    if (neighbors.has( south )) {
         for (int i = 2; i < OMAPX - 2; i++) {
-            if (is_river(south->get_ter(i, 0, 0))) {
+            if (is_river(neighbors.ter( south, i ))) {
                 ter(i, OMAPY - 1, 0) = river_center;
             }
-            if (is_river(south->get_ter(i,     0, 0)) &&
-                is_river(south->get_ter(i - 1, 0, 0)) &&
-                is_river(south->get_ter(i + 1, 0, 0))) {
+            if (is_river(neighbors.ter( south, i )) &&
+                is_river(neighbors.ter( south, i - 1 )) &&
+                is_river(neighbors.ter( south, i + 1 ))) {
                 if (river_end.empty() ||
                     river_end[river_end.size() - 1].x < i - 6) {
                     river_end.push_back(point(i, OMAPY - 1));
                 }
             }
-            if (south->get_ter(i, 0, 0) == "road_nesw") {
+            if (neighbors.ter( south, i ) == "road_nesw") {
                 roads_out.push_back(city(i, OMAPY - 1, 0));
             }
         }
-        for (auto &i : south->roads_out) {
-            if (i.y == 0) {
-                roads_out.push_back(city(i.x, OMAPY - 1, 0));
-            }
+        for( int x : neighbors.roads( south ) ) {
+            roads_out.push_back( city( x, OMAPY - 1, 0 ) );
         }
     }
     size_t rivers_to_south = river_end.size();
-    if (east != NULL) {
+    if (neighbors.has( east )) {
         for (int i = 2; i < OMAPY - 2; i++) {
-            if (is_river(east->get_ter(0, i, 0))) {
+            if (is_river(neighbors.ter( east, i ))) {
                 ter(OMAPX - 1, i, 0) = river_center;
             }
-            if (is_river(east->get_ter(0, i, 0)) &&
-                is_river(east->get_ter(0, i - 1, 0)) &&
-                is_river(east->get_ter(0, i + 1, 0))) {
+            if (is_river(neighbors.ter( east, i )) &&
+                is_river(neighbors.ter( east, i - 1 )) &&
+                is_river(neighbors.ter( east, i + 1 ))) {
                 if (river_end.size() == rivers_to_south ||
                     river_end[river_end.size() - 1].y < i - 6) {
                     river_end.push_back(point(OMAPX - 1, i));
                 }
             }
-            if (east->get_ter(0, i, 0) == "road_nesw") {
+            if (neighbors.ter( east, i ) == "road_nesw") {
                 roads_out.push_back(city(OMAPX - 1, i, 0));
             }
         }
-        for (auto &i : east->roads_out) {
-            if (i.x == 0) {
-                roads_out.push_back(city(OMAPX - 1, i.y, 0));
-            }
+        for( int y : neighbors.roads( east ) ) {
+            roads_out.push_back( city( OMAPX - 1, y, 0 ) );
         }
     }
 
     // Even up the start and end points of rivers. (difference of 1 is acceptable)
     // Also ensure there's at least one of each.
     std::vector<point> new_rivers;
-    if (north == NULL || west == NULL) {
+    if (!neighbors.has( north ) || !neighbors.has( west )) {
         while (river_start.empty() || river_start.size() + 1 < river_end.size()) {
             new_rivers.clear();
-            if (north == NULL) {
+            if (!neighbors.has( north )) {
                 new_rivers.push_back( point(rng(10, OMAPX - 11), 0) );
             }
-            if (west == NULL) {
+            if (!neighbors.has( west )) {
                 new_rivers.push_back( point(0, rng(10, OMAPY - 11)) );
             }
             river_start.push_back( random_entry( new_rivers ) );
         }
     }
-    if (south == NULL || east == NULL) {
+    if (!neighbors.has( south ) || !neighbors.has( east )) {
         while (river_end.empty() || river_end.size() + 1 < river_start.size()) {
             new_rivers.clear();
-            if (south == NULL) {
+            if (!neighbors.has( south )) {
                 new_rivers.push_back( point(rng(10, OMAPX - 11), OMAPY - 1) );
             }
-            if (east == NULL) {
+            if (!neighbors.has( east )) {
                 new_rivers.push_back( point(OMAPX - 1, rng(10, OMAPY - 11)) );
             }
             river_end.push_back( random_entry( new_rivers ) );
@@ -1600,28 +1675,28 @@ void overmap::generate(const overmap *north, const overmap *east,
         // Populate viable_roads with one point for each neighborless side.
         // Make sure these points don't conflict with rivers.
         // TODO: In theory this is a potential infinte loop...
-        if (north == NULL) {
+        if (!neighbors.has( north )) {
             do {
                 tmp = rng(10, OMAPX - 11);
             } while (is_river(ter(tmp, 0, 0)) || is_river(ter(tmp - 1, 0, 0)) ||
                      is_river(ter(tmp + 1, 0, 0)) );
             viable_roads.push_back(city(tmp, 0, 0));
         }
-        if (east == NULL) {
+        if (!neighbors.has( east )) {
             do {
                 tmp = rng(10, OMAPY - 11);
             } while (is_river(ter(OMAPX - 1, tmp, 0)) || is_river(ter(OMAPX - 1, tmp - 1, 0)) ||
                      is_river(ter(OMAPX - 1, tmp + 1, 0)));
             viable_roads.push_back(city(OMAPX - 1, tmp, 0));
         }
-        if (south == NULL) {
+        if (!neighbors.has( south )) {
             do {
                 tmp = rng(10, OMAPX - 11);
             } while (is_river(ter(tmp, OMAPY - 1, 0)) || is_river(ter(tmp - 1, OMAPY - 1, 0)) ||
                      is_river(ter(tmp + 1, OMAPY - 1, 0)));
             viable_roads.push_back(city(tmp, OMAPY - 1, 0));
         }
-        if (west == NULL) {
+        if (!neighbors.has( west )) {
             do {
                 tmp = rng(10, OMAPY - 11);
             } while (is_river(ter(0, tmp, 0)) || is_river(ter(0, tmp - 1, 0)) ||
@@ -1659,7 +1734,6 @@ void overmap::generate(const overmap *north, const overmap *east,
     // Place the monsters, now that the terrain is laid out
     place_mongroups();
     place_radios();
-    dbg(D_INFO) << "overmap::generate done";
 }
 
 
@@ -4066,7 +4140,7 @@ om_direction::type overmap::random_special_rotation( const overmap_special &spec
         }
     }
     // Pick first valid rotation at random.
-    std::random_shuffle( first, last );
+    rng_shuffle( first, last );
     const auto rotation = find_if( first, last, [&]( om_direction::type r ) {
         for( const auto &elem : special.terrains ) {
             const tripoint rp = p + om_direction::rotate( elem.p, r );
@@ -4144,7 +4218,7 @@ std::vector<point> overmap::get_sectors() const
             res.emplace_back( x, y );
         }
     }
-    std::random_shuffle( res.begin(), res.end() );
+    rng_shuffle( res.begin(), res.end() );
     return res;
 }
 
@@ -4176,7 +4250,7 @@ void overmap::place_specials()
         }
 
         if( elem->flags.count( "UNIQUE" ) > 0 ) {
-            if( rand() % max <= min ) {
+            if( rng( 0, max - 1 ) <= min ) {
                 mandatory.emplace_back( elem, 1 );
             }
         } else {
@@ -4195,8 +4269,8 @@ void overmap::place_specials()
         return; // Nothing to do.
     }
     // Make random permutations.
-    std::random_shuffle( mandatory.begin(), mandatory.end() );
-    std::random_shuffle( optional.begin(), optional.end() );
+    rng_shuffle( mandatory.begin(), mandatory.end() );
+    rng_shuffle( optional.begin(), optional.end() );
     // Walk over sectors.
     for( const point &sector : get_sectors() ) {
         const int x = sector.x;
@@ -4233,7 +4307,7 @@ void overmap::place_specials()
                     iter = candidates.erase( iter );
                 }
                 // Refresh the permutation.
-                std::random_shuffle( optional.begin(), optional.end() );
+                rng_shuffle( optional.begin(), optional.end() );
                 i = attempts; // This takes us out of the outer cycle. I'm really tempted to write 'goto' here :P.
                 break;
             }
@@ -4368,17 +4442,9 @@ void overmap::open()
     if( read_from_file_optional( terfilename, std::bind( &overmap::unserialize, this, _1 ) ) ) {
         read_from_file_optional( plrfilename, std::bind( &overmap::unserialize_view, this, _1 ) );
     } else { // No map exists!  Prepare neighbors, and generate one.
-        std::vector<const overmap*> pointers;
-        // Fetch south and north
-        for (int i = -1; i <= 1; i += 2) {
-            pointers.push_back(overmap_buffer.get_existing(loc.x, loc.y+i));
-        }
-        // Fetch east and west
-        for (int i = -1; i <= 1; i += 2) {
-            pointers.push_back(overmap_buffer.get_existing(loc.x+i, loc.y));
-        }
-        // pointers looks like (north, south, west, east)
-        generate(pointers[0], pointers[3], pointers[1], pointers[2]);
+        dbg(D_INFO) << "overmap::generate start...";
+        generate( overmap_buffer.get_neighbors( loc.x, loc.y ), g->get_seed() );
+        dbg(D_INFO) << "overmap::generate done";
     }
 }
 
@@ -4388,13 +4454,14 @@ void overmap::save() const
     std::string const plrfilename = overmapbuffer::player_filename(loc.x, loc.y);
     std::string const terfilename = overmapbuffer::terrain_filename(loc.x, loc.y);
 
-    ofstream_wrapper fout_player( plrfilename );
-    serialize_view( fout_player );
-    fout_player.close();
+    // Only serialize here, the files are written in the background
+    std::ostringstream player_buffer;
+    serialize_view( player_buffer );
+    save_writer::get().write( plrfilename, player_buffer.str(), false, _( "overmap view" ) );
 
-    ofstream_wrapper_exclusive fout_terrain( terfilename );
-    serialize( fout_terrain );
-    fout_terrain.close();
+    std::ostringstream terrain_buffer;
+    serialize( terrain_buffer );
+    save_writer::get().write( terfilename, terrain_buffer.str(), true, _( "overmap" ) );
 }
 
 
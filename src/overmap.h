@@ -7,6 +7,7 @@
 #include "weighted_list.h"
 #include "game_constants.h"
 #include "monster.h"
+#include "rng.h"
 #include "weather_gen.h"
 
 #include <array>
@@ -21,6 +22,7 @@
 class input_context;
 class JsonObject;
 class npc;
+class overmap;
 class overmapbuffer;
 
 struct mongroup;
@@ -151,7 +153,7 @@ struct radio_tower {
  int frequency;
 radio_tower(int X = -1, int Y = -1, int S = -1, std::string M = "",
             radio_type T = MESSAGE_BROADCAST) :
-    x (X), y (Y), strength (S), type (T), message (M) {frequency = rand();}
+    x (X), y (Y), strength (S), type (T), message (M) {frequency = rng( 0, RAND_MAX );}
 };
 
 struct map_layer {
@@ -161,12 +163,50 @@ struct map_layer {
     std::vector<om_note> notes;
 };
 
+/**
+ * What generating an overmap takes from the existing overmaps next to it: their ground
+ * level terrain along the shared border and the places where their roads cross it, so
+ * rivers and roads continue into the new overmap. This is a copy, so the new overmap
+ * can be generated on another thread while the game goes on with the neighbors.
+ */
+class overmap_neighbors
+{
+    public:
+        /** No neighbors at all */
+        overmap_neighbors() = default;
+        /** The overmaps next to the new one, nullptr where there is none. */
+        overmap_neighbors( const overmap *north, const overmap *east, const overmap *south,
+                           const overmap *west );
+
+        /** Whether there is a neighbor in that direction. */
+        bool has( om_direction::type dir ) const;
+        /** Terrain of the neighbor in that direction at position i along the shared border. */
+        oter_id ter( om_direction::type dir, int i ) const;
+        /** The positions along the shared border where roads of that neighbor cross it. */
+        const std::vector<int> &roads( om_direction::type dir ) const;
+
+    private:
+        struct border {
+            /** Empty if there is no neighbor */
+            std::vector<oter_id> terrain;
+            std::vector<int> roads;
+        };
+        std::array<border, om_direction::size> borders;
+};
+
 class overmap
 {
  public:
     overmap(const overmap&) = default;
     overmap(overmap &&) = default;
     overmap(int x, int y);
+    /**
+     * Generates a new overmap at x,y without loading anything or touching the overmap
+     * buffer and the game, so it can run on a background thread. The random numbers come
+     * from a seed based on world_seed and the position, so the same neighbors give the
+     * same overmap.
+     */
+    overmap( int x, int y, const overmap_neighbors &neighbors, unsigned world_seed );
     // Argument-less constructor bypasses trying to load matching file, only used for unit testing.
     overmap();
     ~overmap();
@@ -314,6 +354,7 @@ public:
     regional_settings settings;
 
   // Initialise
+  void init_settings();
   void init_layers();
   // open existing overmap, or generate a new one
   void open();
@@ -330,7 +371,7 @@ public:
   void unserialize_legacy(std::istream &fin);
   void unserialize_view_legacy(std::istream &fin);
  private:
-  void generate(const overmap* north, const overmap* east, const overmap* south, const overmap* west);
+  void generate( const overmap_neighbors &neighbors, unsigned world_seed );
   bool generate_sub(int const z);
 
     const city &get_nearest_city( const tripoint &p ) const;
@@ -16,17 +16,48 @@
 #include "cata_utility.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <sstream>
 #include <stdlib.h>
 
+#if (defined _WIN32 || defined WINDOWS) && !defined _MSC_VER && !defined _GLIBCXX_HAS_GTHREADS
+// MinGW without a thread model has no futures, see thread_pool.cpp.
+// Overmaps are only generated when they are needed there.
+#define CATA_NO_OVERMAP_THREAD
+#endif
+
+#ifndef CATA_NO_OVERMAP_THREAD
+#include <chrono>
+#include <future>
+#include <system_error>
+#endif
+
 overmapbuffer overmap_buffer;
 
+struct overmapbuffer::background_overmap {
+    point pos;
+    /** The neighbors it was generated next to */
+    overmap_neighbors neighbors;
+#ifndef CATA_NO_OVERMAP_THREAD
+    std::future<std::unique_ptr<overmap>> result;
+#endif
+};
+
+// Offsets of the neighbors of an overmap, in the order of om_direction::all
+static const std::array<point, om_direction::size> neighbor_offsets = {{
+        point( 0, -1 ), point( 1, 0 ), point( 0, 1 ), point( -1, 0 )
+    }
+};
+
 overmapbuffer::overmapbuffer()
 : last_requested_overmap( nullptr )
 {
 }
 
+// Waits for the background generation, if it's still running.
+overmapbuffer::~overmapbuffer() = default;
+
 std::string overmapbuffer::terrain_filename(int const x, int const y)
 {
     std::ostringstream filename;
@@ -60,6 +91,12 @@ overmap &overmapbuffer::get( const int x, const int y )
         return *(last_requested_overmap = it->second.get());
     }
 
+    // The overmap generated in the background might be this one or one of its neighbors.
+    if( background ) {
+        finish_background( true );
+        return get( x, y );
+    }
+
     // That constructor loads an existing overmap or creates a new one.
     std::unique_ptr<overmap> new_om( new overmap( x, y ) );
     overmap &result = *new_om;
@@ -114,6 +151,8 @@ void overmapbuffer::save()
 
 void overmapbuffer::clear()
 {
+    // Waits for it to finish, it belongs to the old world.
+    background.reset();
     overmaps.clear();
     known_non_existing.clear();
     last_requested_overmap = NULL;
@@ -171,6 +210,109 @@ overmap *overmapbuffer::get_existing(int x, int y)
     return NULL;
 }
 
+overmap_neighbors overmapbuffer::get_neighbors( const int x, const int y )
+{
+    std::array<const overmap *, om_direction::size> neighbors;
+    for( size_t i = 0; i < om_direction::size; i++ ) {
+        neighbors[i] = get_existing( x + neighbor_offsets[i].x, y + neighbor_offsets[i].y );
+    }
+    return overmap_neighbors( neighbors[0], neighbors[1], neighbors[2], neighbors[3] );
+}
+
+void overmapbuffer::generate_ahead( const tripoint &omt_pos )
+{
+    finish_background( false );
+
+    // How close to the border the player has to be, in overmap terrains. Generating an
+    // overmap takes a while, it should be done before the player can see into it.
+    static const int margin = OMAPX / 3;
+    int x = omt_pos.x;
+    int y = omt_pos.y;
+    const point om_pos = omt_to_om_remain( x, y );
+    const int dx = x < margin ? -1 : ( x >= OMAPX - margin ? 1 : 0 );
+    const int dy = y < margin ? -1 : ( y >= OMAPY - margin ? 1 : 0 );
+    // The overmaps across the borders first, the one at the corner last.
+    const std::array<point, 3> ahead = {{ point( dx, 0 ), point( 0, dy ), point( dx, dy ) }};
+    for( const point &d : ahead ) {
+        if( ( d.x != 0 || d.y != 0 ) && generate_in_background( om_pos.x + d.x, om_pos.y + d.y ) ) {
+            return;
+        }
+    }
+}
+
+bool overmapbuffer::generate_in_background( const int x, const int y )
+{
+#ifdef CATA_NO_OVERMAP_THREAD
+    ( void )x;
+    ( void )y;
+    return false;
+#else
+    const point p( x, y );
+    if( background || overmaps.count( p ) > 0 || file_exist( terrain_filename( x, y ) ) ) {
+        return false;
+    }
+    std::unique_ptr<background_overmap> job( new background_overmap() );
+    job->pos = p;
+    job->neighbors = get_neighbors( x, y );
+    // Loading the neighbors may have moved monster groups into it (see fix_mongroups).
+    if( overmaps.count( p ) > 0 ) {
+        return false;
+    }
+
+    const overmap_neighbors neighbors = job->neighbors;
+    const unsigned seed = g->get_seed();
+    try {
+        job->result = std::async( std::launch::async, [x, y, neighbors, seed]() {
+            return std::unique_ptr<overmap>( new overmap( x, y, neighbors, seed ) );
+        } );
+    } catch( const std::system_error &err ) {
+        // No thread available, get() will generate it when needed.
+        DebugLog( D_WARNING, D_GAME ) << "can't generate overmap in the background: " << err.what();
+        return false;
+    }
+    background = std::move( job );
+    return true;
+#endif
+}
+
+void overmapbuffer::finish_background( const bool wait )
+{
+#ifndef CATA_NO_OVERMAP_THREAD
+    if( !background ) {
+        return;
+    }
+    if( !wait && background->result.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready ) {
+        return;
+    }
+    const std::unique_ptr<background_overmap> done = std::move( background );
+    std::unique_ptr<overmap> new_om;
+    try {
+        new_om = done->result.get();
+    } catch( const std::exception &err ) {
+        debugmsg( "overmap (%d,%d) failed to generate: %s", done->pos.x, done->pos.y, err.what() );
+        return;
+    }
+
+    if( overmaps.count( done->pos ) > 0 ) {
+        return;
+    }
+    for( size_t i = 0; i < om_direction::size; i++ ) {
+        const point neighbor = done->pos + neighbor_offsets[i];
+        if( done->neighbors.has( om_direction::all[i] ) != ( overmaps.count( neighbor ) > 0 ) ) {
+            // get() generates it again, next to the current neighbors.
+            return;
+        }
+    }
+
+    overmap &result = *new_om;
+    overmaps[ done->pos ] = std::move( new_om );
+    known_non_existing.erase( done->pos );
+    fix_mongroups( result );
+#else
+    ( void )wait;
+#endif
+}
+
 bool overmapbuffer::has( int x, int y )
 {
     return get_existing( x, y ) != NULL;
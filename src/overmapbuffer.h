@@ -20,6 +20,7 @@ struct oter_t;
 using oter_id = int_id<oter_t>;
 
 class overmap;
+class overmap_neighbors;
 struct radio_tower;
 struct regional_settings;
 class vehicle;
@@ -56,6 +57,7 @@ class overmapbuffer
 {
 public:
     overmapbuffer();
+    ~overmapbuffer();
 
     static std::string terrain_filename(int const x, int const y);
     static std::string player_filename(int const x, int const y);
@@ -261,6 +263,25 @@ public:
      * (x,y) are global overmap coordinates (same as @ref get).
      */
     overmap *get_existing( int x, int y );
+    /**
+     * Copies what generating a new overmap at x,y takes from its neighbors (see
+     * @ref overmap_neighbors). Neighbors that exist on disk are loaded.
+     */
+    overmap_neighbors get_neighbors( int x, int y );
+    /**
+     * Starts generating the overmaps next to the one that contains the given position
+     * (in overmap terrain coordinates) on a background thread, if the position is close
+     * to their border and they don't exist yet. Adds the ones that are done.
+     * Called when the player moves, so crossing into a new overmap doesn't wait for it.
+     */
+    void generate_ahead( const tripoint &omt_pos );
+    /**
+     * Starts generating the overmap at x,y on a background thread, unless it exists
+     * already or another one is being generated. @ref get picks it up from there.
+     * The result is the same as if @ref get generated it, see @ref overmap::overmap.
+     * @return Whether generating was started.
+     */
+    bool generate_in_background( int x, int y );
 
     typedef std::pair<point, std::string> t_point_with_note;
     typedef std::vector<t_point_with_note> t_notes_vector;
@@ -333,6 +354,16 @@ private:
     // Cached result of previous call to overmapbuffer::get_existing
     overmap mutable *last_requested_overmap;
 
+    struct background_overmap;
+    /** The overmap being generated on a background thread, if any */
+    std::unique_ptr<background_overmap> background;
+    /**
+     * Adds the overmap generated in the background, unless overmaps next to it were created
+     * in the meantime, which its borders would not match.
+     * @param wait Whether to wait for it, otherwise nothing happens if it's not done yet.
+     */
+    void finish_background( bool wait );
+
     /**
      * Get a list of notes in the (loaded) overmaps.
      * @param z only this specific z-level is search for notes.
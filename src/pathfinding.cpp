@@ -1,3 +1,4 @@
+#include "calendar.h"
 #include "coordinates.h"
 #include "debug.h"
 #include "enums.h"
@@ -14,6 +15,7 @@
 #include "pathfinding.h"
 
 #include <algorithm>
+#include <climits>
 #include <queue>
 #include <set>
 
@@ -32,82 +34,139 @@ constexpr int flat_index( const int x, const int y )
 };
 
 // Flattened 2D array representing a single z-level worth of pathfinding data
+// Entries are only valid if their generation matches the one of the current search,
+// so the layer never needs to be cleared between searches.
 struct path_data_layer {
     // State is accessed way more often than all other values here
     std::array< astar_state, SEEX *MAPSIZE *SEEY *MAPSIZE > state;
+    std::array< unsigned int, SEEX *MAPSIZE *SEEY *MAPSIZE > generation;
     std::array< int, SEEX *MAPSIZE *SEEY *MAPSIZE > score;
     std::array< int, SEEX *MAPSIZE *SEEY *MAPSIZE > gscore;
     std::array< tripoint, SEEX *MAPSIZE *SEEY *MAPSIZE > parent;
+};
+
+// Priority queue keyed by A* score. Scores are small non-negative integers, so
+// an array of buckets is much cheaper than a binary heap of (score, point) pairs.
+// Scores are not guaranteed to be monotonic (stairs and ledges), so pushing below
+// the current minimum is allowed.
+class pathfinding_queue
+{
+    private:
+        std::vector< std::vector<tripoint> > buckets;
+        size_t current = 0;
+        size_t count = 0;
+
+    public:
+        bool empty() const {
+            return count == 0;
+        }
 
-    void init( const int minx, const int miny, const int maxx, const int maxy ) {
-        for( int x = minx; x <= maxx; x++ ) {
-            for( int y = miny; y <= maxy; y++ ) {
-                const int ind = flat_index( x, y );
-                state[ind] = ASL_NONE; // Mark as unvisited
+        void clear() {
+            for( size_t i = current; i < buckets.size() && count > 0; i++ ) {
+                count -= buckets[i].size();
+                buckets[i].clear();
             }
+            current = 0;
+            count = 0;
+        }
+
+        void push( const int score, const tripoint &p ) {
+            const size_t index = std::max( score, 0 );
+            if( index >= buckets.size() ) {
+                buckets.resize( std::max( index + 1, buckets.size() * 2 ) );
+            }
+            buckets[index].push_back( p );
+            current = std::min( current, index );
+            count++;
+        }
+
+        tripoint pop() {
+            while( buckets[current].empty() ) {
+                current++;
+            }
+            const tripoint p = buckets[current].back();
+            buckets[current].pop_back();
+            count--;
+            return p;
         }
-    };
 };
 
+// Reused by all searches of a thread, so that neither the layers nor the queue are
+// allocated or cleared for every call to map::route.
 struct pathfinder {
-    int minx;
-    int miny;
-    int maxx;
-    int maxy;
-    pathfinder( int _minx, int _miny, int _maxx, int _maxy ) :
-        minx( _minx ), miny( _miny ), maxx( _maxx ), maxy( _maxy ) {
-    }
+    int minx = 0;
+    int miny = 0;
+    int maxx = 0;
+    int maxy = 0;
+    unsigned int generation = 0;
 
-    std::priority_queue< std::pair<int, tripoint>, std::vector< std::pair<int, tripoint> >, pair_greater_cmp >
-    open;
+    pathfinding_queue open;
     std::array< std::unique_ptr< path_data_layer >, OVERMAP_LAYERS > path_data;
 
+    void reset( const int _minx, const int _miny, const int _maxx, const int _maxy ) {
+        minx = _minx;
+        miny = _miny;
+        maxx = _maxx;
+        maxy = _maxy;
+        open.clear();
+        generation++;
+        if( generation == 0 ) {
+            // Wrapped around, old entries could be mistaken for current ones
+            for( auto &ptr : path_data ) {
+                if( ptr != nullptr ) {
+                    ptr->generation.fill( 0 );
+                }
+            }
+            generation = 1;
+        }
+    }
+
     path_data_layer &get_layer( const int z ) {
         auto &ptr = path_data[z + OVERMAP_DEPTH];
-        if( ptr != nullptr ) {
-            return *ptr;
+        if( ptr == nullptr ) {
+            ptr = std::unique_ptr<path_data_layer>( new path_data_layer() );
         }
-
-        ptr = std::unique_ptr<path_data_layer>( new path_data_layer() );
-        ptr->init( minx, miny, maxx, maxy );
         return *ptr;
     }
 
+    astar_state get_state( const path_data_layer &layer, const int index ) const {
+        return layer.generation[index] == generation ? layer.state[index] : ASL_NONE;
+    }
+
+    void set_state( path_data_layer &layer, const int index, const astar_state state ) {
+        layer.generation[index] = generation;
+        layer.state[index] = state;
+    }
+
     bool empty() const {
         return open.empty();
     }
 
     tripoint get_next() {
-        auto pt = open.top();
-        open.pop();
-        return pt.second;
+        return open.pop();
     }
 
     void add_point( const int gscore, const int score, const tripoint &from, const tripoint &to ) {
         auto &layer = get_layer( to.z );
         const int index = flat_index( to.x, to.y );
-        if( ( layer.state[index] == ASL_OPEN && gscore >= layer.gscore[index] ) ||
-            layer.state[index] == ASL_CLOSED ) {
+        const astar_state state = get_state( layer, index );
+        if( ( state == ASL_OPEN && gscore >= layer.gscore[index] ) || state == ASL_CLOSED ) {
             return;
         }
 
-        layer.state [index] = ASL_OPEN;
+        set_state( layer, index, ASL_OPEN );
         layer.gscore[index] = gscore;
         layer.parent[index] = from;
         layer.score [index] = score;
-        open.push( std::make_pair( score, to ) );
+        open.push( score, to );
     }
 
     void close_point( const tripoint &p ) {
-        auto &layer = get_layer( p.z );
-        const int index = flat_index( p.x, p.y );
-        layer.state[index] = ASL_CLOSED;
+        set_state( get_layer( p.z ), flat_index( p.x, p.y ), ASL_CLOSED );
     }
 
     void unclose_point( const tripoint &p ) {
-        auto &layer = get_layer( p.z );
-        const int index = flat_index( p.x, p.y );
-        layer.state[index] = ASL_NONE;
+        set_state( get_layer( p.z ), flat_index( p.x, p.y ), ASL_NONE );
     }
 };
 
@@ -172,6 +231,470 @@ bool is_disjoint( const Set1 &set1, const Set2 &set2 )
     return true;
 }
 
+// Cost of entering a tile as seen by the abstract graph, 0 if it can't be entered
+int pathfinding_abstraction::move_cost( const pathfinding_cache &cache, const point &p ) const
+{
+    const pf_special special = cache.special[p.x][p.y];
+    if( through_obstacles && ( special & PF_OBSTACLE ) ) {
+        // What map::route_step charges for bashing down something flimsy. Opening a door
+        // is cheaper, but the graph doesn't tell them apart.
+        return 14;
+    } else if( special & PF_WALL ) {
+        return 0;
+    }
+    return ( special & PF_SLOW ) ? 3 : 2;
+}
+
+// Dijkstra over the tiles of the submap containing `origin`.
+// Costs are indexed by the position within the submap, -1 means unreachable.
+void pathfinding_abstraction::submap_costs( const pathfinding_cache &cache, const point &origin,
+        std::array<int, SEEX *SEEY> &costs ) const
+{
+    const int x0 = origin.x - origin.x % SEEX;
+    const int y0 = origin.y - origin.y % SEEY;
+    costs.fill( -1 );
+
+    std::priority_queue< std::pair<int, int>, std::vector< std::pair<int, int> >,
+        std::greater< std::pair<int, int> > > open;
+    const int start = ( origin.x - x0 ) * SEEY + ( origin.y - y0 );
+    costs[start] = 0;
+    open.push( std::make_pair( 0, start ) );
+    while( !open.empty() ) {
+        const auto cur = open.top();
+        open.pop();
+        if( cur.first > costs[cur.second] ) {
+            continue;
+        }
+        const int cx = cur.second / SEEY;
+        const int cy = cur.second % SEEY;
+        for( int dx = -1; dx <= 1; dx++ ) {
+            for( int dy = -1; dy <= 1; dy++ ) {
+                const int nx = cx + dx;
+                const int ny = cy + dy;
+                if( ( dx == 0 && dy == 0 ) || nx < 0 || nx >= SEEX || ny < 0 || ny >= SEEY ) {
+                    continue;
+                }
+                const int cost = move_cost( cache, point( x0 + nx, y0 + ny ) );
+                if( cost == 0 ) {
+                    continue;
+                }
+                // Same diagonal penalty as in map::route
+                const int newg = cur.first + cost + ( ( dx != 0 && dy != 0 ) ? 1 : 0 );
+                const int index = nx * SEEY + ny;
+                if( costs[index] < 0 || newg < costs[index] ) {
+                    costs[index] = newg;
+                    open.push( std::make_pair( newg, index ) );
+                }
+            }
+        }
+    }
+}
+
+static int submap_local_index( const point &p )
+{
+    return ( p.x % SEEX ) * SEEY + ( p.y % SEEY );
+}
+
+pathfinding_abstraction::pathfinding_abstraction( const bool through_obstacles ) :
+    through_obstacles( through_obstacles )
+{
+    mapsize = MAPSIZE;
+    set_all_dirty();
+}
+
+void pathfinding_abstraction::set_dirty( const int smx, const int smy )
+{
+    // Portals on the borders are shared with the neighbours
+    constexpr std::array<int, 5> x_offset{{ 0, -1, 1, 0, 0 }};
+    constexpr std::array<int, 5> y_offset{{ 0, 0, 0, -1, 1 }};
+    for( size_t i = 0; i < x_offset.size(); i++ ) {
+        const int x = smx + x_offset[i];
+        const int y = smy + y_offset[i];
+        if( x >= 0 && x < MAPSIZE && y >= 0 && y < MAPSIZE ) {
+            dirty[x * MAPSIZE + y] = true;
+        }
+    }
+    any_dirty = true;
+}
+
+void pathfinding_abstraction::set_all_dirty()
+{
+    dirty.fill( true );
+    any_dirty = true;
+}
+
+int pathfinding_abstraction::submap_index( const point &p ) const
+{
+    if( p.x < 0 || p.y < 0 || p.x >= mapsize * SEEX || p.y >= mapsize * SEEY ) {
+        return -1;
+    }
+    return ( p.x / SEEX ) * MAPSIZE + ( p.y / SEEY );
+}
+
+void pathfinding_abstraction::build_submap( const pathfinding_cache &cache, const int smx,
+        const int smy )
+{
+    submap_graph &graph = submaps[smx * MAPSIZE + smy];
+    graph.nodes.clear();
+    graph.exits.clear();
+    counts.rebuilt_submaps++;
+
+    const int x0 = smx * SEEX;
+    const int y0 = smy * SEEY;
+    // Runs of passable tile pairs along each border become portals. Both submaps of a border
+    // see the same runs, so they pick the same tiles without needing to know about each other.
+    constexpr std::array<int, 4> x_offset{{ -1, 1, 0, 0 }};
+    constexpr std::array<int, 4> y_offset{{ 0, 0, -1, 1 }};
+    for( size_t dir = 0; dir < x_offset.size(); dir++ ) {
+        const int dx = x_offset[dir];
+        const int dy = y_offset[dir];
+        if( smx + dx < 0 || smx + dx >= mapsize || smy + dy < 0 || smy + dy >= mapsize ) {
+            continue;
+        }
+
+        const int length = dx != 0 ? SEEY : SEEX;
+        const auto tile_at = [&]( const int i ) {
+            if( dx != 0 ) {
+                return point( dx < 0 ? x0 : x0 + SEEX - 1, y0 + i );
+            }
+            return point( x0 + i, dy < 0 ? y0 : y0 + SEEY - 1 );
+        };
+        const auto add_portal = [&]( const int i ) {
+            const point here = tile_at( i );
+            graph.nodes.push_back( here );
+            graph.exits.push_back( point( here.x + dx, here.y + dy ) );
+        };
+
+        int run_start = -1;
+        for( int i = 0; i <= length; i++ ) {
+            bool open = false;
+            if( i < length ) {
+                const point here = tile_at( i );
+                open = move_cost( cache, here ) != 0 &&
+                       move_cost( cache, point( here.x + dx, here.y + dy ) ) != 0;
+            }
+            if( open && run_start < 0 ) {
+                run_start = i;
+            } else if( !open && run_start >= 0 ) {
+                // Long openings get a portal at each end so paths don't all funnel through the middle
+                const int run_end = i - 1;
+                if( run_end - run_start < 5 ) {
+                    add_portal( ( run_start + run_end ) / 2 );
+                } else {
+                    add_portal( run_start );
+                    add_portal( run_end );
+                }
+                run_start = -1;
+            }
+        }
+    }
+
+    const size_t num_nodes = graph.nodes.size();
+    graph.costs.assign( num_nodes * num_nodes, -1 );
+    std::array<int, SEEX *SEEY> costs;
+    for( size_t i = 0; i < num_nodes; i++ ) {
+        submap_costs( cache, graph.nodes[i], costs );
+        for( size_t j = 0; j < num_nodes; j++ ) {
+            graph.costs[i * num_nodes + j] = costs[submap_local_index( graph.nodes[j] )];
+        }
+    }
+}
+
+void pathfinding_abstraction::link_nodes()
+{
+    int total = 0;
+    owners.clear();
+    for( int sm = 0; sm < MAPSIZE * MAPSIZE; sm++ ) {
+        submaps[sm].offset = total;
+        total += submaps[sm].nodes.size();
+        owners.insert( owners.end(), submaps[sm].nodes.size(), sm );
+    }
+
+    partners.assign( total, -1 );
+    for( int sm = 0; sm < MAPSIZE * MAPSIZE; sm++ ) {
+        const submap_graph &graph = submaps[sm];
+        for( size_t i = 0; i < graph.nodes.size(); i++ ) {
+            const int other_sm = submap_index( graph.exits[i] );
+            if( other_sm < 0 ) {
+                continue;
+            }
+            const submap_graph &other = submaps[other_sm];
+            for( size_t j = 0; j < other.nodes.size(); j++ ) {
+                if( other.nodes[j] == graph.exits[i] && other.exits[j] == graph.nodes[i] ) {
+                    partners[graph.offset + i] = other.offset + j;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void pathfinding_abstraction::update( const pathfinding_cache &cache, const int new_mapsize )
+{
+    if( new_mapsize != mapsize ) {
+        mapsize = new_mapsize;
+        for( auto &graph : submaps ) {
+            graph.nodes.clear();
+            graph.exits.clear();
+            graph.costs.clear();
+        }
+        set_all_dirty();
+    }
+    if( !any_dirty ) {
+        return;
+    }
+
+    for( int smx = 0; smx < mapsize; smx++ ) {
+        for( int smy = 0; smy < mapsize; smy++ ) {
+            bool &sm_dirty = dirty[smx * MAPSIZE + smy];
+            if( sm_dirty ) {
+                build_submap( cache, smx, smy );
+                sm_dirty = false;
+            }
+        }
+    }
+
+    link_nodes();
+    any_dirty = false;
+}
+
+std::vector<point> pathfinding_abstraction::find_path( const pathfinding_cache &cache,
+        const point &f, const point &t, int &cost ) const
+{
+    std::vector<point> result;
+    const int from_sm = submap_index( f );
+    const int to_sm = submap_index( t );
+    if( from_sm < 0 || to_sm < 0 || from_sm == to_sm ) {
+        return result;
+    }
+    counts.searches++;
+
+    std::array<int, SEEX *SEEY> from_costs;
+    std::array<int, SEEX *SEEY> to_costs;
+    submap_costs( cache, f, from_costs );
+    submap_costs( cache, t, to_costs );
+
+    // All nodes, plus t as the last one
+    const int goal = partners.size();
+    std::vector<int> gscore( goal + 1, INT_MAX );
+    std::vector<int> parent( goal + 1, -1 );
+    std::vector<bool> closed( goal + 1, false );
+    std::priority_queue< std::pair<int, int>, std::vector< std::pair<int, int> >,
+        std::greater< std::pair<int, int> > > open;
+
+    const auto node_at = [this]( const int id ) {
+        const submap_graph &graph = submaps[owners[id]];
+        return graph.nodes[id - graph.offset];
+    };
+    const auto push = [&]( const int id, const int g, const int from ) {
+        if( g >= gscore[id] ) {
+            return;
+        }
+        gscore[id] = g;
+        parent[id] = from;
+        const int h = id == goal ? 0 : 2 * square_dist( node_at( id ).x, node_at( id ).y, t.x, t.y );
+        open.push( std::make_pair( g + h, id ) );
+    };
+
+    const submap_graph &start = submaps[from_sm];
+    for( size_t i = 0; i < start.nodes.size(); i++ ) {
+        const int c = from_costs[submap_local_index( start.nodes[i] )];
+        if( c >= 0 ) {
+            push( start.offset + i, c, -1 );
+        }
+    }
+
+    while( !open.empty() ) {
+        const int id = open.top().second;
+        open.pop();
+        if( closed[id] ) {
+            continue;
+        }
+        if( id == goal ) {
+            break;
+        }
+        closed[id] = true;
+
+        const int g = gscore[id];
+        const submap_graph &graph = submaps[owners[id]];
+        const int local = id - graph.offset;
+        const int num_nodes = graph.nodes.size();
+        if( owners[id] == to_sm ) {
+            // Costs are symmetric except for the cost of the first and last tile
+            const int c = to_costs[submap_local_index( graph.nodes[local] )];
+            if( c >= 0 ) {
+                push( goal, g + c, id );
+            }
+        }
+        for( int j = 0; j < num_nodes; j++ ) {
+            const int c = graph.costs[local * num_nodes + j];
+            if( c > 0 ) {
+                push( graph.offset + j, g + c, id );
+            }
+        }
+        const int partner = partners[id];
+        if( partner >= 0 ) {
+            push( partner, g + move_cost( cache, node_at( partner ) ), id );
+        }
+    }
+
+    if( gscore[goal] == INT_MAX ) {
+        return result;
+    }
+
+    cost = gscore[goal];
+    for( int id = parent[goal]; id >= 0; id = parent[id] ) {
+        result.push_back( node_at( id ) );
+    }
+    std::reverse( result.begin(), result.end() );
+    result.push_back( t );
+    return result;
+}
+
+// Finds a long path on the abstract graph and refines it with short searches between
+// consecutive waypoints. Returns an empty vector if any step fails.
+static std::vector<tripoint> route_hierarchical( const map &m, const tripoint &f,
+        const tripoint &t, const pathfinding_settings &settings,
+        const std::set<tripoint> &pre_closed, const bool through_obstacles )
+{
+    std::vector<tripoint> ret;
+    const pathfinding_cache &cache = m.get_pathfinding_cache_ref( f.z );
+    const pathfinding_abstraction &abstraction = m.get_pathfinding_abstraction_ref( f.z,
+            through_obstacles );
+    int cost = 0;
+    const std::vector<point> waypoints = abstraction.find_path( cache, point( f.x, f.y ),
+                                         point( t.x, t.y ), cost );
+    if( waypoints.empty() || cost > settings.max_length ) {
+        return ret;
+    }
+
+    ret.reserve( rl_dist( f, t ) * 2 );
+    tripoint from = f;
+    for( const point &wp : waypoints ) {
+        const tripoint to( wp.x, wp.y, f.z );
+        if( to == from ) {
+            continue;
+        }
+        if( to != t && pre_closed.count( to ) > 0 ) {
+            return std::vector<tripoint>();
+        }
+        const std::vector<tripoint> segment = m.route( from, to, settings, pre_closed );
+        if( segment.empty() ) {
+            return std::vector<tripoint>();
+        }
+        ret.insert( ret.end(), segment.begin(), segment.end() );
+        from = to;
+    }
+
+    return ret;
+}
+
+map::path_step_result map::route_step( const tripoint &from, const tripoint &p,
+                                       const pf_special p_special,
+                                       const pathfinding_settings &settings, int &cost ) const
+{
+    constexpr auto non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP;
+    if( !( p_special & non_normal ) ) {
+        // Boring flat dirt - the most common case above the ground
+        cost = 2;
+        return PATH_STEP_OK;
+    }
+
+    const int bash = settings.bash_strength;
+    const bool doors = settings.allow_open_doors;
+    const bool trapavoid = settings.avoid_traps;
+
+    // @todo De-uglify, de-huge-n
+    int part = -1;
+    const maptile &tile = maptile_at_internal( p );
+    const auto &terrain = tile.get_ter_t();
+    const auto &furniture = tile.get_furn_t();
+    const vehicle *veh = veh_at_internal( p, part );
+
+    cost = move_cost_internal( furniture, terrain, veh, part );
+    // Don't calculate bash rating unless we intend to actually use it
+    const int rating = ( bash == 0 || cost != 0 ) ? -1 :
+                       bash_rating_internal( bash, furniture, terrain, false, veh, part );
+
+    if( cost == 0 && rating <= 0 && ( !doors || !terrain.open ) && veh == nullptr ) {
+        return PATH_STEP_CLOSED;
+    }
+
+    if( cost == 0 ) {
+        // Handle all kinds of doors
+        // Only try to open INSIDE doors from the inside
+        if( doors && terrain.open &&
+            ( !terrain.has_flag( "OPENCLOSE_INSIDE" ) || !is_outside( from ) ) ) {
+            // To open and then move onto the tile
+            cost += 4;
+        } else if( veh != nullptr ) {
+            part = veh->obstacle_at_part( part );
+            int dummy = -1;
+            if( doors && veh->part_flag( part, VPFLAG_OPENABLE ) &&
+                ( !veh->part_flag( part, "OPENCLOSE_INSIDE" ) ||
+                  veh_at_internal( from, dummy ) == veh ) ) {
+                // Handle car doors, but don't try to path through curtains
+                cost += 10; // One turn to open, 4 to move there
+            } else if( part >= 0 && bash > 0 ) {
+                // Car obstacle that isn't a door
+                // @todo Account for armor
+                int hp = veh->parts[part].hp();
+                if( hp / 20 > bash ) {
+                    // Threshold damage thing means we just can't bash this down
+                    return PATH_STEP_CLOSED;
+                } else if( hp / 10 > bash ) {
+                    // Threshold damage thing means we will fail to deal damage pretty often
+                    hp *= 2;
+                }
+
+                cost += 2 * hp / bash + 8 + 4;
+            } else if( part >= 0 ) {
+                if( !doors || !veh->part_flag( part, VPFLAG_OPENABLE ) ) {
+                    // Won't be openable, don't try from other sides
+                    return PATH_STEP_CLOSED;
+                }
+
+                return PATH_STEP_SKIP;
+            }
+        } else if( rating > 1 ) {
+            // Expected number of turns to bash it down, 1 turn to move there
+            // and 5 turns of penalty not to trash everything just because we can
+            cost += ( 20 / rating ) + 2 + 10;
+        } else if( rating == 1 ) {
+            // Desperate measures, avoid whenever possible
+            cost += 500;
+        } else {
+            // Unbashable and unopenable from here
+            if( !doors || !terrain.open ) {
+                // Or anywhere else for that matter
+                return PATH_STEP_CLOSED;
+            }
+
+            return PATH_STEP_SKIP;
+        }
+    }
+
+    if( trapavoid && p_special & PF_TRAP ) {
+        const auto &ter_trp = terrain.trap.obj();
+        const auto &trp = ter_trp.is_benign() ? tile.get_trap_t() : ter_trp;
+        if( !trp.is_benign() ) {
+            // For now make them detect all traps
+            if( has_zlevels() && terrain.has_flag( TFLAG_NO_FLOOR ) ) {
+                // Special case - ledge in z-levels
+                // Warning: really expensive, needs a cache
+                if( valid_move( p, tripoint( p.x, p.y, p.z - 1 ), false, true ) ) {
+                    return PATH_STEP_LEDGE;
+                }
+            } else {
+                // Otherwise it's walkable
+                cost += 500;
+            }
+        }
+    }
+
+    return PATH_STEP_OK;
+}
+
 std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
                                   const pathfinding_settings &settings,
                                   const std::set<tripoint> &pre_closed ) const
@@ -213,10 +736,23 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
         return ret;
     }
 
+    // Long paths are found on the coarse submap graph first, searching every tile of
+    // the area between the end points is only the fallback
+    constexpr int hierarchical_min_dist = SEEX * 2;
+    if( f.z == t.z && rl_dist( f, t ) > hierarchical_min_dist ) {
+        const bool through_obstacles = settings.allow_open_doors ||
+                                       settings.bash_strength >= flimsy_bash_strength;
+        auto hierarchical = route_hierarchical( *this, f, t, settings, pre_closed, through_obstacles );
+        if( hierarchical.empty() && through_obstacles ) {
+            // One of the obstacles was too much for the creature, walk around all of them
+            hierarchical = route_hierarchical( *this, f, t, settings, pre_closed, false );
+        }
+        if( !hierarchical.empty() ) {
+            return hierarchical;
+        }
+    }
+
     int max_length = settings.max_length;
-    int bash = settings.bash_strength;
-    bool doors = settings.allow_open_doors;
-    bool trapavoid = settings.avoid_traps;
 
     const int pad = 16;  // Should be much bigger - low value makes pathfinders dumb!
     int minx = std::min( f.x, t.x ) - pad;
@@ -228,7 +764,8 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
     clip_to_bounds( minx, miny, minz );
     clip_to_bounds( maxx, maxy, maxz );
 
-    pathfinder pf( minx, miny, maxx, maxy );
+    static thread_local pathfinder pf;
+    pf.reset( minx, miny, maxx, maxy );
     // Make NPCs not want to path through player
     // But don't make player pathing stop working
     for( const auto &p : pre_closed ) {
@@ -249,8 +786,7 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
 
         const int parent_index = flat_index( cur.x, cur.y );
         auto &layer = pf.get_layer( cur.z );
-        auto &cur_state = layer.state[parent_index];
-        if( cur_state == ASL_CLOSED ) {
+        if( pf.get_state( layer, parent_index ) == ASL_CLOSED ) {
             continue;
         }
 
@@ -264,7 +800,7 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
             break;
         }
 
-        cur_state = ASL_CLOSED;
+        pf.set_state( layer, parent_index, ASL_CLOSED );
 
         const auto &pf_cache = get_pathfinding_cache_ref( cur.z );
         const auto cur_special = pf_cache.special[cur.x][cur.y];
@@ -283,125 +819,43 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
                 continue;
             }
 
-            if( layer.state[index] == ASL_CLOSED ) {
+            if( pf.get_state( layer, index ) == ASL_CLOSED ) {
                 continue;
             }
 
             // Penalize for diagonals or the path will look "unnatural"
             int newg = layer.gscore[parent_index] + ( ( cur.x != p.x && cur.y != p.y ) ? 1 : 0 );
 
-            const auto p_special = pf_cache.special[p.x][p.y];
-            // @todo De-uglify, de-huge-n
-            if( !( p_special & non_normal ) ) {
-                // Boring flat dirt - the most common case above the ground
-                newg += 2;
-            } else {
-                int part = -1;
-                const maptile &tile = maptile_at_internal( p );
-                const auto &terrain = tile.get_ter_t();
-                const auto &furniture = tile.get_furn_t();
-                const vehicle *veh = veh_at_internal( p, part );
-
-                const int cost = move_cost_internal( furniture, terrain, veh, part );
-                // Don't calculate bash rating unless we intend to actually use it
-                const int rating = ( bash == 0 || cost != 0 ) ? -1 :
-                                   bash_rating_internal( bash, furniture, terrain, false, veh, part );
-
-                if( cost == 0 && rating <= 0 && ( !doors || !terrain.open ) && veh == nullptr ) {
-                    layer.state[index] = ASL_CLOSED; // Close it so that next time we won't try to calc costs
+            int cost = 0;
+            switch( route_step( cur, p, pf_cache.special[p.x][p.y], settings, cost ) ) {
+                case PATH_STEP_OK:
+                    break;
+                case PATH_STEP_SKIP:
                     continue;
-                }
-
-                newg += cost;
-                if( cost == 0 ) {
-                    // Handle all kinds of doors
-                    // Only try to open INSIDE doors from the inside
-                    if( doors && terrain.open &&
-                        ( !terrain.has_flag( "OPENCLOSE_INSIDE" ) || !is_outside( cur ) ) ) {
-                        // To open and then move onto the tile
-                        newg += 4;
-                    } else if( veh != nullptr ) {
-                        part = veh->obstacle_at_part( part );
-                        int dummy = -1;
-                        if( doors && veh->part_flag( part, VPFLAG_OPENABLE ) &&
-                            ( !veh->part_flag( part, "OPENCLOSE_INSIDE" ) ||
-                              veh_at_internal( cur, dummy ) == veh ) ) {
-                            // Handle car doors, but don't try to path through curtains
-                            newg += 10; // One turn to open, 4 to move there
-                        } else if( part >= 0 && bash > 0 ) {
-                            // Car obstacle that isn't a door
-                            // @todo Account for armor
-                            int hp = veh->parts[part].hp();
-                            if( hp / 20 > bash ) {
-                                // Threshold damage thing means we just can't bash this down
-                                layer.state[index] = ASL_CLOSED;
-                                continue;
-                            } else if( hp / 10 > bash ) {
-                                // Threshold damage thing means we will fail to deal damage pretty often
-                                hp *= 2;
-                            }
-
-                            newg += 2 * hp / bash + 8 + 4;
-                        } else if( part >= 0 ) {
-                            if( !doors || !veh->part_flag( part, VPFLAG_OPENABLE ) ) {
-                                // Won't be openable, don't try from other sides
-                                layer.state[index] = ASL_CLOSED;
-                            }
-
-                            continue;
-                        }
-                    } else if( rating > 1 ) {
-                        // Expected number of turns to bash it down, 1 turn to move there
-                        // and 5 turns of penalty not to trash everything just because we can
-                        newg += ( 20 / rating ) + 2 + 10;
-                    } else if( rating == 1 ) {
-                        // Desperate measures, avoid whenever possible
-                        newg += 500;
-                    } else {
-                        // Unbashable and unopenable from here
-                        if( !doors || !terrain.open ) {
-                            // Or anywhere else for that matter
-                            layer.state[index] = ASL_CLOSED;
-                        }
-
-                        continue;
+                case PATH_STEP_CLOSED:
+                    // Close it so that next time we won't try to calc costs
+                    pf.set_state( layer, index, ASL_CLOSED );
+                    continue;
+                case PATH_STEP_LEDGE: {
+                    const tripoint below( p.x, p.y, p.z - 1 );
+                    if( !has_flag( TFLAG_NO_FLOOR, below ) ) {
+                        // Otherwise this would have been a huge fall
+                        // From cur, not p, because we won't be walking on air
+                        pf.add_point( layer.gscore[parent_index] + 10,
+                                      layer.score[parent_index] + 10 + 2 * rl_dist( below, t ),
+                                      cur, below );
                     }
-                }
 
-                if( trapavoid && p_special & PF_TRAP ) {
-                    const auto &ter_trp = terrain.trap.obj();
-                    const auto &trp = ter_trp.is_benign() ? tile.get_trap_t() : ter_trp;
-                    if( !trp.is_benign() ) {
-                        // For now make them detect all traps
-                        if( has_zlevels() && terrain.has_flag( TFLAG_NO_FLOOR ) ) {
-                            // Special case - ledge in z-levels
-                            // Warning: really expensive, needs a cache
-                            if( valid_move( p, tripoint( p.x, p.y, p.z - 1 ), false, true ) ) {
-                                tripoint below( p.x, p.y, p.z - 1 );
-                                if( !has_flag( TFLAG_NO_FLOOR, below ) ) {
-                                    // Otherwise this would have been a huge fall
-                                    auto &layer = pf.get_layer( p.z - 1 );
-                                    // From cur, not p, because we won't be walking on air
-                                    pf.add_point( layer.gscore[parent_index] + 10,
-                                                  layer.score[parent_index] + 10 + 2 * rl_dist( below, t ),
-                                                  cur, below );
-                                }
-
-                                // Close p, because we won't be walking on it
-                                layer.state[index] = ASL_CLOSED;
-                                continue;
-                            }
-                        } else if( trapavoid ) {
-                            // Otherwise it's walkable
-                            newg += 500;
-                        }
-                    }
+                    // Close p, because we won't be walking on it
+                    pf.set_state( layer, index, ASL_CLOSED );
+                    continue;
                 }
             }
+            newg += cost;
 
             // If not visited, add as open
             // If visited, add it only if we can do so with better score
-            if( layer.state[index] == ASL_NONE || newg < layer.gscore[index] ) {
+            if( pf.get_state( layer, index ) == ASL_NONE || newg < layer.gscore[index] ) {
                 pf.add_point( newg, newg + 2 * rl_dist( p, t ), cur, p );
             }
         }
@@ -417,7 +871,6 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
             tripoint dest( cur.x, cur.y, cur.z - 1 );
             dest = vertical_move_destination<TFLAG_GOES_UP>( *this, dest );
             if( inbounds( dest ) ) {
-                auto &layer = pf.get_layer( dest.z );
                 pf.add_point( layer.gscore[parent_index] + 2,
                               layer.score[parent_index] + 2 * rl_dist( dest, t ),
                               cur, dest );
@@ -427,7 +880,6 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
             tripoint dest( cur.x, cur.y, cur.z + 1 );
             dest = vertical_move_destination<TFLAG_GOES_DOWN>( *this, dest );
             if( inbounds( dest ) ) {
-                auto &layer = pf.get_layer( dest.z );
                 pf.add_point( layer.gscore[parent_index] + 2,
                               layer.score[parent_index] + 2 * rl_dist( dest, t ),
                               cur, dest );
@@ -435,7 +887,6 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
         }
         if( cur.z < maxz && parent_terrain.has_flag( TFLAG_RAMP ) &&
             valid_move( cur, tripoint( cur.x, cur.y, cur.z + 1 ), false, true ) ) {
-            auto &layer = pf.get_layer( cur.z + 1 );
             for( size_t it = 0; it < 8; it++ ) {
                 const tripoint above( cur.x + x_offset[it], cur.y + y_offset[it], cur.z + 1 );
                 pf.add_point( layer.gscore[parent_index] + 4,
@@ -474,3 +925,162 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
 
     return ret;
 }
+
+bool flow_field::matches( const tripoint &t, const pathfinding_settings &settings ) const
+{
+    // Stairs don't matter, fields are limited to the z-level of the target
+    return target == t && bash_strength == settings.bash_strength &&
+           max_dist >= settings.max_dist && allow_open_doors == settings.allow_open_doors &&
+           avoid_traps == settings.avoid_traps;
+}
+
+int flow_bash_strength( const int bash_strength )
+{
+    static std::vector<int> thresholds;
+    static size_t ter_count = 0;
+    static size_t furn_count = 0;
+    if( ter_count != ter_t::count() || furn_count != furn_t::count() ) {
+        // Game data was (re)loaded
+        ter_count = ter_t::count();
+        furn_count = furn_t::count();
+        std::set<int> found;
+        const auto add = [&found]( const map_bash_info & bash ) {
+            if( bash.str_max != -1 ) {
+                found.insert( bash.str_min );
+                found.insert( bash.str_max );
+            }
+        };
+        for( size_t i = 0; i < ter_count; i++ ) {
+            add( ter_id( i ).obj().bash );
+        }
+        for( size_t i = 0; i < furn_count; i++ ) {
+            add( furn_id( i ).obj().bash );
+        }
+        thresholds.assign( found.begin(), found.end() );
+    }
+
+    const auto iter = std::upper_bound( thresholds.begin(), thresholds.end(), bash_strength );
+    if( iter == thresholds.begin() ) {
+        // Too weak to bash any terrain, only vehicles tell them apart
+        return bash_strength;
+    }
+    return *std::prev( iter );
+}
+
+const flow_field &map::get_flow_field( const tripoint &t, const pathfinding_settings &settings ) const
+{
+    pathfinding_settings field_settings = settings;
+    field_settings.bash_strength = flow_bash_strength( settings.bash_strength );
+    // Fields are only reused within a turn, so terrain changes (bashed doors etc.)
+    // are picked up on the next one
+    const int turn = calendar::turn;
+    flow_fields.erase( std::remove_if( flow_fields.begin(), flow_fields.end(),
+    [this, turn]( const std::unique_ptr<flow_field> &ff ) {
+        return ff->turn != turn || ff->origin != abs_sub;
+    } ), flow_fields.end() );
+
+    for( const auto &ff : flow_fields ) {
+        if( ff->matches( t, field_settings ) ) {
+            return *ff;
+        }
+    }
+
+    flow_fields.emplace_back( new flow_field() );
+    flow_field &field = *flow_fields.back();
+    field.target = t;
+    field.origin = abs_sub;
+    field.turn = turn;
+    field.bash_strength = field_settings.bash_strength;
+    field.max_dist = settings.max_dist;
+    field.allow_open_doors = settings.allow_open_doors;
+    field.avoid_traps = settings.avoid_traps;
+    field.dist.fill( INT_MAX );
+    field.next.fill( -1 );
+
+    const int mapsize = my_MAPSIZE * SEEX;
+    const auto &pf_cache = get_pathfinding_cache_ref( t.z );
+    static thread_local pathfinding_queue open;
+    static thread_local std::vector<bool> settled;
+    open.clear();
+    settled.assign( field.dist.size(), false );
+
+    field.dist[flat_index( t.x, t.y )] = 0;
+    open.push( 0, t );
+    // Dijkstra from the target outwards, with the step costs of creatures walking
+    // towards it, i.e. from the neighbour onto the current tile
+    while( !open.empty() ) {
+        const tripoint cur = open.pop();
+        const int cur_index = flat_index( cur.x, cur.y );
+        if( settled[cur_index] ) {
+            continue;
+        }
+        settled[cur_index] = true;
+
+        const auto cur_special = pf_cache.special[cur.x][cur.y];
+        constexpr std::array<int, 8> x_offset{{ -1,  1,  0,  0,  1, -1, -1, 1 }};
+        constexpr std::array<int, 8> y_offset{{  0,  0, -1,  1, -1,  1, -1, 1 }};
+        for( size_t i = 0; i < 8; i++ ) {
+            const tripoint p( cur.x + x_offset[i], cur.y + y_offset[i], cur.z );
+            if( p.x < 0 || p.x >= mapsize || p.y < 0 || p.y >= mapsize ||
+                rl_dist( p, t ) > field.max_dist ) {
+                // route_flow doesn't ask for paths from farther away
+                continue;
+            }
+
+            const int index = flat_index( p.x, p.y );
+            if( settled[index] ) {
+                continue;
+            }
+
+            int cost = 0;
+            const auto result = route_step( p, cur, cur_special, field_settings, cost );
+            if( result == PATH_STEP_CLOSED ) {
+                // Can't enter cur from any side
+                break;
+            } else if( result != PATH_STEP_OK ) {
+                // Ledges lead off this z-level
+                continue;
+            }
+
+            // Same diagonal penalty as in route
+            const int newd = field.dist[cur_index] + cost + ( ( cur.x != p.x && cur.y != p.y ) ? 1 : 0 );
+            if( newd < field.dist[index] ) {
+                field.dist[index] = newd;
+                field.next[index] = cur_index;
+                open.push( newd, p );
+            }
+        }
+    }
+
+    return field;
+}
+
+std::vector<tripoint> map::route_flow( const tripoint &f, const tripoint &t,
+                                       const pathfinding_settings &settings ) const
+{
+    if( f == t || f.z != t.z || !inbounds( f ) || !inbounds( t ) ||
+        rl_dist( f, t ) > settings.max_dist ) {
+        // Not worth a field, or not possible with one
+        return route( f, t, settings );
+    }
+
+    const auto &field = get_flow_field( t, settings );
+    int cur_index = flat_index( f.x, f.y );
+    if( field.dist[cur_index] == INT_MAX ) {
+        // Might still be reachable through stairs
+        return has_zlevels() ? route( f, t, settings ) : std::vector<tripoint>();
+    }
+
+    std::vector<tripoint> ret;
+    if( field.dist[cur_index] > settings.max_length ) {
+        return ret;
+    }
+
+    const int target_index = flat_index( t.x, t.y );
+    while( cur_index != target_index ) {
+        cur_index = field.next[cur_index];
+        ret.emplace_back( cur_index / ( MAPSIZE * SEEY ), cur_index % ( MAPSIZE * SEEY ), f.z );
+    }
+
+    return ret;
+}
@@ -1,9 +1,15 @@
 #ifndef PATHFINDING_H
 #define PATHFINDING_H
 
+#include "enums.h"
 #include "game_constants.h"
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 class JsonObject;
+struct pathfinding_cache;
 
 enum pf_special : char {
     PF_NORMAL = 0x00,    // Plain boring tile (grass, dirt, floor etc.)
@@ -13,8 +19,12 @@ enum pf_special : char {
     PF_FIELD = 0x08,     // Dangerous field
     PF_TRAP = 0x10,      // Dangerous trap
     PF_UPDOWN = 0x20,    // Stairs, ramp etc.
+    PF_OBSTACLE = 0x40,  // Unpassable, but can be opened or easily bashed (with PF_WALL)
 };
 
+/** Obstacles that start to give way to this bash strength count as PF_OBSTACLE. */
+constexpr int flimsy_bash_strength = 10;
+
 constexpr pf_special operator | ( pf_special lhs, pf_special rhs )
 {
     return static_cast<pf_special>( static_cast< int >( lhs ) | static_cast< int >( rhs ) );
@@ -37,6 +47,77 @@ inline pf_special &operator &= ( pf_special &lhs, pf_special rhs )
     return lhs;
 }
 
+/**
+ * Coarse graph over the submaps of one z-level, used to find long paths (HPA*).
+ * Its nodes are the tiles on both sides of "portals": passable gaps in the border
+ * between two neighbouring submaps. Every submap caches the walking cost between all
+ * of its nodes, so a long path can be found on this small graph and then be refined
+ * with short tile-level searches.
+ * There are two graphs per z-level: one only for walking, and one for creatures that
+ * open doors or bash, in which PF_OBSTACLE tiles are passable at a penalty. The refining
+ * searches find out whether the creature can really get through them.
+ * Traps and fields are not considered.
+ */
+class pathfinding_abstraction
+{
+    public:
+        struct stats {
+            /** Number of submap graphs built */
+            uint64_t rebuilt_submaps = 0;
+            /** Number of searches on the graph */
+            uint64_t searches = 0;
+        };
+
+        explicit pathfinding_abstraction( bool through_obstacles );
+
+        /** Marks the submap at the given grid position, and thus its borders, for a rebuild. */
+        void set_dirty( int smx, int smy );
+        void set_all_dirty();
+        /** Rebuilds the dirty submaps from the tile cache. */
+        void update( const pathfinding_cache &cache, int mapsize );
+
+        /**
+         * Finds a path from f to t on the abstract graph.
+         * @return The waypoints after f, ending with t, or an empty vector if there is no path.
+         * @param cost Set to the cost of the returned path.
+         */
+        std::vector<point> find_path( const pathfinding_cache &cache, const point &f, const point &t,
+                                      int &cost ) const;
+
+        const stats &get_stats() const {
+            return counts;
+        }
+
+    private:
+        struct submap_graph {
+            std::vector<point> nodes;
+            /** The tile on the other side of the border for each node. */
+            std::vector<point> exits;
+            /** Row-major `nodes.size()` squared matrix, -1 if unreachable. */
+            std::vector<int> costs;
+            /** Global index of the first node of this submap. */
+            int offset = 0;
+        };
+
+        int move_cost( const pathfinding_cache &cache, const point &p ) const;
+        void submap_costs( const pathfinding_cache &cache, const point &origin,
+                           std::array<int, SEEX *SEEY> &costs ) const;
+        void build_submap( const pathfinding_cache &cache, int smx, int smy );
+        void link_nodes();
+        int submap_index( const point &p ) const;
+
+        bool through_obstacles;
+        std::array<submap_graph, MAPSIZE * MAPSIZE> submaps;
+        std::array<bool, MAPSIZE * MAPSIZE> dirty;
+        bool any_dirty;
+        int mapsize;
+        /** Global index of the node across the border for every node. */
+        std::vector<int> partners;
+        /** Submap of every node, by global index. */
+        std::vector<int> owners;
+        mutable stats counts;
+};
+
 struct pathfinding_cache {
     pathfinding_cache();
     ~pathfinding_cache();
@@ -44,6 +125,11 @@ struct pathfinding_cache {
     bool dirty;
 
     pf_special special[MAPSIZE * SEEX][MAPSIZE * SEEY];
+
+    /** For creatures that neither open doors nor bash */
+    pathfinding_abstraction abstraction;
+    /** For creatures that open doors or bash */
+    pathfinding_abstraction obstacle_abstraction;
 };
 
 struct pathfinding_settings {
@@ -64,4 +150,42 @@ struct pathfinding_settings {
           avoid_traps( at ), allow_climb_stairs( acs ) {}
 };
 
+/**
+ * Distance to a single target from the tiles of its z-level up to max_dist away, for
+ * the movement abilities in the settings it was built with. Following @ref next from
+ * any tile gives a shortest path to the target, so all creatures heading for the same
+ * target can share one search.
+ */
+struct flow_field {
+    tripoint target;
+    /** Map position (abs_sub) when the field was built, the field is local to it. */
+    tripoint origin;
+    int turn = 0;
+
+    /** Rounded down to a bash threshold of the terrain, see @ref flow_bash_strength */
+    int bash_strength = 0;
+    int max_dist = 0;
+    bool allow_open_doors = false;
+    bool avoid_traps = false;
+
+    /** Cost of the path to the target, INT_MAX if unreachable. Indexed like the pathfinder. */
+    std::array<int, MAPSIZE * SEEX * MAPSIZE * SEEY> dist;
+    /** Index of the next tile on the path to the target, -1 if none. */
+    std::array<int, MAPSIZE * SEEX * MAPSIZE * SEEY> next;
+
+    /**
+     * Whether this field can be used for paths to t by a creature with these settings.
+     * The bash strength of the settings must already be rounded by @ref flow_bash_strength.
+     */
+    bool matches( const tripoint &t, const pathfinding_settings &settings ) const;
+};
+
+/**
+ * The strongest bash threshold of any terrain or furniture (the strength at which it
+ * starts to give way or breaks for sure) up to bash_strength. Creatures whose strengths
+ * round to the same threshold share flow fields, their paths only avoid the obstacles
+ * that are harder to bash than the threshold.
+ */
+int flow_bash_strength( int bash_strength );
+
 #endif
@@ -6,6 +6,7 @@
 #include "bionics.h"
 #include "mission.h"
 #include "game.h"
+#include "creature_tracker.h"
 #include "map.h"
 #include "debug.h"
 #include "addiction.h"
@@ -13490,21 +13491,22 @@ int player::print_info(WINDOW* w, int vStart, int, int column) const
     return vStart;
 }
 
-std::vector<Creature *> get_creatures_if( std::function<bool (const Creature &)>pred )
+/** Creatures within range of center that match pred. */
+static std::vector<Creature *> get_creatures_if( const tripoint &center, const int range,
+        const std::function<bool( const Creature & )> &pred )
 {
     std::vector<Creature *> result;
-    for( size_t i = 0; i < g->num_zombies(); i++ ) {
-        auto &critter = g->zombie( i );
-        if( !critter.is_dead() && pred( critter ) ) {
+    g->critter_tracker->for_each_in_radius( center, range, [&]( monster & critter ) {
+        if( pred( critter ) ) {
             result.push_back( &critter );
         }
-    }
+    } );
     for( auto & n : g->active_npc ) {
-        if( pred( *n ) ) {
+        if( rl_dist( center, n->pos() ) <= range && pred( *n ) ) {
             result.push_back( n );
         }
     }
-    if( pred( g->u ) ) {
+    if( rl_dist( center, g->u.pos() ) <= range && pred( g->u ) ) {
         result.push_back( &g->u );
     }
     return result;
@@ -13517,26 +13519,24 @@ bool player::is_visible_in_range( const Creature &critter, const int range ) con
 
 std::vector<Creature *> player::get_visible_creatures( const int range ) const
 {
-    return get_creatures_if( [this, range]( const Creature &critter ) -> bool {
+    return get_creatures_if( pos(), range, [this]( const Creature &critter ) -> bool {
         return this != &critter && pos() != critter.pos() && // @todo get rid of fake npcs (pos() check)
-          rl_dist( pos(), critter.pos() ) <= range && sees( critter );
+          sees( critter );
     } );
 }
 
 std::vector<Creature *> player::get_targetable_creatures( const int range ) const
 {
-    return get_creatures_if( [this, range]( const Creature &critter ) -> bool {
+    return get_creatures_if( pos(), range, [this]( const Creature &critter ) -> bool {
         return this != &critter && pos() != critter.pos() && // @todo get rid of fake npcs (pos() check)
-          rl_dist( pos(), critter.pos() ) <= range &&
           ( sees( critter ) || sees_with_infrared( critter ) );
     } );
 }
 
 std::vector<Creature *> player::get_hostile_creatures( int range ) const
 {
-    return get_creatures_if( [this, range] ( const Creature &critter ) -> bool {
+    return get_creatures_if( pos(), range, [this] ( const Creature &critter ) -> bool {
         return this != &critter && pos() != critter.pos() && // @todo get rid of fake npcs (pos() check)
-            rl_dist( pos(), critter.pos() ) <= range &&
             critter.attitude_to( *this ) == A_HOSTILE && sees( critter );
     } );
 }
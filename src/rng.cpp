@@ -2,29 +2,111 @@
 #include "rng.h"
 #include "game_constants.h"
 #include <stdlib.h>
+#include <atomic>
 #include <random>
-#include <chrono>
+#include <vector>
 
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+// The engines of the active scoped_rng_engine objects of this thread, innermost last
+static thread_local std::vector<rng_engine *> scoped_engines;
+
+// Threads other than the main one get different sequences, though they should use a
+// scoped_rng_seed for anything that has to be reproducible.
+static std::atomic<uint64_t> next_thread_seed( 0 );
+static thread_local rng_engine default_engine( next_thread_seed++ );
+
+// SplitMix64, spreads the seed over the whole state as recommended for xoshiro
+static uint64_t splitmix64( uint64_t &x )
+{
+    uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+    z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+    return z ^ ( z >> 31 );
+}
+
+rng_engine::rng_engine( const uint64_t seed )
+{
+    this->seed( seed );
+}
+
+void rng_engine::seed( uint64_t seed )
+{
+    for( auto &elem : s ) {
+        elem = splitmix64( seed );
+    }
+}
+
+void rng_engine::set_state( const state_type &state )
+{
+    s = state;
+}
+
+uint64_t rng_engine::below( const uint64_t bound )
+{
+    if( bound <= UINT32_MAX ) {
+        // Lemire's multiply and shift, without division in most cases
+        uint64_t m = ( ( *this )() >> 32 ) * bound;
+        if( uint32_t( m ) < bound ) {
+            const uint32_t threshold = uint32_t( -uint32_t( bound ) ) % uint32_t( bound );
+            while( uint32_t( m ) < threshold ) {
+                m = ( ( *this )() >> 32 ) * bound;
+            }
+        }
+        return m >> 32;
+    }
+    // Rejects the incomplete last block of bound values
+    const uint64_t threshold = ( 0 - bound ) % bound;
+    uint64_t r = ( *this )();
+    while( r < threshold ) {
+        r = ( *this )();
+    }
+    return r % bound;
+}
+
+rng_engine &rng_get_engine()
+{
+    return scoped_engines.empty() ? default_engine : *scoped_engines.back();
+}
+
+void rng_set_engine_seed( const uint64_t seed )
+{
+    default_engine.seed( seed );
+}
+
+scoped_rng_engine::scoped_rng_engine( rng_engine &engine )
+{
+    scoped_engines.push_back( &engine );
+}
+
+scoped_rng_engine::~scoped_rng_engine()
+{
+    scoped_engines.pop_back();
+}
+
 long rng( long val1, long val2 )
 {
     long minVal = ( val1 < val2 ) ? val1 : val2;
     long maxVal = ( val1 < val2 ) ? val2 : val1;
-    return minVal + long( ( maxVal - minVal + 1 ) * double( rand() / double( RAND_MAX + 1.0 ) ) );
+    // Unsigned, the range can be larger than LONG_MAX
+    const uint64_t range = uint64_t( maxVal ) - uint64_t( minVal );
+    if( range == UINT64_MAX ) {
+        return long( rng_get_engine()() );
+    }
+    return long( uint64_t( minVal ) + rng_get_engine().below( range + 1 ) );
 }
 
 double rng_float( double val1, double val2 )
 {
     double minVal = ( val1 < val2 ) ? val1 : val2;
     double maxVal = ( val1 < val2 ) ? val2 : val1;
-    return minVal + ( maxVal - minVal ) * double( rand() ) / double( RAND_MAX + 1.0 );
+    return minVal + ( maxVal - minVal ) * rng_get_engine().next_double();
 }
 
 bool one_in( int chance )
 {
-    return ( chance <= 1 || rng( 0, chance - 1 ) == 0 );
+    return ( chance <= 1 || rng_get_engine().below( chance ) == 0 );
 }
 
 //this works just like one_in, but it accepts doubles as input to calculate chances like "1 in 350,52"
@@ -35,7 +117,7 @@ bool one_in_improved( double chance )
 
 bool x_in_y( double x, double y )
 {
-    return ( ( double )rand() / RAND_MAX ) <= ( ( double )x / y );
+    return rng_get_engine().next_double() < x / y;
 }
 
 int dice( int number, int sides )
@@ -80,8 +162,6 @@ int djb2_hash( const unsigned char *str )
 
 double rng_normal( double lo, double hi )
 {
-    static std::default_random_engine eng;
-
     if( lo > hi ) {
         std::swap( lo, hi );
     }
@@ -90,15 +170,13 @@ double rng_normal( double lo, double hi )
     if( range == 0.0 ) {
         return hi;
     }
-    double val = std::normal_distribution<double>( ( hi + lo ) / 2, range )( eng );
+    double val = std::normal_distribution<double>( ( hi + lo ) / 2, range )( rng_get_engine() );
     return std::max( std::min( val, hi ), lo );
 }
 
 double normal_roll( double mean, double stddev )
 {
-    static std::default_random_engine eng(
-        std::chrono::system_clock::now().time_since_epoch().count() );
-    return std::normal_distribution<double>( mean, stddev )( eng );
+    return std::normal_distribution<double>( mean, stddev )( rng_get_engine() );
 }
 
 double erfinv( double x )
@@ -3,6 +3,9 @@
 
 #include "compatibility.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <functional>
 
 long rng( long val1, long val2 );
@@ -19,6 +22,99 @@ int divide_roll_remainder( double dividend, double divisor );
 
 int djb2_hash( const unsigned char *input );
 
+/**
+ * The random number engine behind the functions here (xoshiro256**, see
+ * http://xoshiro.di.unimi.it). It is fast, has 256 bits of state and passes the usual
+ * statistical tests, unlike rand(). It can be used with the distributions of <random>.
+ *
+ * Each thread has its own default engine (see @ref rng_get_engine), so the functions here
+ * can be used on any thread. Its state can be saved and restored to replay a sequence.
+ */
+class rng_engine
+{
+    public:
+        using result_type = uint64_t;
+        using state_type = std::array<uint64_t, 4>;
+
+        /** Engines with the same seed give the same numbers. */
+        explicit rng_engine( uint64_t seed = 0 );
+
+        void seed( uint64_t seed );
+        const state_type &state() const {
+            return s;
+        }
+        /** Continues the sequence from where @ref state was taken. */
+        void set_state( const state_type &state );
+
+        static constexpr result_type min() {
+            return 0;
+        }
+        static constexpr result_type max() {
+            return UINT64_MAX;
+        }
+        result_type operator()() {
+            const uint64_t result = rotl( s[1] * 5, 7 ) * 9;
+            const uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl( s[3], 45 );
+            return result;
+        }
+
+        /** Uniformly distributed in [0, bound), bound must not be 0. */
+        uint64_t below( uint64_t bound );
+        /** Uniformly distributed in [0, 1). */
+        double next_double() {
+            return ( ( *this )() >> 11 ) * ( 1.0 / 9007199254740992.0 );
+        }
+
+    private:
+        static uint64_t rotl( const uint64_t x, const int k ) {
+            return ( x << k ) | ( x >> ( 64 - k ) );
+        }
+        state_type s;
+};
+
+/**
+ * The engine the functions here use on the current thread: the one of the innermost
+ * @ref scoped_rng_engine or @ref scoped_rng_seed, otherwise the thread's default engine.
+ */
+rng_engine &rng_get_engine();
+/** Seeds the default engine of the current thread, the game seeds the main thread's one. */
+void rng_set_engine_seed( uint64_t seed );
+
+/**
+ * While an object of this class exists, the functions here take the random numbers of the
+ * current thread from the given engine, e.g. a separate stream of a subsystem that
+ * should not disturb (or be disturbed by) the game's random numbers. Scopes can be nested.
+ */
+class scoped_rng_engine
+{
+    public:
+        explicit scoped_rng_engine( rng_engine &engine );
+        ~scoped_rng_engine();
+        scoped_rng_engine( const scoped_rng_engine & ) = delete;
+        scoped_rng_engine &operator=( const scoped_rng_engine & ) = delete;
+};
+
+/**
+ * Like @ref scoped_rng_engine, but with its own engine with the given seed. Work done in
+ * the scope gives the same results on any thread and doesn't disturb the game's random
+ * numbers.
+ */
+class scoped_rng_seed
+{
+    public:
+        explicit scoped_rng_seed( unsigned seed ) : engine( seed ), use( engine ) { }
+
+    private:
+        rng_engine engine;
+        scoped_rng_engine use;
+};
+
 double rng_normal( double lo, double hi );
 
 inline double rng_normal( double hi )
@@ -93,6 +189,18 @@ inline V random_entry_removed( C &container )
     return result;
 }
 
+/**
+ * Shuffles the elements in [first, last) like std::random_shuffle, but with the random
+ * numbers of @ref rng (so it follows @ref scoped_rng_seed).
+ */
+template<typename Iter>
+inline void rng_shuffle( Iter first, Iter last )
+{
+    for( auto n = last - first; n > 1; --n ) {
+        std::iter_swap( first + ( n - 1 ), first + rng( 0, n - 1 ) );
+    }
+}
+
 /**
  * Returns z such that std::erf( z ) == x
  */
@@ -0,0 +1,318 @@
+#include "save_writer.h"
+
+#include "filesystem.h"
+#include "mapsharing.h"
+#include "output.h"
+#include "translations.h"
+
+#include <cstdio>
+#include <deque>
+#include <set>
+#include <vector>
+
+#if (defined _WIN32 || defined __WIN32__)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if (defined _WIN32 || defined WINDOWS) && !defined _MSC_VER && !defined _GLIBCXX_HAS_GTHREADS
+// MinGW without a thread model has no mutexes or condition variables, see thread_pool.cpp.
+// Files are written right away there.
+#define CATA_NO_SAVE_THREAD
+#endif
+
+#ifndef CATA_NO_SAVE_THREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace
+{
+
+struct write_job {
+    std::string path;
+    std::string data;
+    bool exclusive;
+    std::string fail_message;
+    /** Remove the file instead of writing it */
+    bool remove;
+    /** Write into the file at this offset instead of replacing it, if not negative */
+    long long offset;
+};
+
+struct write_error {
+    std::string path;
+    std::string fail_message;
+    /** Untranslated */
+    const char *reason;
+};
+
+bool sync_file( FILE *const file )
+{
+#if (defined _WIN32 || defined __WIN32__)
+    return _commit( _fileno( file ) ) == 0;
+#else
+    return fsync( fileno( file ) ) == 0;
+#endif
+}
+
+/** Writes the data to a temporary file and moves that over the target. @return nullptr or the error. */
+const char *write_through_temp_file( const std::string &path, const std::string &data )
+{
+    const std::string temp_path = path + ".temp";
+    FILE *const file = fopen( temp_path.c_str(), "wb" );
+    if( file == nullptr ) {
+        return "opening file failed";
+    }
+    const bool written = fwrite( data.data(), 1, data.size(), file ) == data.size() &&
+                         fflush( file ) == 0 && sync_file( file );
+    if( fclose( file ) != 0 || !written ) {
+        remove_file( temp_path );
+        return "writing to file failed";
+    }
+    if( !rename_file( temp_path, path ) ) {
+        remove_file( temp_path );
+        return "replacing file failed";
+    }
+    return nullptr;
+}
+
+/** Writes the data into the file at offset, creating the file if needed. @return nullptr or the error. */
+const char *write_into_file( const std::string &path, const long long offset,
+                             const std::string &data )
+{
+    FILE *file = fopen( path.c_str(), "r+b" );
+    if( file == nullptr ) {
+        file = fopen( path.c_str(), "w+b" );
+    }
+    if( file == nullptr ) {
+        return "opening file failed";
+    }
+#if (defined _WIN32 || defined __WIN32__)
+    const bool positioned = _fseeki64( file, offset, SEEK_SET ) == 0;
+#else
+    const bool positioned = fseeko( file, offset, SEEK_SET ) == 0;
+#endif
+    const bool written = positioned && fwrite( data.data(), 1, data.size(), file ) == data.size() &&
+                         fflush( file ) == 0 && sync_file( file );
+    if( fclose( file ) != 0 || !written ) {
+        return "writing to file failed";
+    }
+    return nullptr;
+}
+
+const char *write_file( const write_job &job )
+{
+    if( job.remove ) {
+        // The file may not exist, and a stale file does no harm
+        if( file_exist( job.path ) ) {
+            remove_file( job.path );
+        }
+        return nullptr;
+    }
+    if( job.offset >= 0 ) {
+        return write_into_file( job.path, job.offset, job.data );
+    }
+    if( !job.exclusive ) {
+        return write_through_temp_file( job.path, job.data );
+    }
+    // Same lock as fopen_exclusive uses
+    const std::string lock_path = job.path + ".lock";
+    const int lock = getLock( lock_path.c_str() );
+    if( lock == -1 ) {
+        return "opening file failed";
+    }
+    const char *const error = write_through_temp_file( job.path, job.data );
+    releaseLock( lock, lock_path.c_str() );
+    return error;
+}
+
+bool show_errors( const std::vector<write_error> &errors )
+{
+    for( const auto &e : errors ) {
+        popup( _( "Failed to write %1$s to \"%2$s\": %3$s" ), e.fail_message.c_str(), e.path.c_str(),
+               _( e.reason ) );
+    }
+    return errors.empty();
+}
+
+} // namespace
+
+#ifndef CATA_NO_SAVE_THREAD
+
+struct save_writer::shared_state {
+    std::thread thread;
+
+    std::mutex mutex;
+    // Signalled when a job was queued, or when stopping
+    std::condition_variable wake;
+    // Signalled whenever a job is done
+    std::condition_variable done;
+
+    std::deque<write_job> jobs;
+    // Paths of the queued jobs and of the one being written
+    std::multiset<std::string> pending;
+    std::vector<write_error> errors;
+    bool stop = false;
+
+    void work() {
+        std::unique_lock<std::mutex> lock( mutex );
+        while( true ) {
+            wake.wait( lock, [this]() {
+                return stop || !jobs.empty();
+            } );
+            if( jobs.empty() ) {
+                // Only stop once everything is written
+                return;
+            }
+            const write_job job = std::move( jobs.front() );
+            jobs.pop_front();
+
+            lock.unlock();
+            const char *const error = write_file( job );
+            lock.lock();
+
+            if( error != nullptr ) {
+                errors.push_back( write_error{ job.path, job.fail_message, error } );
+            }
+            pending.erase( pending.find( job.path ) );
+            done.notify_all();
+        }
+    }
+};
+
+save_writer::save_writer() : state( new shared_state() )
+{
+    state->thread = std::thread( &shared_state::work, state.get() );
+}
+
+save_writer::~save_writer()
+{
+    {
+        std::lock_guard<std::mutex> lock( state->mutex );
+        state->stop = true;
+    }
+    state->wake.notify_all();
+    state->thread.join();
+}
+
+void save_writer::write( const std::string &path, std::string data, const bool exclusive,
+                         const std::string &fail_message )
+{
+    {
+        std::lock_guard<std::mutex> lock( state->mutex );
+        state->jobs.push_back( write_job{ path, std::move( data ), exclusive, fail_message, false, -1 } );
+        state->pending.insert( path );
+    }
+    state->wake.notify_one();
+}
+
+void save_writer::write_at( const std::string &path, const long long offset, std::string data,
+                            const std::string &fail_message )
+{
+    {
+        std::lock_guard<std::mutex> lock( state->mutex );
+        state->jobs.push_back( write_job{ path, std::move( data ), false, fail_message, false, offset } );
+        state->pending.insert( path );
+    }
+    state->wake.notify_one();
+}
+
+void save_writer::remove( const std::string &path )
+{
+    {
+        std::lock_guard<std::mutex> lock( state->mutex );
+        state->jobs.push_back( write_job{ path, std::string(), false, std::string(), true, -1 } );
+        state->pending.insert( path );
+    }
+    state->wake.notify_one();
+}
+
+void save_writer::wait_for( const std::string &path )
+{
+    std::unique_lock<std::mutex> lock( state->mutex );
+    state->done.wait( lock, [this, &path]() {
+        return state->pending.count( path ) == 0;
+    } );
+}
+
+bool save_writer::flush()
+{
+    std::unique_lock<std::mutex> lock( state->mutex );
+    state->done.wait( lock, [this]() {
+        return state->pending.empty();
+    } );
+    lock.unlock();
+    return report_errors();
+}
+
+bool save_writer::report_errors()
+{
+    std::vector<write_error> errors;
+    {
+        std::lock_guard<std::mutex> lock( state->mutex );
+        errors.swap( state->errors );
+    }
+    return show_errors( errors );
+}
+
+#else
+
+struct save_writer::shared_state {
+    std::vector<write_error> errors;
+};
+
+save_writer::save_writer() : state( new shared_state() )
+{
+}
+
+save_writer::~save_writer() = default;
+
+void save_writer::write( const std::string &path, std::string data, const bool exclusive,
+                         const std::string &fail_message )
+{
+    const write_job job{ path, std::move( data ), exclusive, fail_message, false };
+    if( const char *const error = write_file( job ) ) {
+        state->errors.push_back( write_error{ path, fail_message, error } );
+    }
+}
+
+void save_writer::write_at( const std::string &path, const long long offset, std::string data,
+                            const std::string &fail_message )
+{
+    const write_job job{ path, std::move( data ), false, fail_message, false, offset };
+    if( const char *const error = write_file( job ) ) {
+        state->errors.push_back( write_error{ path, fail_message, error } );
+    }
+}
+
+void save_writer::remove( const std::string &path )
+{
+    write_file( write_job{ path, std::string(), false, std::string(), true, -1 } );
+}
+
+void save_writer::wait_for( const std::string & )
+{
+}
+
+bool save_writer::flush()
+{
+    return report_errors();
+}
+
+bool save_writer::report_errors()
+{
+    std::vector<write_error> errors;
+    errors.swap( state->errors );
+    return show_errors( errors );
+}
+
+#endif
+
+save_writer &save_writer::get()
+{
+    static save_writer writer;
+    return writer;
+}
@@ -0,0 +1,71 @@
+#ifndef SAVE_WRITER_H
+#define SAVE_WRITER_H
+
+#include <memory>
+#include <string>
+
+/**
+ * Writes save files on a background thread, so the game goes on while an autosave is
+ * written to disk.
+ *
+ * The game thread serializes into memory and hands the result to @ref write. The writer
+ * thread writes it to a temporary file next to the target, syncs that to disk and renames
+ * it over the target. A crash while saving leaves either the old or the new file, never a
+ * partial one.
+ *
+ * Reading a file waits for a pending write to it (see @ref wait_for), so callers don't
+ * need to care whether the data is already on disk. The writer thread can't show errors,
+ * they are shown by @ref flush and @ref report_errors on the game thread.
+ */
+class save_writer
+{
+    public:
+        static save_writer &get();
+
+        save_writer();
+        /** Writes everything that is still queued. */
+        ~save_writer();
+
+        /**
+         * Queues data to be written to the file at path, replacing the file.
+         * @param exclusive Lock the file while writing, like @ref fopen_exclusive does.
+         * @param fail_message Describes the data in the error message if writing fails.
+         */
+        void write( const std::string &path, std::string data, bool exclusive,
+                    const std::string &fail_message );
+
+        /**
+         * Queues writing data into the file at path at the given offset, keeping the rest
+         * of the file. Unlike @ref write, a crash can leave the data partially written.
+         * The file is created if it doesn't exist.
+         */
+        void write_at( const std::string &path, long long offset, std::string data,
+                       const std::string &fail_message );
+
+        /**
+         * Queues removal of the file at path, after the writes queued before. A file that
+         * doesn't exist or can't be removed is ignored.
+         */
+        void remove( const std::string &path );
+
+        /** Returns once no write to the file at path is queued or running. */
+        void wait_for( const std::string &path );
+
+        /**
+         * Returns once all queued writes are done and shows their errors.
+         * @return Whether all writes since the errors were last shown succeeded.
+         */
+        bool flush();
+
+        /**
+         * Shows the errors of the writes that are done, without waiting for the others.
+         * @return Whether there were no errors.
+         */
+        bool report_errors();
+
+    private:
+        struct shared_state;
+        std::unique_ptr<shared_state> state;
+};
+
+#endif
@@ -108,6 +108,10 @@ void game::serialize(std::ostream & fout) {
 
 std::string scent_map::serialize() const
 {
+    static const scent_array<int> no_scent = {{}};
+    const scent_array<int> *current = layer( gm.get_levz() );
+    const scent_array<int> &grscent = current != nullptr ? *current : no_scent;
+
     std::stringstream rle_out;
     int rle_lastval = -1;
     int rle_count = 0;
@@ -254,7 +258,7 @@ void scent_map::deserialize( const std::string &data )
     std::istringstream buffer( data );
     int stmp;
     int count = 0;
-    for( auto &elem : grscent ) {
+    for( auto &elem : get_or_add_layer( gm.get_levz() ) ) {
         for( auto &val : elem ) {
             if( count == 0 ) {
                 buffer >> stmp >> count;
@@ -0,0 +1,282 @@
+#include "scent_diffusion.h"
+
+#include <cassert>
+
+#if (defined __x86_64__ || defined __i386__) && \
+    (defined __clang__ || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+// The vectorized kernels are compiled for their instruction set only and chosen at
+// runtime, so the normal build still runs on any x86 processor.
+#define SCENT_DIFFUSION_X86
+#include <immintrin.h>
+#endif
+
+namespace scent_diffusion
+{
+
+// decrease this to reduce gas spread. Keep it under 125 for
+// stability. This is essentially a decimal number * 1000.
+static constexpr int diffusivity = 100;
+// Tiles diffuse in proportion to their weight, so reduce scent tiles only get 20% of the
+// normal diffusivity.
+static constexpr int diffusivity_per_weight = diffusivity / WEIGHT_NORMAL;
+// Neighbouring walls and reduce scent tiles absorb a fifth of the diffusivity.
+static constexpr int absorption_per_weight = diffusivity_per_weight / 5;
+static_assert( diffusivity_per_weight % 5 == 0, "absorption must be exact" );
+
+static constexpr int scale = 10 * 1000;
+
+// Sums the weighted scent of the tile and its two neighbours in the y direction.
+// This way, each square gets called 3 times instead of 9 times.
+static void sum_column( const int *scent, const int *weight, int *sum, int *used,
+                        int y, const int maxy )
+{
+    for( ; y <= maxy; ++y ) {
+        sum[y] = weight[y - 1] * scent[y - 1] + weight[y] * scent[y] + weight[y + 1] * scent[y + 1];
+        used[y] = weight[y - 1] + weight[y] + weight[y + 1];
+    }
+}
+
+struct column_sums {
+    const int *sum_left;
+    const int *sum_here;
+    const int *sum_right;
+    const int *used_left;
+    const int *used_here;
+    const int *used_right;
+};
+
+static void diffuse_column( int *scent, const int *weight, const column_sums &c,
+                            int y, const int maxy )
+{
+    for( ; y <= maxy; ++y ) {
+        const int this_diffusivity = weight[y] * diffusivity_per_weight;
+        // to how many neighboring squares do we diffuse out? (include our own square
+        // since we also include our own square when diffusing in)
+        const int squares_used = c.used_left[y] + c.used_here[y] + c.used_right[y];
+        const int sum_3_scent = c.sum_left[y] + c.sum_here[y] + c.sum_right[y];
+        // what stays of the old scent after diffusing out and being absorbed
+        const int keep = scale - squares_used * this_diffusivity -
+                         weight[y] * absorption_per_weight * ( 90 - squares_used );
+        const int value = ( scent[y] * keep + this_diffusivity * sum_3_scent ) / scale;
+        // tiles that block scent have none
+        scent[y] = value & -static_cast<int>( weight[y] != WEIGHT_BLOCK );
+    }
+}
+
+#ifdef SCENT_DIFFUSION_X86
+
+// n / 10000 == ( n * div_magic ) >> div_shift for all 0 <= n <= 2^31
+static constexpr unsigned int div_magic = 3518437209u;
+static constexpr int div_shift = 45;
+
+__attribute__( ( target( "sse4.1" ) ) )
+static inline __m128i divide_by_scale( const __m128i n )
+{
+    const __m128i magic = _mm_set1_epi32( static_cast<int>( div_magic ) );
+    const __m128i a = _mm_abs_epi32( n );
+    const __m128i even = _mm_srli_epi64( _mm_mul_epu32( a, magic ), div_shift );
+    const __m128i odd = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), magic );
+    const __m128i odd_shifted = _mm_slli_epi64( _mm_srli_epi64( odd, div_shift ), 32 );
+    // C++ division truncates towards zero, so restore the sign afterwards
+    return _mm_sign_epi32( _mm_blend_epi16( even, odd_shifted, 0xCC ), n );
+}
+
+__attribute__( ( target( "sse4.1" ) ) )
+static void sum_column_sse4_1( const int *scent, const int *weight, int *sum, int *used,
+                               int y, const int maxy )
+{
+    for( ; y + 3 <= maxy; y += 4 ) {
+        const __m128i w_prev = _mm_loadu_si128( reinterpret_cast<const __m128i *>( weight + y - 1 ) );
+        const __m128i w_here = _mm_loadu_si128( reinterpret_cast<const __m128i *>( weight + y ) );
+        const __m128i w_next = _mm_loadu_si128( reinterpret_cast<const __m128i *>( weight + y + 1 ) );
+        const __m128i s_prev = _mm_loadu_si128( reinterpret_cast<const __m128i *>( scent + y - 1 ) );
+        const __m128i s_here = _mm_loadu_si128( reinterpret_cast<const __m128i *>( scent + y ) );
+        const __m128i s_next = _mm_loadu_si128( reinterpret_cast<const __m128i *>( scent + y + 1 ) );
+        const __m128i s = _mm_add_epi32( _mm_add_epi32( _mm_mullo_epi32( w_prev, s_prev ),
+                                         _mm_mullo_epi32( w_here, s_here ) ), _mm_mullo_epi32( w_next, s_next ) );
+        const __m128i u = _mm_add_epi32( _mm_add_epi32( w_prev, w_here ), w_next );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( sum + y ), s );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( used + y ), u );
+    }
+    sum_column( scent, weight, sum, used, y, maxy );
+}
+
+__attribute__( ( target( "sse4.1" ) ) )
+static void diffuse_column_sse4_1( int *scent, const int *weight, const column_sums &c,
+                                   int y, const int maxy )
+{
+    const __m128i v_scale = _mm_set1_epi32( scale );
+    const __m128i v_90 = _mm_set1_epi32( 90 );
+    const __m128i v_diffusivity = _mm_set1_epi32( diffusivity_per_weight );
+    const __m128i v_absorption = _mm_set1_epi32( absorption_per_weight );
+    for( ; y + 3 <= maxy; y += 4 ) {
+#define LOAD( ptr ) _mm_loadu_si128( reinterpret_cast<const __m128i *>( ( ptr ) + y ) )
+        const __m128i w = LOAD( weight );
+        const __m128i squares_used = _mm_add_epi32( _mm_add_epi32( LOAD( c.used_left ),
+                                     LOAD( c.used_here ) ), LOAD( c.used_right ) );
+        const __m128i sum_3_scent = _mm_add_epi32( _mm_add_epi32( LOAD( c.sum_left ),
+                                    LOAD( c.sum_here ) ), LOAD( c.sum_right ) );
+        const __m128i this_diffusivity = _mm_mullo_epi32( w, v_diffusivity );
+        const __m128i absorbed = _mm_mullo_epi32( _mm_mullo_epi32( w, v_absorption ),
+                                 _mm_sub_epi32( v_90, squares_used ) );
+        const __m128i keep = _mm_sub_epi32( _mm_sub_epi32( v_scale,
+                                            _mm_mullo_epi32( squares_used, this_diffusivity ) ), absorbed );
+        const __m128i value = divide_by_scale( _mm_add_epi32( _mm_mullo_epi32( LOAD( scent ), keep ),
+                                               _mm_mullo_epi32( this_diffusivity, sum_3_scent ) ) );
+        const __m128i blocked = _mm_cmpeq_epi32( w, _mm_setzero_si128() );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( scent + y ), _mm_andnot_si128( blocked, value ) );
+#undef LOAD
+    }
+    diffuse_column( scent, weight, c, y, maxy );
+}
+
+__attribute__( ( target( "avx2" ) ) )
+static inline __m256i divide_by_scale( const __m256i n )
+{
+    const __m256i magic = _mm256_set1_epi32( static_cast<int>( div_magic ) );
+    const __m256i a = _mm256_abs_epi32( n );
+    const __m256i even = _mm256_srli_epi64( _mm256_mul_epu32( a, magic ), div_shift );
+    const __m256i odd = _mm256_mul_epu32( _mm256_srli_epi64( a, 32 ), magic );
+    const __m256i odd_shifted = _mm256_slli_epi64( _mm256_srli_epi64( odd, div_shift ), 32 );
+    return _mm256_sign_epi32( _mm256_blend_epi32( even, odd_shifted, 0xAA ), n );
+}
+
+__attribute__( ( target( "avx2" ) ) )
+static void sum_column_avx2( const int *scent, const int *weight, int *sum, int *used,
+                             int y, const int maxy )
+{
+    for( ; y + 7 <= maxy; y += 8 ) {
+        const __m256i w_prev = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( weight + y - 1 ) );
+        const __m256i w_here = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( weight + y ) );
+        const __m256i w_next = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( weight + y + 1 ) );
+        const __m256i s_prev = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( scent + y - 1 ) );
+        const __m256i s_here = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( scent + y ) );
+        const __m256i s_next = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( scent + y + 1 ) );
+        const __m256i s = _mm256_add_epi32( _mm256_add_epi32( _mm256_mullo_epi32( w_prev, s_prev ),
+                                            _mm256_mullo_epi32( w_here, s_here ) ), _mm256_mullo_epi32( w_next, s_next ) );
+        const __m256i u = _mm256_add_epi32( _mm256_add_epi32( w_prev, w_here ), w_next );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( sum + y ), s );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( used + y ), u );
+    }
+    sum_column( scent, weight, sum, used, y, maxy );
+}
+
+__attribute__( ( target( "avx2" ) ) )
+static void diffuse_column_avx2( int *scent, const int *weight, const column_sums &c,
+                                 int y, const int maxy )
+{
+    const __m256i v_scale = _mm256_set1_epi32( scale );
+    const __m256i v_90 = _mm256_set1_epi32( 90 );
+    const __m256i v_diffusivity = _mm256_set1_epi32( diffusivity_per_weight );
+    const __m256i v_absorption = _mm256_set1_epi32( absorption_per_weight );
+    for( ; y + 7 <= maxy; y += 8 ) {
+#define LOAD( ptr ) _mm256_loadu_si256( reinterpret_cast<const __m256i *>( ( ptr ) + y ) )
+        const __m256i w = LOAD( weight );
+        const __m256i squares_used = _mm256_add_epi32( _mm256_add_epi32( LOAD( c.used_left ),
+                                     LOAD( c.used_here ) ), LOAD( c.used_right ) );
+        const __m256i sum_3_scent = _mm256_add_epi32( _mm256_add_epi32( LOAD( c.sum_left ),
+                                    LOAD( c.sum_here ) ), LOAD( c.sum_right ) );
+        const __m256i this_diffusivity = _mm256_mullo_epi32( w, v_diffusivity );
+        const __m256i absorbed = _mm256_mullo_epi32( _mm256_mullo_epi32( w, v_absorption ),
+                                 _mm256_sub_epi32( v_90, squares_used ) );
+        const __m256i keep = _mm256_sub_epi32( _mm256_sub_epi32( v_scale,
+                                               _mm256_mullo_epi32( squares_used, this_diffusivity ) ), absorbed );
+        const __m256i value = divide_by_scale( _mm256_add_epi32( _mm256_mullo_epi32( LOAD( scent ), keep ),
+                                               _mm256_mullo_epi32( this_diffusivity, sum_3_scent ) ) );
+        const __m256i blocked = _mm256_cmpeq_epi32( w, _mm256_setzero_si256() );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( scent + y ),
+                             _mm256_andnot_si256( blocked, value ) );
+#undef LOAD
+    }
+    diffuse_column( scent, weight, c, y, maxy );
+}
+
+#endif // SCENT_DIFFUSION_X86
+
+bool supported( const kernel k )
+{
+    switch( k ) {
+        case kernel::scalar:
+            return true;
+#ifdef SCENT_DIFFUSION_X86
+        case kernel::sse4_1:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports( "sse4.1" );
+        case kernel::avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports( "avx2" );
+#endif
+        default:
+            return false;
+    }
+}
+
+kernel best()
+{
+    static const kernel fastest = supported( kernel::avx2 ) ? kernel::avx2 :
+                                  supported( kernel::sse4_1 ) ? kernel::sse4_1 : kernel::scalar;
+    return fastest;
+}
+
+const char *name( const kernel k )
+{
+    switch( k ) {
+        case kernel::scalar:
+            return "scalar";
+        case kernel::sse4_1:
+            return "SSE4.1";
+        case kernel::avx2:
+            return "AVX2";
+    }
+    return "unknown";
+}
+
+void diffuse( grid &scent, const grid &weights, const int minx, const int miny,
+              const int maxx, const int maxy )
+{
+    diffuse( scent, weights, minx, miny, maxx, maxy, best() );
+}
+
+void diffuse( grid &scent, const grid &weights, const int minx, const int miny,
+              const int maxx, const int maxy, const kernel k )
+{
+    assert( minx >= 1 && miny >= 1 );
+    assert( maxx + 1 < static_cast<int>( scent.size() ) );
+    assert( maxy + 1 < static_cast<int>( scent[0].size() ) );
+    assert( supported( k ) );
+
+    auto sum_func = &sum_column;
+    auto diffuse_func = &diffuse_column;
+#ifdef SCENT_DIFFUSION_X86
+    if( k == kernel::avx2 ) {
+        sum_func = &sum_column_avx2;
+        diffuse_func = &diffuse_column_avx2;
+    } else if( k == kernel::sse4_1 ) {
+        sum_func = &sum_column_sse4_1;
+        diffuse_func = &diffuse_column_sse4_1;
+    }
+#else
+    ( void )k;
+#endif
+
+    // Weighted scent and weights of each tile and its y neighbours. Only needed for columns
+    // [minx - 1, maxx + 1] and rows [miny, maxy].
+    grid sum_3_scent_y;
+    grid squares_used_y;
+    for( int x = minx - 1; x <= maxx + 1; ++x ) {
+        sum_func( scent[x].data(), weights[x].data(), sum_3_scent_y[x].data(),
+                  squares_used_y[x].data(), miny, maxy );
+    }
+
+    // The scent of a tile only depends on its own old value and the sums, so it can be
+    // updated in place.
+    for( int x = minx; x <= maxx; ++x ) {
+        const column_sums c = {
+            sum_3_scent_y[x - 1].data(), sum_3_scent_y[x].data(), sum_3_scent_y[x + 1].data(),
+            squares_used_y[x - 1].data(), squares_used_y[x].data(), squares_used_y[x + 1].data()
+        };
+        diffuse_func( scent[x].data(), weights[x].data(), c, miny, maxy );
+    }
+}
+
+}
@@ -0,0 +1,51 @@
+#ifndef SCENT_DIFFUSION_H
+#define SCENT_DIFFUSION_H
+
+#include "game_constants.h"
+
+#include <array>
+
+/**
+ * The diffusion step of the @ref scent_map, a weighted 3x3 box blur.
+ *
+ * Instead of checking terrain flags per tile, every tile has a weight: 0 for tiles that
+ * block scent, 2 for tiles that reduce scent and 10 for everything else. That way all
+ * tiles are handled the same and the loops can be vectorized. The result is exactly the
+ * same for every implementation.
+ */
+namespace scent_diffusion
+{
+
+using grid = std::array<std::array<int, SEEY *MAPSIZE>, SEEX *MAPSIZE>;
+
+/** Weights of tiles, see the namespace description. */
+enum tile_weight : int {
+    WEIGHT_BLOCK = 0,
+    WEIGHT_REDUCE = 2,
+    WEIGHT_NORMAL = 10,
+};
+
+enum class kernel : int {
+    scalar,
+    sse4_1,
+    avx2,
+};
+
+/** Whether the given kernel was compiled in and the processor supports it. */
+bool supported( kernel k );
+/** The fastest supported kernel. */
+kernel best();
+const char *name( kernel k );
+
+/**
+ * Diffuses the scent inside the rectangle [minx, maxx] x [miny, maxy] by one step.
+ * Both grids are read one tile beyond the rectangle on each side, that area is not changed.
+ */
+void diffuse( grid &scent, const grid &weights, int minx, int miny, int maxx, int maxy );
+/** Same as above, but uses the given kernel, which must be supported. */
+void diffuse( grid &scent, const grid &weights, int minx, int miny, int maxx, int maxy,
+              kernel k );
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "map.h"
 #include "output.h"
 #include "game.h"
+#include "scent_diffusion.h"
 
 #include <cassert>
 #include <cmath>
@@ -40,20 +41,37 @@ nc_color sev( const size_t level )
     return level < colors.size() ? colors[level] : c_dkgray;
 }
 
+scent_map::scent_array<int> &scent_map::get_or_add_layer( const int z )
+{
+    auto &l = layers[z + OVERMAP_DEPTH];
+    if( !l ) {
+        l.reset( new scent_array<int>() );
+    }
+    return *l;
+}
+
 void scent_map::reset()
 {
-    for( auto &elem : grscent ) {
-        for( auto &val : elem ) {
-            val = 0;
-        }
+    for( auto &l : layers ) {
+        l.reset();
     }
 }
 
 void scent_map::decay()
 {
-    for( auto &elem : grscent ) {
-        for( auto &val : elem ) {
-            val = std::max( 0, val - 1 );
+    for( auto &l : layers ) {
+        if( !l ) {
+            continue;
+        }
+        bool has_scent = false;
+        for( auto &elem : *l ) {
+            for( auto &val : elem ) {
+                val = std::max( 0, val - 1 );
+                has_scent |= val > 0;
+            }
+        }
+        if( !has_scent ) {
+            l.reset();
         }
     }
 }
@@ -78,40 +96,42 @@ static bool in_bounds( int x, int y )
 
 void scent_map::shift( const int sm_shift_x, const int sm_shift_y )
 {
-    scent_array<int> new_scent;
-    for( size_t x = 0; x < SEEX * MAPSIZE; ++x ) {
-        for( size_t y = 0; y < SEEY * MAPSIZE; ++y ) {
-            new_scent[x][y] = in_bounds( x + sm_shift_x, y + sm_shift_y ) ?
-                              grscent[ x + sm_shift_x ][ y + sm_shift_y ] :
-                              0;
+    for( auto &l : layers ) {
+        if( !l ) {
+            continue;
         }
+        auto &grscent = *l;
+        scent_array<int> new_scent;
+        for( size_t x = 0; x < SEEX * MAPSIZE; ++x ) {
+            for( size_t y = 0; y < SEEY * MAPSIZE; ++y ) {
+                new_scent[x][y] = in_bounds( x + sm_shift_x, y + sm_shift_y ) ?
+                                  grscent[ x + sm_shift_x ][ y + sm_shift_y ] :
+                                  0;
+            }
+        }
+        grscent = new_scent;
     }
-    grscent = new_scent;
 }
 
 int scent_map::get( const tripoint &p ) const
 {
-    if( inbounds( p ) && grscent[p.x][p.y] > 0 ) {
-        return grscent[p.x][p.y] - std::abs( gm.get_levz() - p.z );
+    if( !inbounds( p ) ) {
+        return 0;
     }
-    return 0;
+    const scent_array<int> *l = layer( p.z );
+    return l != nullptr ? std::max( 0, ( *l )[p.x][p.y] ) : 0;
 }
 
 void scent_map::set( const tripoint &p, int value )
 {
-    if( inbounds( p ) ) {
-        grscent[p.x][p.y] = value;
+    if( inbounds( p ) && ( value != 0 || layer( p.z ) != nullptr ) ) {
+        get_or_add_layer( p.z )[p.x][p.y] = value;
     }
 }
 
 bool scent_map::inbounds( const tripoint &p ) const
 {
-    // This weird long check here is a hack around the fact that scentmap is 2D
-    // A z-level can access scentmap if it is within 1 flying z-level move from player's z-level
-    // That is, if a flying critter could move directly up or down (or stand still) and be on same z-level as player
-    return p.x >= 0 && p.x < SEEX * MAPSIZE && p.y >= 0 && p.y < SEEY * MAPSIZE &&
-           ( p.z == gm.get_levz() || ( std::abs( p.z - gm.get_levz() ) == 1 &&
-                                       gm.m.valid_move( p, tripoint( p.x, p.y, gm.get_levz() ), false, true ) ) );
+    return in_bounds( p.x, p.y ) && p.z >= -OVERMAP_DEPTH && p.z <= OVERMAP_HEIGHT;
 }
 
 void scent_map::update( const tripoint &center, map &m )
@@ -125,92 +145,77 @@ void scent_map::update( const tripoint &center, map &m )
         return;
     }
 
-    // note: the next four intermediate matrices need to be at least
-    // [2*SCENT_RADIUS+3][2*SCENT_RADIUS+1] in size to hold enough data
-    // The code I'm modifying used [SEEX * MAPSIZE]. I'm staying with that to avoid new bugs.
-
-    // These two matrices are transposed so that x addresses are contiguous in memory
-    scent_array<int> sum_3_scent_y;
-    scent_array<int> squares_used_y;
-
-    // these are for caching flag lookups
-    scent_array<bool> blocks_scent; // currently only TFLAG_WALL blocks scent
-    scent_array<bool> reduces_scent;
-
     // for loop constants
     const int scentmap_minx = center.x - SCENT_RADIUS;
     const int scentmap_maxx = center.x + SCENT_RADIUS;
     const int scentmap_miny = center.y - SCENT_RADIUS;
     const int scentmap_maxy = center.y + SCENT_RADIUS;
+    // Without z-levels, only the current one is loaded
+    const int minz = m.has_zlevels() ? -OVERMAP_DEPTH : center.z;
+    const int maxz = m.has_zlevels() ? OVERMAP_HEIGHT : center.z;
 
-    // decrease this to reduce gas spread. Keep it under 125 for
-    // stability. This is essentially a decimal number * 1000.
-    const int diffusivity = 100;
-
-    // The new scent flag searching function. Should be wayyy faster than the old one.
-    m.scent_blockers( blocks_scent, reduces_scent, scentmap_minx - 1, scentmap_miny - 1,
-                      scentmap_maxx + 1, scentmap_maxy + 1 );
-    // Sum neighbors in the y direction.  This way, each square gets called 3 times instead of 9
-    // times. This cost us an extra loop here, but it also eliminated a loop at the end, so there
-    // is a net performance improvement over the old code. Could probably still be better.
-    // note: this method needs an array that is one square larger on each side in the x direction
-    // than the final scent matrix. I think this is fine since SCENT_RADIUS is less than
-    // SEEX*MAPSIZE, but if that changes, this may need tweaking.
-    for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
-        for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
-            // remember the sum of the scent val for the 3 neighboring squares that can defuse into
-            sum_3_scent_y[y][x] = 0;
-            squares_used_y[y][x] = 0;
-            for( int i = y - 1; i <= y + 1; ++i ) {
-                if( !blocks_scent[x][i] ) {
-                    if( reduces_scent[x][i] ) {
-                        // only 20% of scent can diffuse on REDUCE_SCENT squares
-                        sum_3_scent_y[y][x] += 2 * grscent[x][i];
-                        squares_used_y[y][x] += 2;
-                    } else {
-                        sum_3_scent_y[y][x] += 10 * grscent[x][i];
-                        squares_used_y[y][x] += 10;
-                    }
-                }
+    // these are for caching flag lookups
+    scent_array<bool> blocks_scent; // currently only TFLAG_WALL blocks scent
+    scent_array<bool> reduces_scent;
+    scent_diffusion::grid weights;
+
+    for( int z = minz; z <= maxz; ++z ) {
+        scent_array<int> *grscent = layer( z );
+        if( grscent == nullptr ) {
+            continue;
+        }
+
+        // The new scent flag searching function. Should be wayyy faster than the old one.
+        m.scent_blockers( blocks_scent, reduces_scent, scentmap_minx - 1, scentmap_miny - 1,
+                          scentmap_maxx + 1, scentmap_maxy + 1, z );
+
+        // Turn the flags into weights, so the diffusion itself doesn't need to branch on them.
+        // only 20% of scent can diffuse on REDUCE_SCENT squares
+        for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
+            for( int y = scentmap_miny - 1; y <= scentmap_maxy + 1; ++y ) {
+                weights[x][y] = blocks_scent[x][y] ? scent_diffusion::WEIGHT_BLOCK :
+                                reduces_scent[x][y] ? scent_diffusion::WEIGHT_REDUCE : scent_diffusion::WEIGHT_NORMAL;
             }
         }
+
+        scent_diffusion::diffuse( *grscent, weights, scentmap_minx, scentmap_miny, scentmap_maxx,
+                                  scentmap_maxy );
+    }
+
+    for( int z = minz; z < maxz; ++z ) {
+        diffuse_vertically( z, m, scentmap_minx, scentmap_miny, scentmap_maxx, scentmap_maxy );
+    }
+}
+
+void scent_map::diffuse_vertically( const int z, map &m, const int minx, const int miny,
+                                    const int maxx, const int maxy )
+{
+    scent_array<int> *below = layer( z );
+    scent_array<int> *above = layer( z + 1 );
+    if( below == nullptr && above == nullptr ) {
+        return;
     }
 
-    // Rest of the scent map
-    for( int x = scentmap_minx; x <= scentmap_maxx; ++x ) {
-        for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
-            auto &scent_here = grscent[x][y];
-            if( !blocks_scent[x][y] ) {
-                // to how many neighboring squares do we diffuse out? (include our own square
-                // since we also include our own square when diffusing in)
-                int squares_used = squares_used_y[y][x - 1]
-                                   + squares_used_y[y][x]
-                                   + squares_used_y[y][x + 1];
-
-                int this_diffusivity;
-                if( !reduces_scent[x][y] ) {
-                    this_diffusivity = diffusivity;
-                } else {
-                    this_diffusivity = diffusivity / 5; //less air movement for REDUCE_SCENT square
-                }
-                int temp_scent;
-                // take the old scent and subtract what diffuses out
-                temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
-                // neighboring walls and reduce_scent squares absorb some scent
-                temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
-                // we've already summed neighboring scent values in the y direction in the previous
-                // loop. Now we do it for the x direction, multiply by diffusion, and this is what
-                // diffuses into our current square.
-                scent_here =
-                    ( temp_scent
-                      + this_diffusivity * ( sum_3_scent_y[y][x - 1]
-                                             + sum_3_scent_y[y][x]
-                                             + sum_3_scent_y[y][x + 1] )
-                    ) / ( 1000 * 10 );
-            } else {
-                // this cell blocks scent
-                scent_here = 0;
+    m.build_floor_cache( z + 1 );
+    const auto &floor_cache = m.get_cache_ref( z + 1 ).floor_cache;
+    for( int x = minx; x <= maxx; ++x ) {
+        for( int y = miny; y <= maxy; ++y ) {
+            if( floor_cache[x][y] ) {
+                continue;
+            }
+            // A quarter of the difference rises up or sinks down
+            const int flow = ( ( below != nullptr ? ( *below )[x][y] : 0 ) -
+                               ( above != nullptr ? ( *above )[x][y] : 0 ) ) / 4;
+            if( flow == 0 ) {
+                continue;
+            }
+            if( below == nullptr ) {
+                below = &get_or_add_layer( z );
+            } else if( above == nullptr ) {
+                above = &get_or_add_layer( z + 1 );
             }
+            ( *below )[x][y] -= flow;
+            ( *above )[x][y] += flow;
         }
     }
 }
@@ -6,17 +6,24 @@
 #include "cursesdef.h"
 
 #include <array>
+#include <memory>
 
 class map;
 class game;
 
+/**
+ * Scent of all z-levels. A z-level only gets its layer allocated once scent is set on
+ * it (or diffuses into it), and loses it again when all of its scent decayed. Scent
+ * diffuses between z-levels where there is no floor (see @ref map::build_floor_cache).
+ */
 class scent_map
 {
     protected:
         template<typename T>
         using scent_array = std::array<std::array<T, SEEY *MAPSIZE>, SEEX *MAPSIZE>;
 
-        scent_array<int> grscent;
+        /** Indexed by z + OVERMAP_DEPTH, null for z-levels without any scent. */
+        std::array<std::unique_ptr<scent_array<int>>, OVERMAP_LAYERS> layers;
         tripoint player_last_position = tripoint_min;
         int player_last_moved = -1;
 
@@ -25,8 +32,11 @@ class scent_map
     public:
         scent_map( const game &g ) : gm( g ) { };
 
+        /** Only the scent on the current z-level of the game is saved. */
+        /**@{*/
         void deserialize( const std::string &data );
         std::string serialize() const;
+        /**@}*/
 
         void draw( WINDOW *w, int div, const tripoint &center ) const;
 
@@ -46,6 +56,15 @@ class scent_map
         /**@}*/
 
         bool inbounds( const tripoint &p ) const;
+
+    private:
+        /** Layer of the z-level if it has any scent, z must be in bounds. */
+        scent_array<int> *layer( int z ) const {
+            return layers[z + OVERMAP_DEPTH].get();
+        }
+        scent_array<int> &get_or_add_layer( int z );
+        /** Moves scent between z-levels z and z + 1 through tiles without floor. */
+        void diffuse_vertically( int z, map &m, int minx, int miny, int maxx, int maxy );
 };
 
 #endif
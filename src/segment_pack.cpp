@@ -0,0 +1,251 @@
+#include "segment_pack.h"
+
+#include "cata_utility.h"
+#include "json.h"
+#include "save_writer.h"
+#include "translations.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#if (defined _WIN32 || defined __WIN32__)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+/** Don't bother compacting small packs */
+const long long min_compact_size = 256 * 1024;
+
+std::string index_path( const std::string &segment_dir )
+{
+    return segment_dir + "/" + segment_packs::index_name;
+}
+
+std::string data_path( const std::string &segment_dir, const int generation )
+{
+    std::ostringstream path;
+    path << segment_dir << "/quads." << generation << ".pack";
+    return path.str();
+}
+
+/** Reads length bytes at offset without moving a file position, if the platform allows. */
+bool read_at( FILE *const file, const long long offset, std::string &data )
+{
+#if (defined _WIN32 || defined __WIN32__)
+    if( _fseeki64( file, offset, SEEK_SET ) != 0 ) {
+        return false;
+    }
+    return fread( &data[0], 1, data.size(), file ) == data.size();
+#else
+    size_t done = 0;
+    while( done < data.size() ) {
+        const ssize_t n = pread( fileno( file ), &data[done], data.size() - done, offset + done );
+        if( n <= 0 ) {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+#endif
+}
+
+} // namespace
+
+const std::string segment_packs::index_name = "quads.json";
+
+segment_packs::~segment_packs()
+{
+    reset();
+}
+
+void segment_packs::reset()
+{
+    for( auto &elem : segments ) {
+        close( elem.second );
+    }
+    segments.clear();
+}
+
+void segment_packs::close( segment &seg )
+{
+    if( seg.data_file != nullptr ) {
+        fclose( seg.data_file );
+        seg.data_file = nullptr;
+    }
+}
+
+segment_packs::segment &segment_packs::get( const std::string &segment_dir )
+{
+    const auto iter = segments.find( segment_dir );
+    if( iter != segments.end() ) {
+        return iter->second;
+    }
+    segment &seg = segments[segment_dir];
+    read_from_file_optional_json( index_path( segment_dir ), [&seg]( JsonIn & jsin ) {
+        jsin.start_object();
+        while( !jsin.end_object() ) {
+            const std::string name = jsin.get_member_name();
+            if( name == "generation" ) {
+                seg.generation = jsin.get_int();
+            } else if( name == "end" ) {
+                seg.end = jsin.get_long();
+            } else if( name == "quads" ) {
+                jsin.start_array();
+                while( !jsin.end_array() ) {
+                    jsin.start_array();
+                    tripoint om_addr;
+                    om_addr.x = jsin.get_int();
+                    om_addr.y = jsin.get_int();
+                    om_addr.z = jsin.get_int();
+                    record &rec = seg.records[om_addr];
+                    rec.binary = jsin.get_bool();
+                    rec.offset = jsin.get_long();
+                    rec.length = jsin.get_long();
+                    seg.live += rec.length;
+                    jsin.end_array();
+                }
+            } else {
+                jsin.skip_value();
+            }
+        }
+    } );
+    return seg;
+}
+
+void segment_packs::write_index( const std::string &segment_dir, segment &seg )
+{
+    seg.index_dirty = false;
+    std::ostringstream fout;
+    JsonOut jsout( fout );
+    jsout.start_object();
+    jsout.member( "generation", seg.generation );
+    jsout.member( "end", static_cast<long>( seg.end ) );
+    jsout.member( "quads" );
+    jsout.start_array();
+    for( auto &elem : seg.records ) {
+        jsout.start_array();
+        jsout.write( elem.first.x );
+        jsout.write( elem.first.y );
+        jsout.write( elem.first.z );
+        jsout.write( elem.second.binary );
+        jsout.write( static_cast<long>( elem.second.offset ) );
+        jsout.write( static_cast<long>( elem.second.length ) );
+        jsout.end_array();
+    }
+    jsout.end_array();
+    jsout.end_object();
+    save_writer::get().write( index_path( segment_dir ), fout.str(), false, _( "map index" ) );
+}
+
+bool segment_packs::read( const std::string &segment_dir, const tripoint &om_addr, bool &binary,
+                          std::string &data )
+{
+    segment &seg = get( segment_dir );
+    const auto iter = seg.records.find( om_addr );
+    if( iter == seg.records.end() ) {
+        return false;
+    }
+    const std::string path = data_path( segment_dir, seg.generation );
+    save_writer::get().wait_for( path );
+    if( seg.data_file == nullptr ) {
+        seg.data_file = fopen( path.c_str(), "rb" );
+        if( seg.data_file == nullptr ) {
+            throw std::runtime_error( "opening " + path + " failed" );
+        }
+    }
+    data.resize( iter->second.length );
+    if( !read_at( seg.data_file, iter->second.offset, data ) ) {
+        throw std::runtime_error( "reading " + path + " failed" );
+    }
+    binary = iter->second.binary;
+    return true;
+}
+
+void segment_packs::write( const std::string &segment_dir, const tripoint &om_addr,
+                           const bool binary, std::string data )
+{
+    segment &seg = get( segment_dir );
+    record &rec = seg.records[om_addr];
+    if( rec.length > 0 ) {
+        seg.live -= rec.length;
+    }
+    rec.offset = seg.end;
+    rec.length = data.size();
+    rec.binary = binary;
+    seg.end += rec.length;
+    seg.live += rec.length;
+    seg.index_dirty = true;
+    save_writer::get().write_at( data_path( segment_dir, seg.generation ), rec.offset,
+                                 std::move( data ), _( "map data" ) );
+
+    if( seg.end >= min_compact_size && seg.live * 2 < seg.end ) {
+        compact( segment_dir, seg );
+    }
+}
+
+void segment_packs::remove( const std::string &segment_dir, const tripoint &om_addr )
+{
+    segment &seg = get( segment_dir );
+    const auto iter = seg.records.find( om_addr );
+    if( iter == seg.records.end() ) {
+        return;
+    }
+    seg.live -= iter->second.length;
+    seg.records.erase( iter );
+    seg.index_dirty = true;
+}
+
+void segment_packs::flush()
+{
+    for( auto &elem : segments ) {
+        if( elem.second.index_dirty ) {
+            write_index( elem.first, elem.second );
+        }
+    }
+}
+
+void segment_packs::compact( const std::string &segment_dir, segment &seg )
+{
+    const std::string old_path = data_path( segment_dir, seg.generation );
+    std::string old_data;
+    read_from_file( old_path, [&old_data]( std::istream & fin ) {
+        std::ostringstream buffer;
+        buffer << fin.rdbuf();
+        old_data = buffer.str();
+    } );
+    if( static_cast<long long>( old_data.size() ) < seg.end ) {
+        // Writing failed, that has been reported. Keep appending to the old file.
+        write_index( segment_dir, seg );
+        return;
+    }
+
+    std::string new_data;
+    new_data.reserve( seg.live );
+    for( auto &elem : seg.records ) {
+        record &rec = elem.second;
+        new_data.append( old_data, rec.offset, rec.length );
+        rec.offset = new_data.size() - rec.length;
+    }
+    close( seg );
+    seg.generation++;
+    seg.end = new_data.size();
+    seg.live = seg.end;
+    // Data file, index, removal of the old data file: the index always points to a complete file
+    save_writer::get().write( data_path( segment_dir, seg.generation ), std::move( new_data ), false,
+                              _( "map data" ) );
+    write_index( segment_dir, seg );
+    save_writer::get().remove( old_path );
+}
+
+std::vector<std::pair<tripoint, bool>> segment_packs::contents( const std::string &segment_dir )
+{
+    std::vector<std::pair<tripoint, bool>> result;
+    for( auto &elem : get( segment_dir ).records ) {
+        result.emplace_back( elem.first, elem.second.binary );
+    }
+    return result;
+}
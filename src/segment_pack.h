@@ -0,0 +1,98 @@
+#ifndef SEGMENT_PACK_H
+#define SEGMENT_PACK_H
+
+#include "enums.h"
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Stores the submap quads of a map segment (32x32 quads, see @ref omt_to_seg_copy) in one
+ * file, instead of one small file per quad.
+ *
+ * The segment directory holds a data file ("quads.<generation>.pack") and an index
+ * ("quads.json"), which maps the quads to their offset and length in the data file.
+ * Saving a quad appends it to the data file, the indices of the changed segments are
+ * rewritten once by @ref flush, at the end of a save. The old copy of the
+ * quad stays in the data file until more than half of it is outdated, then the live
+ * records are copied into the data file of the next generation. The index is replaced
+ * after the data it points to is written, so a crash leaves either the old or the new
+ * index, both pointing to complete data.
+ *
+ * The files are written through @ref save_writer. Reading a quad is a single read at the
+ * offset from the index, which is kept in memory once the segment was accessed.
+ */
+class segment_packs
+{
+    public:
+        /** File name of the index in a segment directory */
+        static const std::string index_name;
+
+        segment_packs() = default;
+        ~segment_packs();
+        segment_packs( const segment_packs & ) = delete;
+        segment_packs &operator=( const segment_packs & ) = delete;
+
+        /**
+         * Reads the quad at om_addr from the pack in the segment directory.
+         * @param binary Set to whether the quad is stored in the binary map format.
+         * @return false if the pack doesn't contain the quad.
+         * @throw std::exception if the pack can't be read.
+         */
+        bool read( const std::string &segment_dir, const tripoint &om_addr, bool &binary,
+                   std::string &data );
+
+        /**
+         * Appends the quad to the pack in the segment directory, replacing the previous copy.
+         * The quad can be read right away, but is only found by other instances after @ref flush.
+         */
+        void write( const std::string &segment_dir, const tripoint &om_addr, bool binary,
+                    std::string data );
+
+        /** Drops the quad from the pack in the segment directory, if it is there. */
+        void remove( const std::string &segment_dir, const tripoint &om_addr );
+
+        /** Writes the indices of the segments changed by @ref write and @ref remove. */
+        void flush();
+
+        /** The quads in the pack in the segment directory, and whether they are binary. */
+        std::vector<std::pair<tripoint, bool>> contents( const std::string &segment_dir );
+
+        /**
+         * Forgets the loaded indices and closes the data files, e.g. before switching worlds.
+         * Changes that were not flushed are lost.
+         */
+        void reset();
+
+    private:
+        struct record {
+            long long offset;
+            long long length;
+            bool binary;
+        };
+        struct segment {
+            /** Part of the name of the data file, increased by compaction */
+            int generation = 0;
+            /** Where the next record goes. Data after it is from an interrupted write. */
+            long long end = 0;
+            /** Bytes of the data file the index still refers to */
+            long long live = 0;
+            std::map<tripoint, record> records;
+            /** Whether the records differ from the index file */
+            bool index_dirty = false;
+            /** Kept open for reading, nullptr until the first read. */
+            FILE *data_file = nullptr;
+        };
+
+        segment &get( const std::string &segment_dir );
+        void write_index( const std::string &segment_dir, segment &seg );
+        void compact( const std::string &segment_dir, segment &seg );
+        void close( segment &seg );
+
+        /** By segment directory, so the segments of different worlds don't mix */
+        std::map<std::string, segment> segments;
+};
+
+#endif
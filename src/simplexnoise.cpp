@@ -17,6 +17,7 @@
 
 
 #include <math.h>
+#include <algorithm>
 
 #include "simplexnoise.h"
 
@@ -50,24 +51,11 @@ all look identical.
 //
 // For each octave, a higher frequency/lower amplitude function will be added to the original.
 // The higher the persistence [0-1], the more of each succeeding octave will be added.
+// Uses the batched version below, see raw_noise_4d.
 float octave_noise_2d( const float octaves, const float persistence, const float scale, const float x, const float y ) {
-    float total = 0;
-    float frequency = scale;
-    float amplitude = 1;
-
-    // We have to keep track of the largest possible amplitude,
-    // because each octave adds more, and we need a value in [-1, 1].
-    float maxAmplitude = 0;
-
-    for( int i=0; i < octaves; i++ ) {
-        total += raw_noise_2d( x * frequency, y * frequency ) * amplitude;
-
-        frequency *= 2;
-        maxAmplitude += amplitude;
-        amplitude *= persistence;
-    }
-
-    return total / maxAmplitude;
+    float result;
+    octave_noise_2d( octaves, persistence, scale, &x, &y, &result, 1 );
+    return result;
 }
 
 
@@ -75,24 +63,11 @@ float octave_noise_2d( const float octaves, const float persistence, const float
 //
 // For each octave, a higher frequency/lower amplitude function will be added to the original.
 // The higher the persistence [0-1], the more of each succeeding octave will be added.
+// Uses the batched version below, see raw_noise_4d.
 float octave_noise_3d( const float octaves, const float persistence, const float scale, const float x, const float y, const float z ) {
-    float total = 0;
-    float frequency = scale;
-    float amplitude = 1;
-
-    // We have to keep track of the largest possible amplitude,
-    // because each octave adds more, and we need a value in [-1, 1].
-    float maxAmplitude = 0;
-
-    for( int i=0; i < octaves; i++ ) {
-        total += raw_noise_3d( x * frequency, y * frequency, z * frequency ) * amplitude;
-
-        frequency *= 2;
-        maxAmplitude += amplitude;
-        amplitude *= persistence;
-    }
-
-    return total / maxAmplitude;
+    float result;
+    octave_noise_3d( octaves, persistence, scale, &x, &y, &z, &result, 1 );
+    return result;
 }
 
 
@@ -100,24 +75,11 @@ float octave_noise_3d( const float octaves, const float persistence, const float
 //
 // For each octave, a higher frequency/lower amplitude function will be added to the original.
 // The higher the persistence [0-1], the more of each succeeding octave will be added.
+// Uses the batched version below, see raw_noise_4d.
 float octave_noise_4d( const float octaves, const float persistence, const float scale, const float x, const float y, const float z, const float w ) {
-    float total = 0;
-    float frequency = scale;
-    float amplitude = 1;
-
-    // We have to keep track of the largest possible amplitude,
-    // because each octave adds more, and we need a value in [-1, 1].
-    float maxAmplitude = 0;
-
-    for( int i=0; i < octaves; i++ ) {
-        total += raw_noise_4d( x * frequency, y * frequency, z * frequency, w * frequency ) * amplitude;
-
-        frequency *= 2;
-        maxAmplitude += amplitude;
-        amplitude *= persistence;
-    }
-
-    return total / maxAmplitude;
+    float result;
+    octave_noise_4d( octaves, persistence, scale, &x, &y, &z, &w, &result, 1 );
+    return result;
 }
 
 
@@ -335,136 +297,263 @@ float raw_noise_3d( const float x, const float y, const float z ) {
 
 
 // 4D raw Simplex noise
+//
+// Uses the batched version below, so the results are the same, even though -ffast-math
+// lets the compiler rearrange the math differently in each copy of the code.
 float raw_noise_4d( const float x, const float y, const float z, const float w ) {
-    // The skewing and unskewing factors are hairy again for the 4D case
-    float F4 = (sqrtf(5.0)-1.0)/4.0;
-    float G4 = (5.0-sqrtf(5.0))/20.0;
-    float n0, n1, n2, n3, n4; // Noise contributions from the five corners
-
-    // Skew the (x,y,z,w) space to determine which cell of 24 simplices we're in
-    float s = (x + y + z + w) * F4; // Factor for 4D skewing
-    int i = fastfloor(x + s);
-    int j = fastfloor(y + s);
-    int k = fastfloor(z + s);
-    int l = fastfloor(w + s);
-    float t = (i + j + k + l) * G4; // Factor for 4D unskewing
-    float X0 = i - t; // Unskew the cell origin back to (x,y,z,w) space
-    float Y0 = j - t;
-    float Z0 = k - t;
-    float W0 = l - t;
-
-    float x0 = x - X0; // The x,y,z,w distances from the cell origin
-    float y0 = y - Y0;
-    float z0 = z - Z0;
-    float w0 = w - W0;
-
-    // For the 4D case, the simplex is a 4D shape I won't even try to describe.
-    // To find out which of the 24 possible simplices we're in, we need to
-    // determine the magnitude ordering of x0, y0, z0 and w0.
-    // The method below is a good way of finding the ordering of x,y,z,w and
-    // then find the correct traversal order for the simplex we're in.
-    // First, six pair-wise comparisons are performed between each possible pair
-    // of the four coordinates, and the results are used to add up binary bits
-    // for an integer index.
-    int c1 = (x0 > y0) ? 32 : 0;
-    int c2 = (x0 > z0) ? 16 : 0;
-    int c3 = (y0 > z0) ? 8 : 0;
-    int c4 = (x0 > w0) ? 4 : 0;
-    int c5 = (y0 > w0) ? 2 : 0;
-    int c6 = (z0 > w0) ? 1 : 0;
-    int c = c1 + c2 + c3 + c4 + c5 + c6;
-
-    int i1, j1, k1, l1; // The integer offsets for the second simplex corner
-    int i2, j2, k2, l2; // The integer offsets for the third simplex corner
-    int i3, j3, k3, l3; // The integer offsets for the fourth simplex corner
-
-    // simplex[c] is a 4-vector with the numbers 0, 1, 2 and 3 in some order.
-    // Many values of c will never occur, since e.g. x>y>z>w makes x<z, y<w and x<w
-    // impossible. Only the 24 indices which have non-zero entries make any sense.
-    // We use a thresholding to set the coordinates in turn from the largest magnitude.
-    // The number 3 in the "simplex" array is at the position of the largest coordinate.
-    i1 = simplex[c][0]>=3 ? 1 : 0;
-    j1 = simplex[c][1]>=3 ? 1 : 0;
-    k1 = simplex[c][2]>=3 ? 1 : 0;
-    l1 = simplex[c][3]>=3 ? 1 : 0;
-    // The number 2 in the "simplex" array is at the second largest coordinate.
-    i2 = simplex[c][0]>=2 ? 1 : 0;
-    j2 = simplex[c][1]>=2 ? 1 : 0;
-    k2 = simplex[c][2]>=2 ? 1 : 0;
-    l2 = simplex[c][3]>=2 ? 1 : 0;
-    // The number 1 in the "simplex" array is at the second smallest coordinate.
-    i3 = simplex[c][0]>=1 ? 1 : 0;
-    j3 = simplex[c][1]>=1 ? 1 : 0;
-    k3 = simplex[c][2]>=1 ? 1 : 0;
-    l3 = simplex[c][3]>=1 ? 1 : 0;
-    // The fifth corner has all coordinate offsets = 1, so no need to look that up.
-
-    float x1 = x0 - i1 + G4; // Offsets for second corner in (x,y,z,w) coords
-    float y1 = y0 - j1 + G4;
-    float z1 = z0 - k1 + G4;
-    float w1 = w0 - l1 + G4;
-    float x2 = x0 - i2 + 2.0*G4; // Offsets for third corner in (x,y,z,w) coords
-    float y2 = y0 - j2 + 2.0*G4;
-    float z2 = z0 - k2 + 2.0*G4;
-    float w2 = w0 - l2 + 2.0*G4;
-    float x3 = x0 - i3 + 3.0*G4; // Offsets for fourth corner in (x,y,z,w) coords
-    float y3 = y0 - j3 + 3.0*G4;
-    float z3 = z0 - k3 + 3.0*G4;
-    float w3 = w0 - l3 + 3.0*G4;
-    float x4 = x0 - 1.0 + 4.0*G4; // Offsets for last corner in (x,y,z,w) coords
-    float y4 = y0 - 1.0 + 4.0*G4;
-    float z4 = z0 - 1.0 + 4.0*G4;
-    float w4 = w0 - 1.0 + 4.0*G4;
-
-    // Work out the hashed gradient indices of the five simplex corners
-    int ii = i & 255;
-    int jj = j & 255;
-    int kk = k & 255;
-    int ll = l & 255;
-    int gi0 = perm[ii+perm[jj+perm[kk+perm[ll]]]] % 32;
-    int gi1 = perm[ii+i1+perm[jj+j1+perm[kk+k1+perm[ll+l1]]]] % 32;
-    int gi2 = perm[ii+i2+perm[jj+j2+perm[kk+k2+perm[ll+l2]]]] % 32;
-    int gi3 = perm[ii+i3+perm[jj+j3+perm[kk+k3+perm[ll+l3]]]] % 32;
-    int gi4 = perm[ii+1+perm[jj+1+perm[kk+1+perm[ll+1]]]] % 32;
-
-    // Calculate the contribution from the five corners
-    float t0 = 0.6 - x0*x0 - y0*y0 - z0*z0 - w0*w0;
-    if(t0<0) n0 = 0.0;
-    else {
-        t0 *= t0;
-        n0 = t0 * t0 * dot(grad4[gi0], x0, y0, z0, w0);
+    float result;
+    raw_noise_4d( &x, &y, &z, &w, &result, 1 );
+    return result;
+}
+
+
+// The number of points the batched functions work on at a time, sized for the stack.
+static const size_t batch_size = 64;
+
+
+// Batched Multi-octave Simplex noise, one octave of all points at a time.
+//
+// For each octave, a higher frequency/lower amplitude function will be added to the original.
+// The higher the persistence [0-1], the more of each succeeding octave will be added.
+void octave_noise_2d( const float octaves, const float persistence, const float scale, const float *x, const float *y, float *out, const size_t count ) {
+    float xf[batch_size], yf[batch_size], noise[batch_size];
+    for( size_t start = 0; start < count; start += batch_size ) {
+        const size_t n = std::min( batch_size, count - start );
+        float *total = out + start;
+        std::fill( total, total + n, 0.0f );
+        float frequency = scale;
+        float amplitude = 1;
+        float maxAmplitude = 0;
+
+        for( int i=0; i < octaves; i++ ) {
+            for( size_t p = 0; p < n; p++ ) {
+                xf[p] = x[start + p] * frequency;
+                yf[p] = y[start + p] * frequency;
+            }
+            raw_noise_2d( xf, yf, noise, n );
+            for( size_t p = 0; p < n; p++ ) {
+                total[p] += noise[p] * amplitude;
+            }
+
+            frequency *= 2;
+            maxAmplitude += amplitude;
+            amplitude *= persistence;
+        }
+
+        for( size_t p = 0; p < n; p++ ) {
+            total[p] = total[p] / maxAmplitude;
+        }
     }
+}
 
-    float t1 = 0.6 - x1*x1 - y1*y1 - z1*z1 - w1*w1;
-    if(t1<0) n1 = 0.0;
-    else {
-        t1 *= t1;
-        n1 = t1 * t1 * dot(grad4[gi1], x1, y1, z1, w1);
+
+void octave_noise_3d( const float octaves, const float persistence, const float scale, const float *x, const float *y, const float *z, float *out, const size_t count ) {
+    float xf[batch_size], yf[batch_size], zf[batch_size], noise[batch_size];
+    for( size_t start = 0; start < count; start += batch_size ) {
+        const size_t n = std::min( batch_size, count - start );
+        float *total = out + start;
+        std::fill( total, total + n, 0.0f );
+        float frequency = scale;
+        float amplitude = 1;
+        float maxAmplitude = 0;
+
+        for( int i=0; i < octaves; i++ ) {
+            for( size_t p = 0; p < n; p++ ) {
+                xf[p] = x[start + p] * frequency;
+                yf[p] = y[start + p] * frequency;
+                zf[p] = z[start + p] * frequency;
+            }
+            raw_noise_3d( xf, yf, zf, noise, n );
+            for( size_t p = 0; p < n; p++ ) {
+                total[p] += noise[p] * amplitude;
+            }
+
+            frequency *= 2;
+            maxAmplitude += amplitude;
+            amplitude *= persistence;
+        }
+
+        for( size_t p = 0; p < n; p++ ) {
+            total[p] = total[p] / maxAmplitude;
+        }
     }
+}
 
-    float t2 = 0.6 - x2*x2 - y2*y2 - z2*z2 - w2*w2;
-    if(t2<0) n2 = 0.0;
-    else {
-        t2 *= t2;
-        n2 = t2 * t2 * dot(grad4[gi2], x2, y2, z2, w2);
+
+void octave_noise_4d( const float octaves, const float persistence, const float scale, const float *x, const float *y, const float *z, const float *w, float *out, const size_t count ) {
+    float xf[batch_size], yf[batch_size], zf[batch_size], wf[batch_size], noise[batch_size];
+    for( size_t start = 0; start < count; start += batch_size ) {
+        const size_t n = std::min( batch_size, count - start );
+        float *total = out + start;
+        std::fill( total, total + n, 0.0f );
+        float frequency = scale;
+        float amplitude = 1;
+        float maxAmplitude = 0;
+
+        for( int i=0; i < octaves; i++ ) {
+            for( size_t p = 0; p < n; p++ ) {
+                xf[p] = x[start + p] * frequency;
+                yf[p] = y[start + p] * frequency;
+                zf[p] = z[start + p] * frequency;
+                wf[p] = w[start + p] * frequency;
+            }
+            raw_noise_4d( xf, yf, zf, wf, noise, n );
+            for( size_t p = 0; p < n; p++ ) {
+                total[p] += noise[p] * amplitude;
+            }
+
+            frequency *= 2;
+            maxAmplitude += amplitude;
+            amplitude *= persistence;
+        }
+
+        for( size_t p = 0; p < n; p++ ) {
+            total[p] = total[p] / maxAmplitude;
+        }
     }
+}
 
-    float t3 = 0.6 - x3*x3 - y3*y3 - z3*z3 - w3*w3;
-    if(t3<0) n3 = 0.0;
-    else {
-        t3 *= t3;
-        n3 = t3 * t3 * dot(grad4[gi3], x3, y3, z3, w3);
+
+// Batched 2D and 3D raw Simplex noise, point by point.
+void raw_noise_2d( const float *x, const float *y, float *out, const size_t count ) {
+    for( size_t p = 0; p < count; p++ ) {
+        out[p] = raw_noise_2d( x[p], y[p] );
     }
+}
 
-    float t4 = 0.6 - x4*x4 - y4*y4 - z4*z4 - w4*w4;
-    if(t4<0) n4 = 0.0;
-    else {
-        t4 *= t4;
-        n4 = t4 * t4 * dot(grad4[gi4], x4, y4, z4, w4);
+
+void raw_noise_3d( const float *x, const float *y, const float *z, float *out, const size_t count ) {
+    for( size_t p = 0; p < count; p++ ) {
+        out[p] = raw_noise_3d( x[p], y[p], z[p] );
     }
+}
+
 
-    // Sum up and scale the result to cover the range [-1,1]
-    return 27.0 * (n0 + n1 + n2 + n3 + n4);
+// Batched 4D raw Simplex noise.
+//
+// Each batch of points goes through three loops: finding the cells, looking up the
+// simplices and gradients, and adding up the corner contributions. The first and the
+// last loop are free of table lookups and branches, so the compiler can vectorize them.
+// This is the only implementation of 4D noise, the single point raw_noise_4d calls it too.
+void raw_noise_4d( const float *x, const float *y, const float *z, const float *w, float *out, const size_t count ) {
+    float F4 = (sqrtf(5.0)-1.0)/4.0;
+    float G4 = (5.0-sqrtf(5.0))/20.0;
+
+    // The cell of each point, and the distances from its origin
+    int cell[4][batch_size];
+    float dist[4][batch_size];
+    // The integer offsets for the second, third and fourth simplex corner
+    int offset[3][4][batch_size];
+    // The gradients at the five simplex corners
+    int gradient[5][4][batch_size];
+
+    for( size_t start = 0; start < count; start += batch_size ) {
+        const size_t n = std::min( batch_size, count - start );
+        const float *px = x + start;
+        const float *py = y + start;
+        const float *pz = z + start;
+        const float *pw = w + start;
+
+        for( size_t p = 0; p < n; p++ ) {
+            float s = (px[p] + py[p] + pz[p] + pw[p]) * F4;
+            int i = fastfloor(px[p] + s);
+            int j = fastfloor(py[p] + s);
+            int k = fastfloor(pz[p] + s);
+            int l = fastfloor(pw[p] + s);
+            float t = (i + j + k + l) * G4;
+            float X0 = i - t;
+            float Y0 = j - t;
+            float Z0 = k - t;
+            float W0 = l - t;
+            cell[0][p] = i;
+            cell[1][p] = j;
+            cell[2][p] = k;
+            cell[3][p] = l;
+            dist[0][p] = px[p] - X0;
+            dist[1][p] = py[p] - Y0;
+            dist[2][p] = pz[p] - Z0;
+            dist[3][p] = pw[p] - W0;
+        }
+
+        for( size_t p = 0; p < n; p++ ) {
+            const float x0 = dist[0][p];
+            const float y0 = dist[1][p];
+            const float z0 = dist[2][p];
+            const float w0 = dist[3][p];
+            int c1 = (x0 > y0) ? 32 : 0;
+            int c2 = (x0 > z0) ? 16 : 0;
+            int c3 = (y0 > z0) ? 8 : 0;
+            int c4 = (x0 > w0) ? 4 : 0;
+            int c5 = (y0 > w0) ? 2 : 0;
+            int c6 = (z0 > w0) ? 1 : 0;
+            int c = c1 + c2 + c3 + c4 + c5 + c6;
+
+            // Corner 0 has no offset, corner 4 an offset of 1 in every coordinate.
+            int corner_offset[5][4];
+            for( int d = 0; d < 4; d++ ) {
+                corner_offset[0][d] = 0;
+                corner_offset[4][d] = 1;
+                for( int corner = 1; corner < 4; corner++ ) {
+                    corner_offset[corner][d] = simplex[c][d] >= 4 - corner ? 1 : 0;
+                    offset[corner - 1][d][p] = corner_offset[corner][d];
+                }
+            }
+
+            int ii = cell[0][p] & 255;
+            int jj = cell[1][p] & 255;
+            int kk = cell[2][p] & 255;
+            int ll = cell[3][p] & 255;
+            for( int corner = 0; corner < 5; corner++ ) {
+                const int *o = corner_offset[corner];
+                int gi = perm[ii+o[0]+perm[jj+o[1]+perm[kk+o[2]+perm[ll+o[3]]]]] % 32;
+                for( int d = 0; d < 4; d++ ) {
+                    gradient[corner][d][p] = grad4[gi][d];
+                }
+            }
+        }
+
+        for( size_t p = 0; p < n; p++ ) {
+            float x0 = dist[0][p];
+            float y0 = dist[1][p];
+            float z0 = dist[2][p];
+            float w0 = dist[3][p];
+
+            float x1 = x0 - offset[0][0][p] + G4;
+            float y1 = y0 - offset[0][1][p] + G4;
+            float z1 = z0 - offset[0][2][p] + G4;
+            float w1 = w0 - offset[0][3][p] + G4;
+            float x2 = x0 - offset[1][0][p] + 2.0*G4;
+            float y2 = y0 - offset[1][1][p] + 2.0*G4;
+            float z2 = z0 - offset[1][2][p] + 2.0*G4;
+            float w2 = w0 - offset[1][3][p] + 2.0*G4;
+            float x3 = x0 - offset[2][0][p] + 3.0*G4;
+            float y3 = y0 - offset[2][1][p] + 3.0*G4;
+            float z3 = z0 - offset[2][2][p] + 3.0*G4;
+            float w3 = w0 - offset[2][3][p] + 3.0*G4;
+            float x4 = x0 - 1.0 + 4.0*G4;
+            float y4 = y0 - 1.0 + 4.0*G4;
+            float z4 = z0 - 1.0 + 4.0*G4;
+            float w4 = w0 - 1.0 + 4.0*G4;
+
+            float t0 = 0.6 - x0*x0 - y0*y0 - z0*z0 - w0*w0;
+            float t1 = 0.6 - x1*x1 - y1*y1 - z1*z1 - w1*w1;
+            float t2 = 0.6 - x2*x2 - y2*y2 - z2*z2 - w2*w2;
+            float t3 = 0.6 - x3*x3 - y3*y3 - z3*z3 - w3*w3;
+            float t4 = 0.6 - x4*x4 - y4*y4 - z4*z4 - w4*w4;
+            float s0 = t0 * t0;
+            float s1 = t1 * t1;
+            float s2 = t2 * t2;
+            float s3 = t3 * t3;
+            float s4 = t4 * t4;
+            float n0 = t0 < 0 ? 0.0f : s0 * s0 * (gradient[0][0][p]*x0 + gradient[0][1][p]*y0 + gradient[0][2][p]*z0 + gradient[0][3][p]*w0);
+            float n1 = t1 < 0 ? 0.0f : s1 * s1 * (gradient[1][0][p]*x1 + gradient[1][1][p]*y1 + gradient[1][2][p]*z1 + gradient[1][3][p]*w1);
+            float n2 = t2 < 0 ? 0.0f : s2 * s2 * (gradient[2][0][p]*x2 + gradient[2][1][p]*y2 + gradient[2][2][p]*z2 + gradient[2][3][p]*w2);
+            float n3 = t3 < 0 ? 0.0f : s3 * s3 * (gradient[3][0][p]*x3 + gradient[3][1][p]*y3 + gradient[3][2][p]*z3 + gradient[3][3][p]*w3);
+            float n4 = t4 < 0 ? 0.0f : s4 * s4 * (gradient[4][0][p]*x4 + gradient[4][1][p]*y4 + gradient[4][2][p]*z4 + gradient[4][3][p]*w4);
+
+            out[start + p] = 27.0 * (n0 + n1 + n2 + n3 + n4);
+        }
+    }
 }
 
 
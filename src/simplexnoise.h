@@ -19,6 +19,7 @@
 #ifndef SIMPLEX_H
 #define SIMPLEX_H
 
+#include <cstddef>
 
 /* 2D, 3D and 4D Simplex Noise functions return 'random' values in (-1, 1).
 
@@ -120,6 +121,41 @@ float raw_noise_3d(const float x, const float y, const float z);
 float raw_noise_4d(const float x, const float y, const float, const float w);
 
 
+// Batched Simplex noise - the noise values of many points at once.
+// The coordinates of the nth point are x[n], y[n] (and so on), its value is written to
+// out[n]. The single point functions use these, so the values are the same, except for
+// the last bits where an optimizer vectorizes the loops (-O3 with -ffast-math).
+void octave_noise_2d(const float octaves,
+                    const float persistence,
+                    const float scale,
+                    const float *x,
+                    const float *y,
+                    float *out,
+                    const size_t count);
+void octave_noise_3d(const float octaves,
+                    const float persistence,
+                    const float scale,
+                    const float *x,
+                    const float *y,
+                    const float *z,
+                    float *out,
+                    const size_t count);
+void octave_noise_4d(const float octaves,
+                    const float persistence,
+                    const float scale,
+                    const float *x,
+                    const float *y,
+                    const float *z,
+                    const float *w,
+                    float *out,
+                    const size_t count);
+
+void raw_noise_2d(const float *x, const float *y, float *out, const size_t count);
+void raw_noise_3d(const float *x, const float *y, const float *z, float *out, const size_t count);
+void raw_noise_4d(const float *x, const float *y, const float *z, const float *w, float *out,
+                  const size_t count);
+
+
 int fastfloor(const float x);
 
 float dot(const int* g, const float x, const float y);
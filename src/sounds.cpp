@@ -1,6 +1,7 @@
 #include "sounds.h"
 
 #include "coordinate_conversions.h"
+#include "creature_tracker.h"
 #include "game.h"
 #include "map.h"
 #include "debug.h"
@@ -206,14 +207,13 @@ void sounds::process_sounds()
             overmap_buffer.signal_hordes( target, sig_power );
         }
         // Alert all monsters (that can hear) to the sound.
-        for (int i = 0, numz = g->num_zombies(); i < numz; i++) {
-            monster &critter = g->zombie(i);
-            const int dist = rl_dist( source, critter.pos() );
-            if( vol * 2 > dist ) {
-                // Exclude monsters that certainly won't hear the sound
-                critter.hear_sound( source, vol, dist );
-            }
+        // Monsters farther than vol * 2 certainly won't hear it, only visit the submaps in range.
+        if( vol <= 0 ) {
+            continue;
         }
+        g->critter_tracker->for_each_in_radius( source, vol * 2 - 1, [&]( monster & critter ) {
+            critter.hear_sound( source, vol, rl_dist( source, critter.pos() ) );
+        } );
     }
     recent_sounds.clear();
 }
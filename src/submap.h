@@ -51,6 +51,7 @@ struct submap {
 
     void set_trap( const int x, const int y, trap_id trap ) {
         is_uniform = false;
+        mark_dirty();
         trp[x][y] = trap;
     }
 
@@ -60,6 +61,7 @@ struct submap {
 
     void set_furn( const int x, const int y, furn_id furn ) {
         is_uniform = false;
+        mark_dirty();
         frn[x][y] = furn;
     }
 
@@ -69,6 +71,7 @@ struct submap {
 
     void set_ter( const int x, const int y, ter_id terr ) {
         is_uniform = false;
+        mark_dirty();
         ter[x][y] = terr;
     }
 
@@ -78,11 +81,13 @@ struct submap {
 
     void set_radiation( const int x, const int y, const int radiation ) {
         is_uniform = false;
+        mark_dirty();
         rad[x][y] = radiation;
     }
 
     void update_lum_add( item const &i, int const x, int const y ) {
         is_uniform = false;
+        mark_dirty();
         if (i.is_emissive() && lum[x][y] < 255) {
             lum[x][y]++;
         }
@@ -90,6 +95,7 @@ struct submap {
 
     void update_lum_rem( item const &i, int const x, int const y ) {
         is_uniform = false;
+        mark_dirty();
         if (!i.is_emissive()) {
             return;
         } else if (lum[x][y] && lum[x][y] < 255) {
@@ -140,11 +146,13 @@ struct submap {
     // Can be used anytime (prevents code from needing to place sign first.)
     void set_signage( const int x, const int y, std::string s) {
         is_uniform = false;
+        mark_dirty();
         cosmetics[x][y]["SIGNAGE"] = s;
     }
     // Can be used anytime (prevents code from needing to place sign first.)
     void delete_signage( const int x, const int y) {
         is_uniform = false;
+        mark_dirty();
         cosmetics[x][y].erase("SIGNAGE");
     }
 
@@ -167,6 +175,16 @@ struct submap {
 
     int field_count = 0;
     int turn_last_touched = 0;
+    /**
+     * Counts the changes to this submap. The setters above bump it, as do the functions of
+     * @ref map that change the submap in other ways. @ref mapbuffer compares it with
+     * @ref saved_generation and does not write submaps that have not changed.
+     */
+    unsigned int generation = 1;
+    /** The generation that was last written to (or read from) disk. */
+    unsigned int saved_generation = 0;
+    /** The turn_last_touched that was last written to (or read from) disk. */
+    int saved_turn_last_touched = 0;
     int temperature = 0;
     std::vector<spawn_point> spawns;
     /**
@@ -181,6 +199,18 @@ struct submap {
 
     submap();
     ~submap();
+
+    void mark_dirty() {
+        generation++;
+    }
+    bool is_dirty() const {
+        return generation != saved_generation;
+    }
+    /** Called after the submap was written to or read from disk. */
+    void mark_saved() {
+        saved_generation = generation;
+        saved_turn_last_touched = turn_last_touched;
+    }
     // delete vehicles and clear the vehicles vector
     void delete_vehicles();
 };
@@ -246,6 +276,7 @@ public:
         if( ret ) {
             sm->field_count++;
         }
+        sm->mark_dirty();
 
         return ret;
     }
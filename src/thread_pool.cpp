@@ -0,0 +1,189 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+#if (defined _WIN32 || defined WINDOWS) && !defined _MSC_VER && !defined _GLIBCXX_HAS_GTHREADS
+// MinGW without a thread model only has std::thread (through the shim), but no
+// mutexes or condition variables, so everything runs on the calling thread there.
+#define CATA_NO_THREAD_POOL
+#endif
+
+#ifndef CATA_NO_THREAD_POOL
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+namespace
+{
+
+/** Set by scoped_thread_pool */
+thread_pool *override_pool = nullptr;
+
+}
+
+scoped_thread_pool::scoped_thread_pool( const size_t workers ) : pool( workers ),
+    previous( override_pool )
+{
+    override_pool = &pool;
+}
+
+scoped_thread_pool::~scoped_thread_pool()
+{
+    override_pool = previous;
+}
+
+#ifndef CATA_NO_THREAD_POOL
+
+struct thread_pool::shared_state {
+    std::vector<std::thread> threads;
+
+    // Set for the duration of a run, so that only one batch of tasks is active at a time
+    std::atomic<bool> running;
+
+    std::mutex mutex;
+    // Signalled when a new batch of tasks is available, or when stopping
+    std::condition_variable wake;
+    // Signalled when the last worker finished its part of the batch
+    std::condition_variable done;
+
+    const std::function<void( size_t )> *task = nullptr;
+    size_t count = 0;
+    std::atomic<size_t> next;
+    // Workers that haven't finished the current batch yet
+    size_t busy = 0;
+    // Incremented for every batch, so that workers don't run one batch twice
+    unsigned int batch = 0;
+    bool stop = false;
+
+    void do_tasks() {
+        for( size_t i = next++; i < count; i = next++ ) {
+            ( *task )( i );
+        }
+    }
+
+    void work() {
+        unsigned int last_batch = 0;
+        std::unique_lock<std::mutex> lock( mutex );
+        while( true ) {
+            wake.wait( lock, [this, last_batch]() {
+                return stop || batch != last_batch;
+            } );
+            if( stop ) {
+                return;
+            }
+            last_batch = batch;
+
+            lock.unlock();
+            do_tasks();
+            lock.lock();
+
+            if( --busy == 0 ) {
+                done.notify_one();
+            }
+        }
+    }
+};
+
+thread_pool::thread_pool( const size_t workers ) : state( new shared_state() )
+{
+    state->next = 0;
+    state->running = false;
+    for( size_t i = 0; i < workers; i++ ) {
+        state->threads.emplace_back( &shared_state::work, state.get() );
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock( state->mutex );
+        state->stop = true;
+    }
+    state->wake.notify_all();
+    for( auto &t : state->threads ) {
+        t.join();
+    }
+}
+
+size_t thread_pool::size() const
+{
+    return state->threads.size() + 1;
+}
+
+void thread_pool::run( const size_t count, const std::function<void( size_t )> &task )
+{
+    if( state->threads.empty() || count <= 1 || state->running.exchange( true ) ) {
+        for( size_t i = 0; i < count; i++ ) {
+            task( i );
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( state->mutex );
+        state->task = &task;
+        state->count = count;
+        state->next = 0;
+        state->busy = state->threads.size();
+        state->batch++;
+    }
+    state->wake.notify_all();
+
+    state->do_tasks();
+
+    std::unique_lock<std::mutex> lock( state->mutex );
+    state->done.wait( lock, [this]() {
+        return state->busy == 0;
+    } );
+    state->task = nullptr;
+    state->running = false;
+}
+
+thread_pool &thread_pool::get()
+{
+    if( override_pool != nullptr ) {
+        return *override_pool;
+    }
+    // hardware_concurrency may return 0 if unknown
+    static thread_pool pool( std::max( std::thread::hardware_concurrency(), 1u ) - 1 );
+    return pool;
+}
+
+#else
+
+struct thread_pool::shared_state {
+};
+
+thread_pool::thread_pool( size_t ) : state( new shared_state() )
+{
+}
+
+thread_pool::~thread_pool()
+{
+}
+
+size_t thread_pool::size() const
+{
+    return 1;
+}
+
+void thread_pool::run( const size_t count, const std::function<void( size_t )> &task )
+{
+    for( size_t i = 0; i < count; i++ ) {
+        task( i );
+    }
+}
+
+thread_pool &thread_pool::get()
+{
+    if( override_pool != nullptr ) {
+        return *override_pool;
+    }
+    static thread_pool pool( 0 );
+    return pool;
+}
+
+#endif
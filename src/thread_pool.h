@@ -0,0 +1,58 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+/**
+ * A fixed set of worker threads for splitting up expensive, independent computations
+ * such as casting many light sources. The calling thread always takes part in the
+ * work, so without worker threads (single core machines, no thread support) the
+ * work simply runs serially on the caller.
+ */
+class thread_pool
+{
+    public:
+        /** The shared pool, with one thread per hardware thread (including the caller). */
+        static thread_pool &get();
+
+        /** Starts the given number of worker threads, which may be 0. */
+        explicit thread_pool( size_t workers );
+        ~thread_pool();
+
+        /** Number of threads taking part in @ref run, including the calling one. */
+        size_t size() const;
+
+        /**
+         * Calls task( i ) for every i in [0, count), possibly in parallel and in any order,
+         * and returns once all calls returned. Tasks must not access shared state that any
+         * other task writes to.
+         * If the pool is already busy (e.g. when called from within a task), the tasks run
+         * serially on the calling thread.
+         */
+        void run( size_t count, const std::function<void( size_t )> &task );
+
+    private:
+        struct shared_state;
+        std::unique_ptr<shared_state> state;
+};
+
+/**
+ * While it exists, @ref thread_pool::get returns a pool of its own with the given number of
+ * worker threads instead of the shared one, e.g. to compare parallel results with serial ones.
+ */
+class scoped_thread_pool
+{
+    public:
+        explicit scoped_thread_pool( size_t workers );
+        ~scoped_thread_pool();
+        scoped_thread_pool( const scoped_thread_pool & ) = delete;
+        scoped_thread_pool &operator=( const scoped_thread_pool & ) = delete;
+
+    private:
+        thread_pool pool;
+        thread_pool *previous;
+};
+
+#endif
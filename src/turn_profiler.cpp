@@ -0,0 +1,215 @@
+#include "turn_profiler.h"
+
+#include "cata_utility.h"
+#include "output.h"
+#include "translations.h"
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+namespace turn_profiler
+{
+
+static constexpr size_t num_phases = static_cast<size_t>( turn_phase::num_phases );
+
+static std::array<phase_stats, num_phases> phases;
+static phase_stats totals;
+/** Time accumulated by each phase during the turn that is currently being processed. */
+static std::array<clock::duration, num_phases> current_turn;
+
+static size_t bucket_of( const uint32_t us )
+{
+    size_t bucket = 0;
+    for( uint32_t v = us; v != 0 && bucket + 1 < num_buckets; v >>= 1 ) {
+        bucket++;
+    }
+    return bucket;
+}
+
+phase_stats::phase_stats()
+{
+    reset();
+}
+
+void phase_stats::reset()
+{
+    samples.fill( 0 );
+    histogram.fill( 0 );
+    next = 0;
+    count = 0;
+    total_us = 0;
+    total_turns = 0;
+    max_us = 0;
+}
+
+void phase_stats::add( const uint32_t us )
+{
+    if( count == window_size ) {
+        // Slot is about to be overwritten, the old sample leaves the rolling histogram.
+        histogram[bucket_of( samples[next] )]--;
+    } else {
+        count++;
+    }
+    samples[next] = us;
+    histogram[bucket_of( us )]++;
+    next = ( next + 1 ) % window_size;
+
+    total_us += us;
+    total_turns++;
+    max_us = std::max( max_us, us );
+}
+
+uint32_t phase_stats::recent( const size_t age ) const
+{
+    if( age >= count ) {
+        return 0;
+    }
+    return samples[( next + window_size - 1 - age ) % window_size];
+}
+
+double phase_stats::mean() const
+{
+    if( count == 0 ) {
+        return 0.0;
+    }
+    uint64_t sum = 0;
+    for( size_t i = 0; i < count; i++ ) {
+        sum += samples[i];
+    }
+    return static_cast<double>( sum ) / count;
+}
+
+uint32_t phase_stats::percentile( const double pct ) const
+{
+    if( count == 0 ) {
+        return 0;
+    }
+    std::vector<uint32_t> sorted( samples.begin(), samples.begin() + count );
+    const size_t index = std::min( count - 1, static_cast<size_t>( pct / 100.0 * count ) );
+    std::nth_element( sorted.begin(), sorted.begin() + index, sorted.end() );
+    return sorted[index];
+}
+
+double phase_stats::lifetime_mean() const
+{
+    return total_turns == 0 ? 0.0 : static_cast<double>( total_us ) / total_turns;
+}
+
+const char *phase_name( const turn_phase phase )
+{
+    switch( phase ) {
+        case turn_phase::process_events:
+            return "process_events";
+        case turn_phase::scent_update:
+            return "scent_update";
+        case turn_phase::build_floor_caches:
+            return "build_floor_caches";
+        case turn_phase::process_falling:
+            return "process_falling";
+        case turn_phase::vehmove:
+            return "vehmove";
+        case turn_phase::vehicle_idle:
+            return "vehicle_idle";
+        case turn_phase::generate_ahead:
+            return "generate_ahead";
+        case turn_phase::process_fields:
+            return "process_fields";
+        case turn_phase::process_active_items:
+            return "process_active_items";
+        case turn_phase::sound_processing:
+            return "process_sounds";
+        case turn_phase::build_map_cache:
+            return "build_map_cache";
+        case turn_phase::monmove:
+            return "monmove";
+        case turn_phase::update_stair_monsters:
+            return "update_stair_monsters";
+        case turn_phase::weather_effects:
+            return "weather_effects";
+        case turn_phase::num_phases:
+            break;
+    }
+    return "unknown";
+}
+
+void record( const turn_phase phase, const clock::duration elapsed )
+{
+    current_turn[static_cast<size_t>( phase )] += elapsed;
+}
+
+void finish_turn()
+{
+    uint32_t sum = 0;
+    for( size_t i = 0; i < num_phases; i++ ) {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>( current_turn[i] ).count();
+        const uint32_t clamped = static_cast<uint32_t>( std::max<decltype( us )>( 0, us ) );
+        phases[i].add( clamped );
+        sum += clamped;
+        current_turn[i] = clock::duration::zero();
+    }
+    totals.add( sum );
+}
+
+void reset()
+{
+    for( auto &elem : phases ) {
+        elem.reset();
+    }
+    totals.reset();
+    current_turn.fill( clock::duration::zero() );
+}
+
+const phase_stats &get_stats( const turn_phase phase )
+{
+    return phases[static_cast<size_t>( phase )];
+}
+
+const phase_stats &get_total_stats()
+{
+    return totals;
+}
+
+static std::string summary_line( const char *name, const phase_stats &stats )
+{
+    return string_format( "%-22s %9.1f %8u %8u %8u %9.1f\n", name, stats.mean(),
+                          static_cast<unsigned>( stats.percentile( 50 ) ),
+                          static_cast<unsigned>( stats.percentile( 95 ) ),
+                          static_cast<unsigned>( stats.max() ), stats.lifetime_mean() );
+}
+
+std::string summary()
+{
+    std::string result = string_format( "Turn phases over the last %d turns (microseconds)\n",
+                                        static_cast<int>( totals.size() ) );
+    result += string_format( "%-22s %9s %8s %8s %8s %9s\n", "phase", "mean", "p50", "p95", "max",
+                             "all-mean" );
+    for( size_t i = 0; i < num_phases; i++ ) {
+        result += summary_line( phase_name( static_cast<turn_phase>( i ) ), phases[i] );
+    }
+    result += summary_line( "total", totals );
+    return result;
+}
+
+static void write_histogram( std::ostream &fout, const char *name, const phase_stats &stats )
+{
+    fout << name;
+    for( const auto count : stats.buckets() ) {
+        fout << ' ' << count;
+    }
+    fout << '\n';
+}
+
+bool dump( const std::string &path )
+{
+    return write_to_file( path, [&]( std::ostream & fout ) {
+        fout << summary() << '\n';
+        fout << "Histograms, bucket i counts samples in [2^(i-1), 2^i) microseconds\n";
+        for( size_t i = 0; i < num_phases; i++ ) {
+            write_histogram( fout, phase_name( static_cast<turn_phase>( i ) ), phases[i] );
+        }
+        write_histogram( fout, "total", totals );
+    }, _( "turn profile" ) );
+}
+
+}
@@ -0,0 +1,137 @@
+#ifndef TURN_PROFILER_H
+#define TURN_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * The phases of @ref game::do_turn that are timed by the @ref turn_profiler.
+ * Phases that do not run in a given turn are recorded as taking no time.
+ */
+enum class turn_phase : int {
+    process_events = 0,
+    scent_update,
+    build_floor_caches,
+    process_falling,
+    vehmove,
+    vehicle_idle,
+    generate_ahead,
+    process_fields,
+    process_active_items,
+    sound_processing,
+    build_map_cache,
+    monmove,
+    update_stair_monsters,
+    weather_effects,
+    num_phases
+};
+
+/**
+ * Lightweight always-on instrumentation of the simulation part of a turn.
+ * Each phase collects one sample per turn. The last @ref window_size samples are kept
+ * in a ring buffer together with a logarithmic histogram of the same samples, so the
+ * statistics always describe recent play and not the whole session.
+ * Time spent waiting for player input is not part of any phase.
+ */
+namespace turn_profiler
+{
+
+using clock = std::chrono::steady_clock;
+
+/** Number of turns in the rolling window (one in-game hour). */
+constexpr size_t window_size = 600;
+/** Number of histogram buckets, bucket `i` holds samples in [2^(i-1), 2^i) microseconds. */
+constexpr size_t num_buckets = 24;
+
+class phase_stats
+{
+    private:
+        /** Samples in microseconds, @ref next is the slot to overwrite next. */
+        std::array<uint32_t, window_size> samples;
+        std::array<uint32_t, num_buckets> histogram;
+        size_t next = 0;
+        size_t count = 0;
+        uint64_t total_us = 0;
+        uint64_t total_turns = 0;
+        uint32_t max_us = 0;
+
+    public:
+        phase_stats();
+
+        void add( uint32_t us );
+        void reset();
+
+        /** Number of samples currently in the window. */
+        size_t size() const {
+            return count;
+        }
+        /** Sample that is `age` turns old, 0 being the most recent one. */
+        uint32_t recent( size_t age ) const;
+        /** Mean of the samples in the window in microseconds. */
+        double mean() const;
+        /** Percentile (0 - 100) of the samples in the window in microseconds. */
+        uint32_t percentile( double pct ) const;
+        /** Largest sample ever recorded since the last reset. */
+        uint32_t max() const {
+            return max_us;
+        }
+        /** Mean over all turns since the last reset. */
+        double lifetime_mean() const;
+        const std::array<uint32_t, num_buckets> &buckets() const {
+            return histogram;
+        }
+};
+
+const char *phase_name( turn_phase phase );
+
+/** Adds time to the given phase for the current turn. */
+void record( turn_phase phase, clock::duration elapsed );
+/** Pushes the times accumulated during this turn into the statistics. */
+void finish_turn();
+/** Forgets all collected statistics. */
+void reset();
+
+const phase_stats &get_stats( turn_phase phase );
+/** Statistics of the sum of all phases of a turn. */
+const phase_stats &get_total_stats();
+
+/** Human readable table of all phases. */
+std::string summary();
+/** Writes the summary and the histograms of all phases into the given file. */
+bool dump( const std::string &path );
+
+/** Records the time between construction and destruction into a phase. */
+class scoped_timer
+{
+    private:
+        turn_phase phase;
+        clock::time_point start;
+
+    public:
+        scoped_timer( turn_phase p ) : phase( p ), start( clock::now() ) { }
+        ~scoped_timer() {
+            record( phase, clock::now() - start );
+        }
+
+        scoped_timer( const scoped_timer & ) = delete;
+        scoped_timer &operator=( const scoped_timer & ) = delete;
+};
+
+/** Calls @ref finish_turn when it goes out of scope, so turns that end early are counted too. */
+class turn_guard
+{
+    public:
+        turn_guard() = default;
+        ~turn_guard() {
+            finish_turn();
+        }
+
+        turn_guard( const turn_guard & ) = delete;
+        turn_guard &operator=( const turn_guard & ) = delete;
+};
+
+}
+
+#endif
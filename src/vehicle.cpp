@@ -1731,6 +1731,7 @@ int vehicle::install_part( int dx, int dy, const vehicle_part &new_part )
     pt.mount.y = dy;
 
     refresh();
+    g->m.set_submap_dirty( global_pos3() );
     return parts.size() - 1;
 }
 
@@ -1833,6 +1834,7 @@ bool vehicle::remove_part (int p)
         g->m.add_item_or_charges( dest, i );
     }
     g->m.dirty_vehicle_list.insert(this);
+    g->m.set_submap_dirty( global_pos3() );
     refresh();
     return shift_if_needed();
 }
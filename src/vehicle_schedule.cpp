@@ -0,0 +1,78 @@
+#include "vehicle_schedule.h"
+
+#include "vehicle.h"
+
+void vehicle_schedule::clear()
+{
+    vehicles.clear();
+    moving = std::priority_queue<entry>();
+    falling.clear();
+    next_order = 0;
+}
+
+void vehicle_schedule::update( vehicle &veh )
+{
+    auto iter = vehicles.find( &veh );
+    if( iter == vehicles.end() ) {
+        iter = vehicles.emplace( &veh, state{ next_order++, false, 0 } ).first;
+    }
+    state &st = iter->second;
+    if( veh.of_turn > 0 ) {
+        if( !st.queued || st.of_turn != veh.of_turn ) {
+            st.queued = true;
+            st.of_turn = veh.of_turn;
+            moving.push( entry{ veh.of_turn, st.order, &veh } );
+        }
+    } else {
+        st.queued = false;
+    }
+    if( veh.falling ) {
+        falling.emplace( st.order, &veh );
+    } else {
+        falling.erase( std::make_pair( st.order, &veh ) );
+    }
+}
+
+void vehicle_schedule::moved( vehicle *veh )
+{
+    // Only dereferenced if it's still on the map
+    if( vehicles.count( veh ) > 0 ) {
+        update( *veh );
+    }
+}
+
+void vehicle_schedule::remove( const vehicle *veh )
+{
+    vehicles.erase( veh );
+}
+
+vehicle *vehicle_schedule::next()
+{
+    while( !moving.empty() ) {
+        const entry top = moving.top();
+        moving.pop();
+        const auto iter = vehicles.find( top.veh );
+        if( iter == vehicles.end() || iter->second.order != top.order ||
+            !iter->second.queued || iter->second.of_turn != top.of_turn ) {
+            // Removed or re-queued since
+            continue;
+        }
+        iter->second.queued = false;
+        if( top.veh->of_turn != top.of_turn ) {
+            // Changed without an update, queue it where it belongs now.
+            update( *top.veh );
+            continue;
+        }
+        return top.veh;
+    }
+
+    for( auto it = falling.begin(); it != falling.end(); ) {
+        const auto iter = vehicles.find( it->second );
+        if( iter == vehicles.end() || iter->second.order != it->first || !it->second->falling ) {
+            it = falling.erase( it );
+            continue;
+        }
+        return it->second;
+    }
+    return nullptr;
+}
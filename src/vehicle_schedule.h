@@ -0,0 +1,63 @@
+#ifndef VEHICLE_SCHEDULE_H
+#define VEHICLE_SCHEDULE_H
+
+#include <queue>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class vehicle;
+
+/**
+ * The order in which @ref map::vehproceed moves vehicles: the one with the most movement
+ * (vehicle::of_turn) left first, then the falling ones. Ties go to the vehicle that was
+ * added first.
+ *
+ * Vehicles are added once per turn and re-queued after each step, so picking the next
+ * one doesn't look at every vehicle on the map. Vehicles are removed when they are
+ * detached from the map; the schedule never dereferences a vehicle after that.
+ * Changes to a vehicle's movement made elsewhere must be passed on with @ref update,
+ * otherwise they are only noticed when its old entry comes up.
+ */
+class vehicle_schedule
+{
+    public:
+        /** Forgets all vehicles. */
+        void clear();
+        /** Adds the vehicle, or re-queues it by its current of_turn and falling state. */
+        void update( vehicle &veh );
+        /** Re-queues the vehicle after it moved, unless it was removed meanwhile. */
+        void moved( vehicle *veh );
+        /** Forgets the vehicle, it may be destroyed afterwards. */
+        void remove( const vehicle *veh );
+        /** The vehicle to move next, nullptr if none has movement left or is falling. */
+        vehicle *next();
+
+    private:
+        struct entry {
+            float of_turn;
+            size_t order;
+            vehicle *veh;
+
+            // std::priority_queue returns the largest one first
+            bool operator<( const entry &rhs ) const {
+                return of_turn < rhs.of_turn || ( of_turn == rhs.of_turn && order > rhs.order );
+            }
+        };
+        struct state {
+            size_t order;
+            /** Whether there is a valid entry in @ref moving and its of_turn */
+            bool queued;
+            float of_turn;
+        };
+
+        std::unordered_map<const vehicle *, state> vehicles;
+        /** Contains outdated entries, see @ref state::queued */
+        std::priority_queue<entry> moving;
+        /** By order of the vehicles, contains outdated entries for removed vehicles */
+        std::set<std::pair<size_t, vehicle *>> falling;
+        size_t next_order = 0;
+};
+
+#endif
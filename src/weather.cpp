@@ -15,6 +15,7 @@
 #include "cata_utility.h"
 #include "player.h"
 
+#include <map>
 #include <vector>
 #include <sstream>
 
@@ -58,26 +59,6 @@ void weather_effect::glare()
 
 int get_hourly_rotpoints_at_temp( int temp );
 
-int get_rot_since( const int startturn, const int endturn, const tripoint &location )
-{
-    // Ensure food doesn't rot in ice labs, where the
-    // temperature is much less than the weather specifies.
-    tripoint const omt_pos = ms_to_omt_copy( location );
-    oter_id const & oter = overmap_buffer.ter( omt_pos );
-    // TODO: extract this into a property of the overmap terrain
-    if (is_ot_type("ice_lab", oter)) {
-        return 0;
-    }
-    // TODO: maybe have different rotting speed when underground?
-    int ret = 0;
-    const auto &wgen = g->get_cur_weather_gen();
-    for (calendar i(startturn); i.get_turn() < endturn; i += 600) {
-        w_point w = wgen.get_weather( location, i, g->get_seed() );
-        ret += std::min(600, endturn - i.get_turn()) * get_hourly_rotpoints_at_temp(w.temperature) / 600;
-    }
-    return ret;
-}
-
 inline void proc_weather_sum( const weather_type wtype, weather_sum &data,
                               const calendar &turn, const int tick_size )
 {
@@ -105,27 +86,231 @@ inline void proc_weather_sum( const weather_type wtype, weather_sum &data,
     data.sunlight += std::max<float>( 0.0f, tick_size * tick_sunlight );
 }
 
+namespace
+{
+
+/** Weather accumulated over some turns, see @ref weather_timeline. */
+struct weather_totals {
+    long long rot = 0;
+    long long rain_amount = 0;
+    long long acid_amount = 0;
+    double sunlight = 0.0;
+
+    weather_totals operator+( const weather_totals &rhs ) const {
+        weather_totals result;
+        result.rot = rot + rhs.rot;
+        result.rain_amount = rain_amount + rhs.rain_amount;
+        result.acid_amount = acid_amount + rhs.acid_amount;
+        result.sunlight = sunlight + rhs.sunlight;
+        return result;
+    }
+    weather_totals operator-( const weather_totals &rhs ) const {
+        weather_totals result;
+        result.rot = rot - rhs.rot;
+        result.rain_amount = rain_amount - rhs.rain_amount;
+        result.acid_amount = acid_amount - rhs.acid_amount;
+        result.sunlight = sunlight - rhs.sunlight;
+        return result;
+    }
+    /** The share of these totals (of one hour) that falls into the given number of turns */
+    weather_totals part( const int turns ) const {
+        weather_totals result;
+        result.rot = rot * turns / HOURS( 1 );
+        result.rain_amount = rain_amount * turns / HOURS( 1 );
+        result.acid_amount = acid_amount * turns / HOURS( 1 );
+        result.sunlight = sunlight * turns / HOURS( 1 );
+        return result;
+    }
+};
+
+/**
+ * The weather of one region, summed up hour by hour. Keeps prefix sums of the hourly
+ * values, so the weather of any span of turns is a difference of two entries instead of
+ * a call to the weather generator for every hour of the span.
+ *
+ * The weather of an hour is sampled at the center of the region: the temperature (and so
+ * the rot) at the start of the hour, the rain and sunlight every 10 minutes.
+ */
+class weather_timeline
+{
+    public:
+        /** Regions are this many overmap terrains wide. */
+        static constexpr int region_size = 4;
+
+        explicit weather_timeline( const tripoint &center ) : center( center ) { }
+
+        /** The weather in the turns [start, end), start must be less than end. */
+        weather_totals sum( const int start, const int end ) {
+            const int first = hour_of( start );
+            const int last = hour_of( end - 1 );
+            cover( first, last );
+            if( first == last ) {
+                return hours( first, first + 1 ).part( end - start );
+            }
+            return hours( first, first + 1 ).part( HOURS( first + 1 ) - start ) +
+                   hours( first + 1, last ) +
+                   hours( last, last + 1 ).part( end - HOURS( last ) );
+        }
+
+    private:
+        static int hour_of( const int turn ) {
+            return turn >= 0 ? turn / HOURS( 1 ) : ( turn - HOURS( 1 ) + 1 ) / HOURS( 1 );
+        }
+
+        /** Sum of the hours [from, to), which must be covered. */
+        weather_totals hours( const int from, const int to ) const {
+            return prefix[to - first_hour] - prefix[from - first_hour];
+        }
+
+        /** Makes sure the hours [first, last] are in the timeline. */
+        void cover( const int first, const int last ) {
+            if( prefix.empty() ) {
+                first_hour = first;
+                prefix.emplace_back();
+            }
+            if( first < first_hour ) {
+                // Grow by at least the current length, so stepping back hour by hour is
+                // not quadratic. Don't reach into negative turns without need.
+                int new_first = std::min( first, first_hour - static_cast<int>( prefix.size() - 1 ) );
+                if( first >= 0 ) {
+                    new_first = std::max( new_first, 0 );
+                }
+                std::vector<weather_totals> grown( 1 );
+                grown.reserve( first_hour - new_first + prefix.size() );
+                for( int h = new_first; h < first_hour; ++h ) {
+                    grown.push_back( grown.back() + hour_weather( h ) );
+                }
+                const weather_totals offset = grown.back();
+                for( size_t i = 1; i < prefix.size(); ++i ) {
+                    grown.push_back( offset + prefix[i] );
+                }
+                prefix.swap( grown );
+                first_hour = new_first;
+            }
+            while( first_hour + static_cast<int>( prefix.size() ) <= last + 1 ) {
+                prefix.push_back( prefix.back() + hour_weather( first_hour + prefix.size() - 1 ) );
+            }
+        }
+
+        weather_totals hour_weather( const int hour ) const {
+            static constexpr int sample_interval = MINUTES( 10 );
+            const auto &wgen = g->get_cur_weather_gen();
+            const unsigned seed = g->get_seed();
+
+            weather_totals result;
+            weather_sum sums;
+            for( int t = 0; t < HOURS( 1 ); t += sample_interval ) {
+                const calendar turn( HOURS( hour ) + t );
+                const w_point w = wgen.get_weather( center, turn, seed );
+                if( t == 0 ) {
+                    result.rot = get_hourly_rotpoints_at_temp( w.temperature );
+                }
+                proc_weather_sum( wgen.get_weather_conditions( w ), sums, turn, sample_interval );
+            }
+            result.rain_amount = sums.rain_amount;
+            result.acid_amount = sums.acid_amount;
+            result.sunlight = sums.sunlight;
+            return result;
+        }
+
+        tripoint center;
+        int first_hour = 0;
+        /** prefix[i] is the sum of the hours [first_hour, first_hour + i) */
+        std::vector<weather_totals> prefix;
+};
+
+/** Everything the timelines depend on besides the location */
+struct weather_timeline_source {
+    double base_temperature;
+    double base_humidity;
+    double base_pressure;
+    double base_acid;
+    unsigned seed;
+    int season_length;
+
+    bool operator==( const weather_timeline_source &rhs ) const {
+        return base_temperature == rhs.base_temperature && base_humidity == rhs.base_humidity &&
+               base_pressure == rhs.base_pressure && base_acid == rhs.base_acid &&
+               seed == rhs.seed && season_length == rhs.season_length;
+    }
+};
+
+/** The weather in the turns [start, end) near the location, start must be less than end. */
+weather_totals sum_weather( const int start, const int end, const tripoint &location )
+{
+    // Each timeline of a year takes about 300 KB.
+    static constexpr size_t max_timelines = 64;
+    static weather_timeline_source cached_source = {};
+    static std::map<point, weather_timeline> timelines;
+
+    const auto &wgen = g->get_cur_weather_gen();
+    const weather_timeline_source source = { wgen.base_temperature, wgen.base_humidity,
+                                             wgen.base_pressure, wgen.base_acid, g->get_seed(),
+                                             calendar::season_length()
+                                           };
+    if( !( source == cached_source ) ) {
+        timelines.clear();
+        cached_source = source;
+    }
+
+    static constexpr int size = weather_timeline::region_size;
+    const tripoint omt = ms_to_omt_copy( location );
+    const point region( omt.x >= 0 ? omt.x / size : ( omt.x - size + 1 ) / size,
+                        omt.y >= 0 ? omt.y / size : ( omt.y - size + 1 ) / size );
+    auto iter = timelines.find( region );
+    if( iter == timelines.end() ) {
+        if( timelines.size() >= max_timelines ) {
+            timelines.clear();
+        }
+        const tripoint center( ( region.x * size + size / 2 ) * SEEX * 2,
+                               ( region.y * size + size / 2 ) * SEEY * 2, 0 );
+        iter = timelines.emplace( region, weather_timeline( center ) ).first;
+    }
+    return iter->second.sum( start, end );
+}
+
+} // namespace
+
+int get_rot_since( const int startturn, const int endturn, const tripoint &location )
+{
+    // Ensure food doesn't rot in ice labs, where the
+    // temperature is much less than the weather specifies.
+    tripoint const omt_pos = ms_to_omt_copy( location );
+    oter_id const & oter = overmap_buffer.ter( omt_pos );
+    // TODO: extract this into a property of the overmap terrain
+    if (is_ot_type("ice_lab", oter)) {
+        return 0;
+    }
+    if( startturn >= endturn ) {
+        return 0;
+    }
+    // TODO: maybe have different rotting speed when underground?
+    return sum_weather( startturn, endturn, location ).rot;
+}
+
 ////// Funnels.
 weather_sum sum_conditions( const calendar &startturn,
                             const calendar &endturn,
                             const tripoint &location )
 {
-    int tick_size = MINUTES(1);
     weather_sum data;
+    const int diff = endturn - startturn;
+    if( diff <= 0 ) {
+        return data;
+    }
 
-    const auto wgen = g->get_cur_weather_gen();
-    for( calendar turn(startturn); turn < endturn; turn += tick_size ) {
-        const int diff = endturn - startturn;
-        if( diff <= 0 ) {
-            return data;
-        } else if( diff < 10 ) {
-            tick_size = 1;
-        } else if( diff > DAYS(7) ) {
-            tick_size = HOURS(1);
-        } else {
-            tick_size = MINUTES(1);
-        }
+    if( diff >= HOURS( 1 ) ) {
+        const weather_totals totals = sum_weather( startturn, endturn, location );
+        data.rain_amount = totals.rain_amount;
+        data.acid_amount = totals.acid_amount;
+        data.sunlight = totals.sunlight;
+        return data;
+    }
 
+    // Short spans, like the per-minute vehicle updates, are sampled directly.
+    const int tick_size = diff < 10 ? 1 : MINUTES( 1 );
+    const auto &wgen = g->get_cur_weather_gen();
+    for( calendar turn( startturn ); turn < endturn; turn += tick_size ) {
         const auto wtype = wgen.get_weather_conditions( location, turn, g->get_seed() );
         proc_weather_sum( wtype, data, turn, tick_size );
     }
@@ -34,12 +34,20 @@ w_point weather_generator::get_weather( const tripoint &location, const calendar
     //Windows has a rand limit of 32768, other operating systems can have higher limits
     const unsigned modSEED = seed % 32768;
 
-    // Noise factors
-    double T( raw_noise_4d( x, y, z, modSEED ) * 4.0 );
-    double H( raw_noise_4d( x, y, z / 5, modSEED + 101 ) );
-    double H2( raw_noise_4d( x, y, z, modSEED + 151 ) / 4 );
-    double P( raw_noise_4d( x, y, z / 3, modSEED + 211 ) * 70 );
-    double A( raw_noise_4d( x, y, z, modSEED ) * 8.0 );
+    // Noise factors, temperature and acid use the same noise
+    const float nx[4] = { float( x ), float( x ), float( x ), float( x ) };
+    const float ny[4] = { float( y ), float( y ), float( y ), float( y ) };
+    const float nz[4] = { float( z ), float( z / 5 ), float( z ), float( z / 3 ) };
+    const float nw[4] = { float( modSEED ), float( modSEED + 101 ), float( modSEED + 151 ),
+                          float( modSEED + 211 )
+                        };
+    float noise[4];
+    raw_noise_4d( nx, ny, nz, nw, noise, 4 );
+    double T( noise[0] * 4.0 );
+    double H( noise[1] );
+    double H2( noise[2] / 4 );
+    double P( noise[3] * 70 );
+    double A( noise[0] * 8.0 );
     double W;
 
     const double now( double( t.turn_of_year() + DAYS( t.season_length() ) / 2 ) / double(
@@ -4,6 +4,7 @@
 #include "game.h"
 #include "itype.h"
 #include "npc.h"
+#include "overmapbuffer.h"
 #include "player.h"
 #include "recipe_dictionary.h"
 
@@ -209,5 +210,9 @@ TEST_CASE( "available_recipes", "[.]" ) {
                 }
             }
         }
+
+        // The helper lives on the stack, later tests must not find it in the game or the overmap.
+        g->unload_npcs();
+        overmap_buffer.hide_npc( who.getID() );
     }
 }
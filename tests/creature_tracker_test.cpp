@@ -0,0 +1,69 @@
+#include "catch/catch.hpp"
+
+#include "creature_tracker.h"
+#include "game.h"
+#include "line.h"
+#include "monster.h"
+#include "mtype.h"
+#include "player.h"
+#include "rng.h"
+
+#include <algorithm>
+#include <vector>
+
+static std::vector<const monster *> brute_force_in_radius( const tripoint &center, int radius )
+{
+    std::vector<const monster *> ret;
+    for( size_t i = 0; i < g->num_zombies(); i++ ) {
+        const monster &critter = g->zombie( i );
+        if( rl_dist( center, critter.pos() ) <= radius ) {
+            ret.push_back( &critter );
+        }
+    }
+    std::sort( ret.begin(), ret.end() );
+    return ret;
+}
+
+static std::vector<const monster *> tracked_in_radius( const tripoint &center, int radius )
+{
+    std::vector<const monster *> ret;
+    g->critter_tracker->for_each_in_radius( center, radius, [&ret]( monster & critter ) {
+        ret.push_back( &critter );
+    } );
+    std::sort( ret.begin(), ret.end() );
+    return ret;
+}
+
+TEST_CASE( "creature_tracker_radius_queries_match_brute_force", "[creature_tracker]" )
+{
+    g->clear_zombies();
+    const int z = g->u.posz();
+    const mtype_id zombie( "mon_zombie" );
+    for( int i = 0; i < 200; i++ ) {
+        monster critter( zombie, tripoint( rng( 0, SEEX * MAPSIZE - 1 ), rng( 0, SEEY * MAPSIZE - 1 ), z ) );
+        g->critter_tracker->add( critter );
+    }
+    // Some monsters walk around, some get removed, which renumbers the others
+    for( int i = 0; i < 50; i++ ) {
+        monster &critter = g->zombie( rng( 0, g->num_zombies() - 1 ) );
+        const tripoint dest = critter.pos() + tripoint( rng( -20, 20 ), rng( -20, 20 ), 0 );
+        if( g->critter_tracker->mon_at( dest ) == -1 &&
+            g->critter_tracker->update_pos( critter, dest ) ) {
+            critter.spawn( dest );
+        }
+        g->remove_zombie( rng( 0, g->num_zombies() - 1 ) );
+    }
+
+    for( size_t i = 0; i < g->num_zombies(); i++ ) {
+        CHECK( g->critter_tracker->mon_at( g->zombie( i ).pos() ) == static_cast<int>( i ) );
+    }
+    for( const int radius : {
+             0, 1, 5, 12, 30, 200
+         } ) {
+        const tripoint center( rng( 0, SEEX * MAPSIZE - 1 ), rng( 0, SEEY * MAPSIZE - 1 ), z );
+        CHECK( tracked_in_radius( center, radius ) == brute_force_in_radius( center, radius ) );
+    }
+
+    g->clear_zombies();
+    CHECK( tracked_in_radius( tripoint( 60, 60, z ), 200 ).empty() );
+}
@@ -0,0 +1,70 @@
+#include "catch/catch.hpp"
+
+#include "json.h"
+
+#include <sstream>
+#include <string>
+
+static const std::string test_json =
+    "{\n"
+    "  \"plain\": \"some text\",\n"
+    "  \"escaped\" : \"a \\\"quote\\\", \\\\ and \\u00e9\\n\",\n"
+    "  \"numbers\": [ 0, -12, 3.5, 1e3, -2.5E-1, 0.25 ],\n"
+    "  \"flags\": [ true, false, null ],\n"
+    "  \"nested\": { \"empty\": [], \"obj\": {} },\n"
+    "  \"last\": 7\n"
+    "}";
+
+static void check_test_json( JsonIn &jsin )
+{
+    JsonObject jo = jsin.get_object();
+    CHECK( jo.get_string( "plain" ) == "some text" );
+    CHECK( jo.get_string( "escaped" ) == "a \"quote\", \\ and \xc3\xa9\n" );
+    JsonArray numbers = jo.get_array( "numbers" );
+    CHECK( numbers.next_int() == 0 );
+    CHECK( numbers.next_int() == -12 );
+    CHECK( numbers.next_float() == 3.5 );
+    CHECK( numbers.next_int() == 1000 );
+    CHECK( numbers.next_float() == Approx( -0.25 ) );
+    CHECK( numbers.next_float() == 0.25 );
+    CHECK( !numbers.has_more() );
+    JsonArray flags = jo.get_array( "flags" );
+    CHECK( flags.next_bool() );
+    CHECK( !flags.next_bool() );
+    CHECK( jo.get_object( "nested" ).get_array( "empty" ).size() == 0 );
+    CHECK( jo.get_int( "last" ) == 7 );
+}
+
+TEST_CASE( "json_from_memory_and_from_streams_are_the_same", "[json]" )
+{
+    SECTION( "stream" ) {
+        std::istringstream fin( test_json );
+        JsonIn jsin( fin );
+        check_test_json( jsin );
+    }
+
+    SECTION( "memory" ) {
+        memory_streambuf buffer( test_json.data(), test_json.size() );
+        std::istream fin( &buffer );
+        JsonIn jsin( fin );
+        check_test_json( jsin );
+    }
+}
+
+TEST_CASE( "json_errors_from_memory_point_to_the_error", "[json]" )
+{
+    const std::string broken = "{\n  \"a\": \"ok\",\n  \"b\": 01\n}";
+    memory_streambuf buffer( broken.data(), broken.size() );
+    std::istream fin( &buffer );
+    JsonIn jsin( fin );
+    jsin.start_object();
+    CHECK( jsin.get_member_name() == "a" );
+    CHECK( jsin.get_string() == "ok" );
+    CHECK( jsin.get_member_name() == "b" );
+    try {
+        jsin.get_int();
+        FAIL( "leading zero not reported" );
+    } catch( const JsonError &err ) {
+        CHECK( std::string( err.what() ).find( "line 3" ) != std::string::npos );
+    }
+}
@@ -0,0 +1,130 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "player.h"
+#include "thread_pool.h"
+#include "veh_type.h"
+#include "vehicle.h"
+
+#include <algorithm>
+#include <vector>
+
+static std::vector<float> snapshot_lightmap( const int z )
+{
+    std::vector<float> ret;
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            ret.push_back( g->m.ambient_light_at( tripoint( x, y, z ) ) );
+        }
+    }
+    return ret;
+}
+
+TEST_CASE( "incremental_lightmap_matches_full_rebuild", "[lightmap]" )
+{
+    const int z = g->u.posz();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            g->m.set( tripoint( x, y, z ), t_floor, f_null );
+        }
+    }
+
+    g->m.ter_set( tripoint( 20, 20, z ), t_utility_light );
+    g->m.ter_set( tripoint( 90, 90, z ), t_utility_light );
+    g->m.set_transparency_cache_dirty( z );
+    g->m.set_outside_cache_dirty( z );
+    g->m.build_map_cache( z );
+
+    SECTION( "wall next to a light" ) {
+        for( int y = 10; y < 30; ++y ) {
+            g->m.ter_set( tripoint( 24, y, z ), t_wall );
+        }
+    }
+
+    SECTION( "light removed" ) {
+        g->m.ter_set( tripoint( 90, 90, z ), t_floor );
+    }
+
+    SECTION( "light added" ) {
+        g->m.ter_set( tripoint( 60, 30, z ), t_utility_light );
+    }
+
+    g->m.build_map_cache( z );
+    const auto incremental = snapshot_lightmap( z );
+
+    g->m.set_transparency_cache_dirty( z );
+    g->m.set_outside_cache_dirty( z );
+    g->m.build_map_cache( z );
+    CHECK( incremental == snapshot_lightmap( z ) );
+}
+
+static void build_caches_from_scratch( const int z, std::vector<float> &lm,
+                                       std::vector<float> &seen )
+{
+    g->m.set_transparency_cache_dirty( z );
+    g->m.set_outside_cache_dirty( z );
+    g->m.build_map_cache( z );
+    const auto &cache = g->m.get_cache_ref( z );
+    const size_t size = MAPSIZE * SEEX * MAPSIZE * SEEY;
+    lm.assign( &cache.lm[0][0], &cache.lm[0][0] + size );
+    seen.assign( &cache.seen_cache[0][0], &cache.seen_cache[0][0] + size );
+}
+
+TEST_CASE( "parallel_lightmap_matches_serial_one", "[lightmap]" )
+{
+    const int z = g->u.posz();
+    const tripoint old_pos = g->u.pos();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            g->m.set( tripoint( x, y, z ), t_floor, f_null );
+        }
+    }
+    // Enough lights to split them between several workers, and walls to cast shadows
+    for( int i = 0; i < 48; ++i ) {
+        g->m.ter_set( tripoint( 5 + ( i * 37 ) % ( mapsize - 10 ), 5 + ( i * 53 ) % ( mapsize - 10 ),
+                                z ), t_utility_light );
+    }
+    for( int i = 0; i < 20; ++i ) {
+        g->m.ter_set( tripoint( 50 + i, 48, z ), t_wall );
+        g->m.ter_set( tripoint( 72, 50 + i, z ), t_wall );
+    }
+
+    vehicle *car = g->m.add_vehicle( vproto_id( "car" ), tripoint( 60, 60, z ), 0, 0, 0 );
+    REQUIRE( car != nullptr );
+    REQUIRE( car->install_part( 0, 0, vpart_id( "wing_mirror" ), true ) >= 0 );
+    g->u.setpos( car->global_pos3() );
+
+    std::vector<float> parallel_lm;
+    std::vector<float> parallel_seen;
+    {
+        scoped_thread_pool pool( 3 );
+        build_caches_from_scratch( z, parallel_lm, parallel_seen );
+    }
+    std::vector<float> serial_lm;
+    std::vector<float> serial_seen;
+    {
+        scoped_thread_pool pool( 0 );
+        build_caches_from_scratch( z, serial_lm, serial_seen );
+    }
+
+    // Make sure the map actually had something to compare
+    CHECK( std::count_if( serial_lm.begin(), serial_lm.end(), []( float l ) {
+        return l > 0.0f;
+    } ) > 100 );
+    CHECK( parallel_lm == serial_lm );
+    CHECK( parallel_seen == serial_seen );
+
+    g->m.destroy_vehicle( car );
+    g->u.setpos( old_pos );
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            g->m.set( tripoint( x, y, z ), t_floor, f_null );
+        }
+    }
+    g->m.build_map_cache( z );
+}
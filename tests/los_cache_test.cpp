@@ -0,0 +1,128 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "los_cache.h"
+#include "map.h"
+#include "mapdata.h"
+
+TEST_CASE( "los_cache_remembers_results_of_one_turn", "[los_cache]" )
+{
+    los_cache cache;
+    const tripoint from( 10, 10, 0 );
+    const tripoint to( 20, 15, 0 );
+    bool visible = false;
+
+    CHECK( !cache.find( from, to, 30, 100, visible ) );
+    cache.insert( from, to, 30, true );
+    REQUIRE( cache.find( from, to, 30, 100, visible ) );
+    CHECK( visible );
+    // Other ranges and directions are different questions.
+    CHECK( !cache.find( from, to, 5, 100, visible ) );
+    CHECK( !cache.find( to, from, 30, 100, visible ) );
+
+    cache.insert( from, to, -1, false );
+    REQUIRE( cache.find( from, to, -1, 100, visible ) );
+    CHECK( !visible );
+
+    // Points off the map are never remembered.
+    const tripoint far_away( -5, 300, 0 );
+    cache.insert( from, far_away, 30, true );
+    CHECK( !cache.find( from, far_away, 30, 100, visible ) );
+
+    CHECK( !cache.find( from, to, 30, 101, visible ) );
+    cache.insert( from, to, 30, true );
+    cache.invalidate();
+    CHECK( !cache.find( from, to, 30, 101, visible ) );
+
+    CHECK( cache.get_stats().hits == 2 );
+    CHECK( cache.get_stats().misses == 6 );
+    CHECK( cache.get_stats().invalidations == 1 );
+}
+
+TEST_CASE( "map_sees_notices_new_walls", "[los_cache]" )
+{
+    const int z = g->get_levz();
+    for( int x = 40; x <= 60; x++ ) {
+        for( int y = 40; y <= 60; y++ ) {
+            g->m.ter_set( tripoint( x, y, z ), t_pavement );
+            g->m.furn_set( tripoint( x, y, z ), f_null );
+        }
+    }
+    g->m.build_map_cache( z );
+
+    const tripoint from( 42, 50, z );
+    const tripoint to( 58, 50, z );
+    const uint64_t hits = g->m.get_los_cache_stats().hits;
+    CHECK( g->m.sees( from, to, 30 ) );
+    CHECK( g->m.sees( from, to, 30 ) );
+    CHECK( g->m.get_los_cache_stats().hits == hits + 1 );
+
+    g->m.ter_set( tripoint( 50, 50, z ), t_concrete_wall );
+    g->m.build_map_cache( z );
+    CHECK( !g->m.sees( from, to, 30 ) );
+
+    g->m.ter_set( tripoint( 50, 50, z ), t_pavement );
+    g->m.build_map_cache( z );
+}
+
+TEST_CASE( "vision_field_matches_lines_of_sight", "[los_cache]" )
+{
+    const int z = g->get_levz();
+    for( int x = 40; x <= 60; x++ ) {
+        for( int y = 40; y <= 60; y++ ) {
+            g->m.ter_set( tripoint( x, y, z ), t_pavement );
+            g->m.furn_set( tripoint( x, y, z ), f_null );
+        }
+    }
+    // A wall with a gap in the middle
+    for( int y = 42; y <= 58; y++ ) {
+        if( y != 50 ) {
+            g->m.ter_set( tripoint( 50, y, z ), t_concrete_wall );
+        }
+    }
+    g->m.build_map_cache( z );
+
+    const tripoint from( 46, 50, z );
+    const uint64_t fields = g->m.get_los_cache_stats().fields;
+    CHECK( g->m.sees_in_field( from, tripoint( 58, 50, z ), 20, 20 ) );
+    CHECK( !g->m.sees_in_field( from, tripoint( 58, 44, z ), 20, 20 ) );
+    CHECK( !g->m.sees_in_field( from, tripoint( 51, 42, z ), 20, 20 ) );
+    CHECK( g->m.sees_in_field( from, tripoint( 50, 44, z ), 20, 20 ) );
+    CHECK( g->m.sees_in_field( from, tripoint( 44, 58, z ), 20, 20 ) );
+    // Out of the requested range
+    CHECK( !g->m.sees_in_field( from, tripoint( 58, 50, z ), 5, 20 ) );
+    CHECK( g->m.get_los_cache_stats().fields == fields + 1 );
+
+    // Straight lines through the gap and into open space agree with sees.
+    for( int x = 40; x <= 60; x++ ) {
+        const tripoint to( x, 50, z );
+        CHECK( g->m.sees_in_field( from, to, 20, 20 ) == g->m.sees( from, to, 20 ) );
+    }
+    for( int y = 40; y <= 60; y++ ) {
+        const tripoint to( 44, y, z );
+        CHECK( g->m.sees_in_field( from, to, 20, 20 ) == g->m.sees( from, to, 20 ) );
+    }
+
+    for( int y = 42; y <= 58; y++ ) {
+        g->m.ter_set( tripoint( 50, y, z ), t_pavement );
+    }
+    g->m.build_map_cache( z );
+}
+
+TEST_CASE( "vision_field_leaves_far_points_to_lines_of_sight", "[los_cache]" )
+{
+    const int z = g->get_levz();
+    for( int x = 2; x <= 90; x++ ) {
+        for( int y = 59; y <= 61; y++ ) {
+            g->m.ter_set( tripoint( x, y, z ), t_pavement );
+            g->m.furn_set( tripoint( x, y, z ), f_null );
+        }
+    }
+    g->m.build_map_cache( z );
+
+    // Farther than shadowcasting reaches, but within the daylight sight range of an NPC
+    const tripoint from( 5, 60, z );
+    const tripoint to( 5 + los_cache::max_field_radius + 20, 60, z );
+    REQUIRE( g->m.sees( from, to, 87 ) );
+    CHECK( g->m.sees_in_field( from, to, 87, 87 ) );
+}
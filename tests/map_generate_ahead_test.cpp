@@ -0,0 +1,32 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "map.h"
+#include "mapbuffer.h"
+#include "rng.h"
+
+TEST_CASE( "map_generates_submaps_ahead_of_the_bubble", "[map]" )
+{
+    map &m = g->m;
+    const tripoint abs_sub = m.get_abs_sub();
+    const int size = m.getmapsize();
+
+    // Leaves the random numbers of the tests after this one alone
+    scoped_rng_seed seed( 1234 );
+    // Everything within reach, however many it takes
+    m.generate_ahead( point( 1, -1 ), 1000 );
+    CHECK( m.generate_ahead( point( 1, -1 ), 1000 ) == 0 );
+
+    int missing = 0;
+    for( int x = abs_sub.x; x < abs_sub.x + size + 4; x++ ) {
+        for( int y = abs_sub.y - 4; y < abs_sub.y + size; y++ ) {
+            const bool east = x >= abs_sub.x + size;
+            const bool north = y < abs_sub.y;
+            if( ( east || north ) && MAPBUFFER.lookup_submap( x, y, abs_sub.z ) == nullptr ) {
+                missing++;
+            }
+        }
+    }
+    CHECK( missing == 0 );
+    CHECK( m.get_abs_sub() == abs_sub );
+}
@@ -0,0 +1,255 @@
+#include "catch/catch.hpp"
+
+#include "coordinate_conversions.h"
+#include "filesystem.h"
+#include "game.h"
+#include "map.h"
+#include "mapbuffer.h"
+#include "mapdata.h"
+#include "mapsharing.h"
+#include "field.h"
+#include "item.h"
+#include "player.h"
+#include "options.h"
+#include "save_writer.h"
+#include "segment_pack.h"
+#include "submap.h"
+#include "trap.h"
+#include "worldfactory.h"
+
+#include <sstream>
+
+static submap *submap_of( const tripoint &p )
+{
+    const tripoint abs_sub = g->m.get_abs_sub();
+    return MAPBUFFER.lookup_submap( abs_sub.x + p.x / SEEX, abs_sub.y + p.y / SEEY, p.z );
+}
+
+TEST_CASE( "map_changes_mark_submaps_dirty", "[mapbuffer]" )
+{
+    const tripoint p( 65, 65, g->u.posz() );
+    submap *const sm = submap_of( p );
+    REQUIRE( sm != nullptr );
+    sm->mark_saved();
+    REQUIRE( !sm->is_dirty() );
+
+    SECTION( "terrain" ) {
+        g->m.ter_set( p, t_wall );
+    }
+
+    SECTION( "furniture" ) {
+        g->m.furn_set( p, f_table );
+    }
+
+    SECTION( "items" ) {
+        g->m.add_item( p, item( "rock" ) );
+    }
+
+    SECTION( "fields" ) {
+        g->m.add_field( p, fd_blood, 1, 0 );
+    }
+
+    SECTION( "temperature" ) {
+        g->m.set_temperature( p, 20 );
+    }
+
+    CHECK( sm->is_dirty() );
+}
+
+TEST_CASE( "removing_things_marks_submaps_dirty", "[mapbuffer]" )
+{
+    const tripoint p( 65, 65, g->u.posz() );
+    submap *const sm = submap_of( p );
+    REQUIRE( sm != nullptr );
+    g->m.i_clear( p );
+    g->m.add_item( p, item( "rock" ) );
+    g->m.add_field( p, fd_blood, 1, 0 );
+    sm->mark_saved();
+
+    SECTION( "items" ) {
+        auto items = g->m.i_at( p );
+        items.erase( items.begin() );
+    }
+
+    SECTION( "all items" ) {
+        g->m.i_clear( p );
+    }
+
+    SECTION( "fields" ) {
+        g->m.remove_field( p, fd_blood );
+    }
+
+    CHECK( sm->is_dirty() );
+    g->m.i_clear( p );
+    g->m.remove_field( p, fd_blood );
+}
+
+TEST_CASE( "looking_at_a_submap_does_not_mark_it_dirty", "[mapbuffer]" )
+{
+    const tripoint p( 65, 65, g->u.posz() );
+    submap *const sm = submap_of( p );
+    REQUIRE( sm != nullptr );
+    sm->mark_saved();
+
+    g->m.ter( p );
+    g->m.furn( p );
+    g->m.has_items( p );
+    g->m.get_radiation( p );
+
+    CHECK( !sm->is_dirty() );
+}
+
+TEST_CASE( "reading_items_and_fields_does_not_mark_submaps_dirty", "[mapbuffer]" )
+{
+    const tripoint p( 65, 65, g->u.posz() );
+    submap *const sm = submap_of( p );
+    REQUIRE( sm != nullptr );
+    g->m.add_item( p, item( "rock" ) );
+    g->m.add_field( p, fd_blood, 1, 0 );
+    sm->mark_saved();
+
+    // The non-const accessors, like most of the game uses them
+    CHECK( !g->m.i_at( p ).empty() );
+    CHECK( g->m.field_at( p ).findField( fd_blood ) != nullptr );
+    CHECK( g->m.get_field( p, fd_blood ) != nullptr );
+    CHECK( g->m.computer_at( p ) == nullptr );
+    g->m.temperature( p );
+
+    CHECK( !sm->is_dirty() );
+    g->m.i_clear( p );
+    g->m.remove_field( p, fd_blood );
+}
+
+/** Adds a quad of dirt at om_addr, far enough away from the map that saving unloads it. */
+static void add_dirt_quad( const tripoint &om_addr )
+{
+    const tripoint sm_addr = omt_to_sm_copy( om_addr );
+    for( int x = 0; x < 2; x++ ) {
+        for( int y = 0; y < 2; y++ ) {
+            std::unique_ptr<submap> quarter( new submap() );
+            for( int i = 0; i < SEEX; i++ ) {
+                for( int j = 0; j < SEEY; j++ ) {
+                    quarter->set_ter( i, j, t_dirt );
+                }
+            }
+            REQUIRE( MAPBUFFER.add_submap( sm_addr + tripoint( x, y, 0 ), quarter ) );
+        }
+    }
+}
+
+TEST_CASE( "submaps_survive_saving_and_loading", "[mapbuffer]" )
+{
+    auto &format = get_options().get_world_option( "MAP_FORMAT" );
+    const std::string old_format = format.getValue();
+    std::string extension;
+
+    SECTION( "json" ) {
+        format.setValue( "json" );
+        extension = ".map";
+    }
+
+    SECTION( "binary" ) {
+        format.setValue( "binary" );
+        extension = ".bmap";
+    }
+
+    const tripoint om_addr = sm_to_omt_copy( g->m.get_abs_sub() ) + tripoint( 100, 100, 0 );
+    const tripoint sm_addr = omt_to_sm_copy( om_addr );
+    add_dirt_quad( om_addr );
+    submap *sm = MAPBUFFER.lookup_submap( sm_addr );
+    sm->turn_last_touched = 1234;
+    sm->set_ter( 1, 2, t_wall );
+    sm->set_furn( 3, 4, f_table );
+    sm->set_trap( 5, 6, trap_str_id( "tr_bubblewrap" ).id() );
+    sm->set_radiation( 7, 8, 42 );
+    sm->itm[9][10].push_back( item( "rock" ) );
+    sm->fld[11][0].addField( fd_blood, 2, 30 );
+    sm->field_count++;
+    sm->set_graffiti( 0, 11, "graffiti" );
+    sm->spawns.push_back( spawn_point( mtype_id( "mon_zombie" ), 3, 4, 5 ) );
+
+    MAPBUFFER.save();
+    REQUIRE( save_writer::get().flush() );
+
+    // Stored in the pack of the segment, not in a file of its own
+    const tripoint segment_addr = omt_to_seg_copy( om_addr );
+    std::ostringstream segment_dir;
+    segment_dir << world_generator->active_world->world_path << "/maps/" << segment_addr.x << "." <<
+                segment_addr.y << "." << segment_addr.z;
+    std::ostringstream quad_file;
+    quad_file << segment_dir.str() << "/" << om_addr.x << "." << om_addr.y << "." << om_addr.z <<
+              extension;
+    CHECK( file_exist( segment_dir.str() + "/" + segment_packs::index_name ) );
+    CHECK( !file_exist( quad_file.str() ) );
+
+    sm = MAPBUFFER.lookup_submap( sm_addr );
+    REQUIRE( sm != nullptr );
+    CHECK( !sm->is_dirty() );
+    CHECK( sm->turn_last_touched == 1234 );
+    CHECK( sm->get_ter( 0, 0 ) == t_dirt );
+    CHECK( sm->get_ter( 1, 2 ) == t_wall );
+    CHECK( sm->get_furn( 3, 4 ) == f_table );
+    CHECK( sm->get_furn( 4, 3 ) == f_null );
+    CHECK( sm->get_trap( 5, 6 ) == trap_str_id( "tr_bubblewrap" ).id() );
+    CHECK( sm->get_radiation( 7, 8 ) == 42 );
+    CHECK( sm->get_radiation( 8, 7 ) == 0 );
+    REQUIRE( sm->itm[9][10].size() == 1 );
+    CHECK( sm->itm[9][10].front().typeId() == "rock" );
+    REQUIRE( sm->fld[11][0].findField( fd_blood ) != nullptr );
+    CHECK( sm->fld[11][0].findField( fd_blood )->getFieldDensity() == 2 );
+    CHECK( sm->fld[11][0].findField( fd_blood )->getFieldAge() == 30 );
+    CHECK( sm->field_count == 1 );
+    CHECK( sm->get_graffiti( 0, 11 ) == "graffiti" );
+    REQUIRE( sm->spawns.size() == 1 );
+    CHECK( sm->spawns[0].type == mtype_id( "mon_zombie" ) );
+    CHECK( sm->spawns[0].count == 3 );
+    CHECK( sm->spawns[0].posx == 4 );
+    CHECK( sm->spawns[0].posy == 5 );
+
+    // Unloads the quad again
+    MAPBUFFER.save();
+    format.setValue( old_format );
+}
+
+TEST_CASE( "shared_and_packed_saves_load_the_latest_copy", "[mapbuffer]" )
+{
+    const tripoint om_addr = sm_to_omt_copy( g->m.get_abs_sub() ) + tripoint( 104, 100, 0 );
+    const tripoint sm_addr = omt_to_sm_copy( om_addr );
+    add_dirt_quad( om_addr );
+    MAPBUFFER.lookup_submap( sm_addr )->set_ter( 1, 2, t_wall );
+    // Into the pack
+    MAPBUFFER.save();
+
+    // Into a file of its own, the packed copy is outdated
+    MAP_SHARING::setSharing( true );
+    submap *sm = MAPBUFFER.lookup_submap( sm_addr );
+    REQUIRE( sm != nullptr );
+    CHECK( sm->get_ter( 1, 2 ) == t_wall );
+    sm->set_ter( 1, 2, t_floor );
+    MAPBUFFER.save();
+    REQUIRE( save_writer::get().flush() );
+    // Also gone from the index on disk, which the next session reads
+    const tripoint segment_addr = omt_to_seg_copy( om_addr );
+    std::ostringstream segment_dir;
+    segment_dir << world_generator->active_world->world_path << "/maps/" << segment_addr.x << "." <<
+                segment_addr.y << "." << segment_addr.z;
+    segment_packs fresh_packs;
+    bool binary = false;
+    std::string data;
+    CHECK( !fresh_packs.read( segment_dir.str(), om_addr, binary, data ) );
+
+    MAP_SHARING::setSharing( false );
+    sm = MAPBUFFER.lookup_submap( sm_addr );
+    REQUIRE( sm != nullptr );
+    CHECK( sm->get_ter( 1, 2 ) == t_floor );
+    // Back into the pack, the file is outdated
+    sm->set_ter( 1, 2, t_rock_floor );
+    MAPBUFFER.save();
+
+    MAP_SHARING::setSharing( true );
+    sm = MAPBUFFER.lookup_submap( sm_addr );
+    REQUIRE( sm != nullptr );
+    CHECK( sm->get_ter( 1, 2 ) == t_rock_floor );
+    MAPBUFFER.save();
+    MAP_SHARING::setSharing( false );
+}
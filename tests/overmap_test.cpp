@@ -1,6 +1,8 @@
 #include "catch/catch.hpp"
 
+#include "game.h"
 #include "overmap.h"
+#include "overmapbuffer.h"
 
 TEST_CASE( "set_and_get_overmap_scents" ) {
     overmap test_overmap;
@@ -19,3 +21,29 @@ TEST_CASE( "set_and_get_overmap_scents" ) {
     REQUIRE( test_overmap.scent_at( { 75, 85, 0} ).creation_turn == 50 );
     REQUIRE( test_overmap.scent_at( { 75, 85, 0} ).initial_strength == 90 );
 }
+
+TEST_CASE( "overmaps_generated_in_the_background_match_generated_ones", "[overmap]" ) {
+    // Far away from anything the test world has generated so far.
+    const int x = 37;
+    const int y = -23;
+    const overmap_neighbors neighbors = overmap_buffer.get_neighbors( x, y );
+    REQUIRE( overmap_buffer.generate_in_background( x, y ) );
+    // A second one waits until the first is done.
+    CHECK( !overmap_buffer.generate_in_background( x + 1, y ) );
+
+    const overmap &background = overmap_buffer.get( x, y );
+    const overmap generated( x, y, neighbors, g->get_seed() );
+    CHECK( !overmap_buffer.generate_in_background( x, y ) );
+
+    int differences = 0;
+    for( int z = -OVERMAP_DEPTH; z <= OVERMAP_HEIGHT; ++z ) {
+        for( int i = 0; i < OMAPX; ++i ) {
+            for( int j = 0; j < OMAPY; ++j ) {
+                if( background.get_ter( i, j, z ) != generated.get_ter( i, j, z ) ) {
+                    differences++;
+                }
+            }
+        }
+    }
+    CHECK( differences == 0 );
+}
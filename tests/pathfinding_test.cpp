@@ -0,0 +1,193 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "line.h"
+#include "map.h"
+#include "mapdata.h"
+#include "pathfinding.h"
+#include "player.h"
+#include "vehicle.h"
+#include "veh_type.h"
+
+#include <algorithm>
+#include <vector>
+
+static void fill_map_terrain( ter_id terrain )
+{
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            g->m.set( x, y, terrain, f_null );
+        }
+    }
+}
+
+static void check_path( const std::vector<tripoint> &path, const tripoint &from,
+                        const tripoint &to )
+{
+    REQUIRE_FALSE( path.empty() );
+    CHECK( path.back() == to );
+    tripoint prev = from;
+    for( const tripoint &p : path ) {
+        INFO( "step " << p.x << "," << p.y );
+        CHECK( square_dist( prev, p ) == 1 );
+        CHECK( g->m.passable( p ) );
+        prev = p;
+    }
+}
+
+TEST_CASE( "route_around_wall", "[pathfinding]" )
+{
+    fill_map_terrain( t_grass );
+    // Player would be pre-closed by NPCs, keep them out of the way
+    g->u.setpos( { 0, 0, -2 } );
+
+    // A wall across the whole map with a single gap, forcing a detour
+    const int mapsize = g->m.getmapsize() * SEEX;
+    const int wall_x = mapsize / 2;
+    const int gap_y = mapsize - 5;
+    for( int y = 0; y < mapsize; ++y ) {
+        if( y != gap_y ) {
+            g->m.ter_set( wall_x, y, t_wall );
+        }
+    }
+
+    const pathfinding_settings settings( 0, 1000, 10000, false, false, false );
+
+    SECTION( "short path" ) {
+        const tripoint from( wall_x - 3, gap_y - 3, 0 );
+        const tripoint to( wall_x + 3, gap_y - 3, 0 );
+        check_path( g->m.route( from, to, settings ), from, to );
+    }
+
+    SECTION( "long path through the abstract graph" ) {
+        const tripoint from( wall_x - 20, 10, 0 );
+        const tripoint to( wall_x + 20, 10, 0 );
+        const auto path = g->m.route( from, to, settings );
+        check_path( path, from, to );
+        CHECK( std::find( path.begin(), path.end(), tripoint( wall_x, gap_y, 0 ) ) != path.end() );
+    }
+
+    SECTION( "repeated routes reuse the pathfinder" ) {
+        const tripoint from( wall_x - 5, 10, 0 );
+        const tripoint to( wall_x - 5, 40, 0 );
+        const auto first = g->m.route( from, to, settings );
+        const auto second = g->m.route( from, to, settings );
+        check_path( first, from, to );
+        CHECK( first == second );
+    }
+
+    SECTION( "closing the gap invalidates the abstract graph" ) {
+        g->m.ter_set( wall_x, gap_y, t_wall );
+        const tripoint from( wall_x - 20, 10, 0 );
+        const tripoint to( wall_x + 20, 10, 0 );
+        CHECK( g->m.route( from, to, settings ).empty() );
+    }
+
+    SECTION( "flow field paths to a shared target" ) {
+        const tripoint to( wall_x + 3, gap_y - 3, 0 );
+        for( const tripoint &from : { tripoint( wall_x - 20, 10, 0 ), tripoint( wall_x - 3, gap_y, 0 ),
+                                      tripoint( wall_x + 10, 5, 0 ) } ) {
+            const auto path = g->m.route_flow( from, to, settings );
+            check_path( path, from, to );
+            if( from.x < wall_x ) {
+                CHECK( std::find( path.begin(), path.end(), tripoint( wall_x, gap_y, 0 ) ) != path.end() );
+            }
+        }
+    }
+
+    SECTION( "flow fields end at the maximum distance" ) {
+        // The only way around the wall leaves the area the creature may path through
+        const pathfinding_settings near( 0, 10, 10000, false, false, false );
+        const tripoint from( wall_x - 3, 10, 0 );
+        const tripoint to( wall_x + 3, 10, 0 );
+        CHECK( g->m.route_flow( from, to, near ).empty() );
+        check_path( g->m.route_flow( from, to, settings ), from, to );
+    }
+
+    fill_map_terrain( t_grass );
+}
+
+TEST_CASE( "flow_fields_group_bash_strengths", "[pathfinding]" )
+{
+    CHECK( flow_bash_strength( 0 ) == 0 );
+    int previous = 0;
+    int grouped = 0;
+    for( int bash = 1; bash < 200; bash++ ) {
+        const int rounded = flow_bash_strength( bash );
+        CHECK( rounded <= bash );
+        CHECK( rounded >= previous );
+        // A threshold rounds to itself
+        CHECK( flow_bash_strength( rounded ) == rounded );
+        if( rounded != bash ) {
+            grouped++;
+        }
+        previous = rounded;
+    }
+    // Terrain only distinguishes a few strengths
+    CHECK( grouped > 100 );
+}
+
+TEST_CASE( "path_abstraction_rebuilds_only_what_changed", "[pathfinding]" )
+{
+    fill_map_terrain( t_grass );
+    g->u.setpos( { 0, 0, -2 } );
+    const pathfinding_abstraction &abstraction = g->m.get_pathfinding_abstraction_ref( 0, false );
+    uint64_t rebuilt = abstraction.get_stats().rebuilt_submaps;
+
+    SECTION( "terrain" ) {
+        // The submap and its four neighbours, which share its borders
+        g->m.ter_set( tripoint( 5 * SEEX + 6, 5 * SEEY + 6, 0 ), t_wall );
+        g->m.get_pathfinding_abstraction_ref( 0, false );
+        CHECK( abstraction.get_stats().rebuilt_submaps == rebuilt + 5 );
+        g->m.ter_set( tripoint( 5 * SEEX + 6, 5 * SEEY + 6, 0 ), t_grass );
+    }
+
+    SECTION( "vehicles" ) {
+        vehicle *car = g->m.add_vehicle( vproto_id( "car" ), tripoint( 5 * SEEX + 6, 5 * SEEY + 6, 0 ),
+                                         0, 0, 0 );
+        REQUIRE( car != nullptr );
+        g->m.get_pathfinding_abstraction_ref( 0, false );
+        rebuilt = abstraction.get_stats().rebuilt_submaps;
+
+        tripoint pos = car->global_pos3();
+        REQUIRE( g->m.displace_vehicle( pos, tripoint( 1, 0, 0 ) ) == car );
+        g->m.get_pathfinding_abstraction_ref( 0, false );
+        const uint64_t moved = abstraction.get_stats().rebuilt_submaps - rebuilt;
+        CHECK( moved > 0 );
+        // The submaps under the car and their neighbours, not the whole map
+        CHECK( moved <= 12 );
+        g->m.destroy_vehicle( car );
+    }
+}
+
+TEST_CASE( "long_routes_lead_through_doors", "[pathfinding]" )
+{
+    fill_map_terrain( t_grass );
+    g->u.setpos( { 0, 0, -2 } );
+
+    const int mapsize = g->m.getmapsize() * SEEX;
+    const int wall_x = mapsize / 2;
+    const tripoint door( wall_x, 10, 0 );
+    for( int y = 0; y < mapsize; ++y ) {
+        g->m.ter_set( wall_x, y, t_wall_metal );
+    }
+    g->m.ter_set( door, t_door_c );
+
+    const tripoint from( wall_x - 20, 10, 0 );
+    const tripoint to( wall_x + 20, 10, 0 );
+    const pathfinding_abstraction &abstraction = g->m.get_pathfinding_abstraction_ref( 0, true );
+    const uint64_t searches = abstraction.get_stats().searches;
+
+    const pathfinding_settings opens_doors( 0, 1000, 10000, true, false, false );
+    const auto path = g->m.route( from, to, opens_doors );
+    REQUIRE_FALSE( path.empty() );
+    CHECK( path.back() == to );
+    CHECK( std::find( path.begin(), path.end(), door ) != path.end() );
+    CHECK( abstraction.get_stats().searches > searches );
+
+    const pathfinding_settings walks( 0, 1000, 10000, false, false, false );
+    CHECK( g->m.route( from, to, walks ).empty() );
+
+    fill_map_terrain( t_grass );
+}
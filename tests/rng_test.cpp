@@ -0,0 +1,84 @@
+#include "catch/catch.hpp"
+
+#include "rng.h"
+
+#include <vector>
+
+static std::vector<long> sample( const int count )
+{
+    std::vector<long> result;
+    for( int i = 0; i < count; i++ ) {
+        result.push_back( rng( -1000, 1000 ) );
+    }
+    return result;
+}
+
+TEST_CASE( "rng_stays_within_bounds", "[rng]" )
+{
+    scoped_rng_seed seed( 42 );
+    bool seen_min = false;
+    bool seen_max = false;
+    for( int i = 0; i < 10000; i++ ) {
+        const long r = rng( 3, -2 );
+        REQUIRE( r >= -2 );
+        REQUIRE( r <= 3 );
+        seen_min |= r == -2;
+        seen_max |= r == 3;
+        const double f = rng_float( 0.5, 1.5 );
+        REQUIRE( f >= 0.5 );
+        REQUIRE( f < 1.5 );
+    }
+    CHECK( seen_min );
+    CHECK( seen_max );
+    CHECK( rng( 7, 7 ) == 7 );
+    CHECK( one_in( 1 ) );
+    CHECK( x_in_y( 1, 1 ) );
+    CHECK( !x_in_y( 0, 1 ) );
+}
+
+TEST_CASE( "rng_sequences_can_be_replayed", "[rng]" )
+{
+    rng_engine engine( 1234 );
+    std::vector<long> first;
+    std::vector<long> second;
+    {
+        scoped_rng_engine use( engine );
+        sample( 10 );
+        const rng_engine::state_type saved = engine.state();
+        first = sample( 100 );
+        engine.set_state( saved );
+    }
+    {
+        scoped_rng_engine use( engine );
+        second = sample( 100 );
+    }
+    CHECK( first == second );
+
+    // The same seed gives the same numbers, on any engine.
+    {
+        scoped_rng_seed seed( 99 );
+        first = sample( 100 );
+    }
+    {
+        scoped_rng_seed seed( 99 );
+        second = sample( 100 );
+    }
+    CHECK( first == second );
+}
+
+TEST_CASE( "scoped_rng_engines_leave_the_default_engine_alone", "[rng]" )
+{
+    const rng_engine::state_type before = rng_get_engine().state();
+    rng_engine stream( 5 );
+    {
+        scoped_rng_engine use( stream );
+        sample( 10 );
+        {
+            scoped_rng_seed inner( 6 );
+            sample( 10 );
+        }
+        CHECK( &rng_get_engine() == &stream );
+    }
+    CHECK( rng_get_engine().state() == before );
+    CHECK( stream.state() != rng_engine( 5 ).state() );
+}
@@ -0,0 +1,40 @@
+#include "catch/catch.hpp"
+
+#include "cata_utility.h"
+#include "filesystem.h"
+#include "save_writer.h"
+
+#include <sstream>
+#include <string>
+
+static std::string read_back( const std::string &path )
+{
+    std::string result;
+    read_from_file( path, [&result]( std::istream & fin ) {
+        std::ostringstream buffer;
+        buffer << fin.rdbuf();
+        result = buffer.str();
+    } );
+    return result;
+}
+
+TEST_CASE( "reading_waits_for_background_writes", "[save_writer]" )
+{
+    const std::string path = "save_writer_test.txt";
+
+    for( int i = 0; i < 20; ++i ) {
+        const bool exclusive = i % 2 == 0;
+        save_writer::get().write( path, std::string( 100000, 'a' + i ), exclusive, "test data" );
+    }
+    CHECK( read_back( path ) == std::string( 100000, 'a' + 19 ) );
+
+    write_to_file_async( path, []( std::ostream & fout ) {
+        fout << "last";
+    }, "test data" );
+    CHECK( read_back( path ) == "last" );
+
+    CHECK( save_writer::get().flush() );
+    CHECK( !file_exist( path + ".temp" ) );
+    CHECK( !file_exist( path + ".lock" ) );
+    remove_file( path );
+}
@@ -0,0 +1,76 @@
+#include "catch/catch.hpp"
+
+#include "scent_diffusion.h"
+
+#include <memory>
+#include <random>
+
+using scent_diffusion::grid;
+using scent_diffusion::kernel;
+
+static constexpr int minx = 20;
+static constexpr int maxx = 100;
+static constexpr int miny = 22;
+static constexpr int maxy = 98;
+
+TEST_CASE( "scent_kernels_match_scalar", "[scent]" )
+{
+    std::unique_ptr<grid> scent( new grid() );
+    std::unique_ptr<grid> weights( new grid() );
+    std::mt19937 gen( 5 );
+    std::uniform_int_distribution<int> scent_dist( 0, 1000 );
+    const int terrain[] = {
+        scent_diffusion::WEIGHT_BLOCK, scent_diffusion::WEIGHT_REDUCE,
+        scent_diffusion::WEIGHT_NORMAL, scent_diffusion::WEIGHT_NORMAL
+    };
+    for( size_t x = 0; x < scent->size(); ++x ) {
+        for( size_t y = 0; y < ( *scent )[x].size(); ++y ) {
+            ( *scent )[x][y] = scent_dist( gen );
+            ( *weights )[x][y] = terrain[gen() % 4];
+        }
+    }
+
+    std::unique_ptr<grid> expected( new grid( *scent ) );
+    for( int i = 0; i < 10; ++i ) {
+        scent_diffusion::diffuse( *expected, *weights, minx, miny, maxx, maxy, kernel::scalar );
+    }
+
+    for( const kernel k : {
+             kernel::sse4_1, kernel::avx2
+         } ) {
+        if( !scent_diffusion::supported( k ) ) {
+            continue;
+        }
+        INFO( scent_diffusion::name( k ) );
+        std::unique_ptr<grid> actual( new grid( *scent ) );
+        for( int i = 0; i < 10; ++i ) {
+            scent_diffusion::diffuse( *actual, *weights, minx, miny, maxx, maxy, k );
+        }
+        CHECK( *actual == *expected );
+    }
+}
+
+TEST_CASE( "scent_does_not_pass_walls", "[scent]" )
+{
+    std::unique_ptr<grid> scent( new grid() );
+    std::unique_ptr<grid> weights( new grid() );
+    for( auto &column : *weights ) {
+        column.fill( scent_diffusion::WEIGHT_NORMAL );
+    }
+    for( int y = miny - 1; y <= maxy + 1; ++y ) {
+        ( *weights )[60][y] = scent_diffusion::WEIGHT_BLOCK;
+    }
+    ( *scent )[55][60] = 1000;
+
+    for( int i = 0; i < 20; ++i ) {
+        scent_diffusion::diffuse( *scent, *weights, minx, miny, maxx, maxy );
+    }
+    CHECK( ( *scent )[56][60] > 0 );
+    int behind_wall = 0;
+    for( int x = 60; x <= maxx; ++x ) {
+        for( int y = miny; y <= maxy; ++y ) {
+            behind_wall += ( *scent )[x][y];
+        }
+    }
+    CHECK( behind_wall == 0 );
+}
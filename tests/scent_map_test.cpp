@@ -0,0 +1,40 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "scent_map.h"
+
+TEST_CASE( "scent_spreads_between_z_levels_through_open_air", "[scent]" )
+{
+    const int z = g->get_levz();
+    const tripoint center( 60, 60, z );
+    const tripoint above = center + tripoint( 0, 0, 1 );
+    const int maxz = g->m.has_zlevels() ? z + 1 : z;
+    for( int lz = z; lz <= maxz; ++lz ) {
+        for( int x = 10; x < 110; ++x ) {
+            for( int y = 10; y < 110; ++y ) {
+                g->m.ter_set( tripoint( x, y, lz ), t_floor );
+            }
+        }
+    }
+    g->scent.reset();
+    g->scent.set( center, 1000 );
+
+    SECTION( "scent stays below a floor" ) {
+        g->scent.update( center, g->m );
+        CHECK( g->scent.get( center + tripoint( 1, 0, 0 ) ) > 0 );
+        CHECK( g->scent.get( above ) == 0 );
+    }
+
+    if( g->m.has_zlevels() ) {
+        SECTION( "scent rises through a hole" ) {
+            g->m.ter_set( above, t_open_air );
+            g->scent.update( center, g->m );
+            CHECK( g->scent.get( above ) > 0 );
+            CHECK( g->scent.get( above + tripoint( 5, 0, 0 ) ) == 0 );
+        }
+    }
+
+    g->scent.reset();
+}
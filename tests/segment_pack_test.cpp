@@ -0,0 +1,87 @@
+#include "catch/catch.hpp"
+
+#include "filesystem.h"
+#include "save_writer.h"
+#include "segment_pack.h"
+#include "worldfactory.h"
+
+#include <fstream>
+#include <string>
+
+static std::string quad_data( const int round, const int quad )
+{
+    return std::string( 20000 + quad, 'a' + round );
+}
+
+static void check_latest( segment_packs &packs, const std::string &dir )
+{
+    for( int quad = 0; quad < 10; quad++ ) {
+        bool binary = false;
+        std::string data;
+        REQUIRE( packs.read( dir, tripoint( quad, 0, 0 ), binary, data ) );
+        CHECK( data == quad_data( 19, quad ) );
+        CHECK( binary == ( quad % 2 == 0 ) );
+    }
+    bool binary = false;
+    std::string data;
+    CHECK( !packs.read( dir, tripoint( 10, 0, 0 ), binary, data ) );
+}
+
+TEST_CASE( "segment_packs_keep_the_latest_copy_of_each_quad", "[segment_pack]" )
+{
+    const std::string dir = world_generator->active_world->world_path + "/segment_pack_test";
+    REQUIRE( assure_dir_exist( dir ) );
+
+    {
+        segment_packs packs;
+        for( int round = 0; round < 20; round++ ) {
+            for( int quad = 0; quad < 10; quad++ ) {
+                packs.write( dir, tripoint( quad, 0, 0 ), quad % 2 == 0, quad_data( round, quad ) );
+            }
+        }
+        check_latest( packs, dir );
+        packs.flush();
+    }
+    REQUIRE( save_writer::get().flush() );
+
+    // The outdated copies have been compacted away
+    const std::vector<std::string> data_files = get_files_from_path( ".pack", dir, false, true );
+    REQUIRE( data_files.size() == 1 );
+    std::ifstream data_file( data_files.front(), std::ios::binary | std::ios::ate );
+    // At most twice the live data, plus the record that triggers compaction
+    CHECK( data_file.tellg() <= 2 * 10 * 20010 + 20010 );
+
+    // Reads the index written by the other instance
+    segment_packs packs;
+    check_latest( packs, dir );
+}
+
+TEST_CASE( "segment_packs_write_the_index_on_flush", "[segment_pack]" )
+{
+    const std::string dir = world_generator->active_world->world_path + "/segment_pack_index_test";
+    REQUIRE( assure_dir_exist( dir ) );
+    const std::string index = dir + "/" + segment_packs::index_name;
+    remove_file( index );
+
+    {
+        segment_packs packs;
+        packs.write( dir, tripoint( 0, 0, 0 ), false, quad_data( 0, 0 ) );
+        packs.write( dir, tripoint( 1, 0, 0 ), false, quad_data( 0, 1 ) );
+        REQUIRE( save_writer::get().flush() );
+        CHECK( !file_exist( index ) );
+        packs.flush();
+        REQUIRE( save_writer::get().flush() );
+        CHECK( file_exist( index ) );
+
+        packs.remove( dir, tripoint( 0, 0, 0 ) );
+        packs.flush();
+    }
+    REQUIRE( save_writer::get().flush() );
+
+    segment_packs packs;
+    bool binary = false;
+    std::string data;
+    CHECK( !packs.read( dir, tripoint( 0, 0, 0 ), binary, data ) );
+    REQUIRE( packs.read( dir, tripoint( 1, 0, 0 ), binary, data ) );
+    CHECK( data == quad_data( 0, 1 ) );
+}
@@ -0,0 +1,95 @@
+#include "catch/catch.hpp"
+
+#include "simplexnoise.h"
+
+#include <array>
+#include <vector>
+
+// Values of the single point functions before they were built on the batched ones,
+// at the points from golden_point. Builds with -O3 -ffast-math differ in the last bits.
+static const size_t golden_count = 12;
+static const std::array<float, golden_count> golden_raw_2d = {{
+    -0.6716884f, 0.3881503f, 0.0443580f, 0.4630979f, -0.5281217f, -0.5593722f,
+    0.5384647f, 0.2004135f, 0.3012579f, 0.6302700f, -0.2080534f, 0.3121891f
+}};
+static const std::array<float, golden_count> golden_raw_3d = {{
+    -0.3508534f, -0.5677378f, 0.2460825f, -0.1470486f, 0.2215569f, -0.4956196f,
+    0.2329967f, -0.9407777f, 0.2931366f, -0.0488948f, -0.6098524f, -0.1149909f
+}};
+static const std::array<float, golden_count> golden_raw_4d = {{
+    -0.0548029f, 0.1050806f, -0.3078060f, -0.2534177f, 0.2231327f, 0.2669776f,
+    -0.4164479f, 0.1025974f, 0.1213946f, 0.0757733f, 0.1406414f, -0.2636125f
+}};
+static const std::array<float, golden_count> golden_octave_2d = {{
+    0.0813522f, 0.0184324f, -0.0345345f, -0.2390483f, -0.2770416f, 0.0016017f,
+    -0.1947157f, 0.1490301f, 0.3547672f, 0.3297194f, 0.2735227f, -0.0314910f
+}};
+static const std::array<float, golden_count> golden_octave_3d = {{
+    0.0890255f, -0.2674159f, -0.1331420f, 0.4372682f, 0.0348174f, -0.0560761f,
+    -0.4936689f, 0.3013138f, -0.1524675f, 0.2217678f, 0.1348563f, -0.4969621f
+}};
+static const std::array<float, golden_count> golden_octave_4d = {{
+    0.4898544f, 0.1554671f, 0.0746625f, -0.0505440f, -0.0844683f, -0.3336545f,
+    -0.0661148f, 0.2620253f, 0.2669441f, -0.0711521f, 0.0712554f, 0.0533841f
+}};
+
+static void golden_point( const size_t i, float &x, float &y, float &z, float &w )
+{
+    x = i * 3.71f - 19.87f;
+    y = i * -1.13f + 3.43f;
+    z = ( i % 7 ) * 2.9f + 0.31f;
+    w = 101.17f + i % 3;
+}
+
+static void check_noise( const std::vector<float> &out,
+                         const std::array<float, golden_count> &expected )
+{
+    for( size_t i = 0; i < out.size(); ++i ) {
+        CHECK( out[i] == Approx( expected[i % golden_count] ).epsilon( 1e-4 ) );
+    }
+}
+
+TEST_CASE( "single_point_noise_matches_recorded_values", "[simplexnoise]" )
+{
+    std::vector<float> raw2, raw3, raw4, octave2, octave3, octave4;
+    for( size_t i = 0; i < golden_count; ++i ) {
+        float x, y, z, w;
+        golden_point( i, x, y, z, w );
+        raw2.push_back( raw_noise_2d( x, y ) );
+        raw3.push_back( raw_noise_3d( x, y, z ) );
+        raw4.push_back( raw_noise_4d( x, y, z, w ) );
+        octave2.push_back( octave_noise_2d( 4, 0.5f, 0.1f, x, y ) );
+        octave3.push_back( octave_noise_3d( 3, 0.6f, 0.2f, x, y, z ) );
+        octave4.push_back( octave_noise_4d( 5, 0.4f, 0.05f, x, y, z, w ) );
+    }
+    check_noise( raw2, golden_raw_2d );
+    check_noise( raw3, golden_raw_3d );
+    check_noise( raw4, golden_raw_4d );
+    check_noise( octave2, golden_octave_2d );
+    check_noise( octave3, golden_octave_3d );
+    check_noise( octave4, golden_octave_4d );
+}
+
+TEST_CASE( "batched_noise_matches_recorded_values", "[simplexnoise]" )
+{
+    // More points than a batch, so the remainder of the last batch is covered too.
+    const size_t count = 150;
+    std::vector<float> x( count ), y( count ), z( count ), w( count );
+    for( size_t i = 0; i < count; ++i ) {
+        golden_point( i % golden_count, x[i], y[i], z[i], w[i] );
+    }
+    std::vector<float> out( count );
+
+    raw_noise_2d( x.data(), y.data(), out.data(), count );
+    check_noise( out, golden_raw_2d );
+    raw_noise_3d( x.data(), y.data(), z.data(), out.data(), count );
+    check_noise( out, golden_raw_3d );
+    raw_noise_4d( x.data(), y.data(), z.data(), w.data(), out.data(), count );
+    check_noise( out, golden_raw_4d );
+    octave_noise_2d( 4, 0.5f, 0.1f, x.data(), y.data(), out.data(), count );
+    check_noise( out, golden_octave_2d );
+    octave_noise_3d( 3, 0.6f, 0.2f, x.data(), y.data(), z.data(), out.data(), count );
+    check_noise( out, golden_octave_3d );
+    octave_noise_4d( 5, 0.4f, 0.05f, x.data(), y.data(), z.data(), w.data(), out.data(), count );
+    check_noise( out, golden_octave_4d );
+}
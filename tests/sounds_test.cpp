@@ -0,0 +1,40 @@
+#include "catch/catch.hpp"
+
+#include "creature_tracker.h"
+#include "game.h"
+#include "monster.h"
+#include "player.h"
+#include "sounds.h"
+
+static monster &add_listener( const tripoint &p )
+{
+    monster critter( mtype_id( "mon_zombie" ), p );
+    critter.anger = 100;
+    critter.wandf = 0;
+    g->critter_tracker->add( critter );
+    return g->zombie( g->num_zombies() - 1 );
+}
+
+TEST_CASE( "monsters_hear_only_sounds_in_range", "[sounds]" )
+{
+    g->clear_zombies();
+    sounds::reset_sounds();
+    const int z = g->u.posz();
+    const tripoint source( 10, 60, z );
+
+    monster &nearby = add_listener( source + tripoint( 10, 0, 0 ) );
+    monster &distant = add_listener( source + tripoint( 100, 0, 0 ) );
+    monster &above = add_listener( source + tripoint( 5, 5, 1 ) );
+
+    sounds::sound( source, 60, "bang" );
+    sounds::process_sounds();
+
+    CHECK( nearby.wandf > 0 );
+    CHECK( nearby.wander_pos.z == z );
+    CHECK( distant.wandf == 0 );
+    // Sounds carry between z-levels like on the same one
+    CHECK( above.wandf > 0 );
+
+    sounds::reset_sounds();
+    g->clear_zombies();
+}
@@ -8,6 +8,7 @@
 #include "morale.h"
 #include "path_info.h"
 #include "player.h"
+#include "rng.h"
 #include "worldfactory.h"
 #include "debug.h"
 #include "mod_manager.h"
@@ -70,6 +71,9 @@ void init_global_game_state( const std::vector<std::string> &mods )
     get_options().load();
     init_colors();
 
+    // Same random numbers on every run, like rand() that isn't seeded
+    rng_set_engine_seed( 1 );
+
     g = new game;
 
     g->load_static_data();
@@ -0,0 +1,39 @@
+#include "catch/catch.hpp"
+
+#include "thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+TEST_CASE( "thread_pool_runs_every_task_once", "[thread_pool]" )
+{
+    for( size_t workers : { 0, 1, 3 } ) {
+        thread_pool pool( workers );
+        CHECK( pool.size() == workers + 1 );
+
+        for( size_t count : { 0, 1, 7, 1000 } ) {
+            std::vector<std::atomic<int>> calls( count );
+            for( auto &c : calls ) {
+                c = 0;
+            }
+            pool.run( count, [&calls]( size_t i ) {
+                calls[i]++;
+            } );
+            for( const auto &c : calls ) {
+                CHECK( c == 1 );
+            }
+        }
+    }
+}
+
+TEST_CASE( "thread_pool_nested_run_is_serial", "[thread_pool]" )
+{
+    thread_pool pool( 2 );
+    std::atomic<int> total( 0 );
+    pool.run( 4, [&pool, &total]( size_t ) {
+        pool.run( 10, [&total]( size_t i ) {
+            total += i;
+        } );
+    } );
+    CHECK( total == 4 * 45 );
+}
@@ -0,0 +1,82 @@
+#include "catch/catch.hpp"
+
+#include "turn_profiler.h"
+
+TEST_CASE( "turn_profiler_rolling_window" )
+{
+    turn_profiler::phase_stats stats;
+    REQUIRE( stats.size() == 0 );
+    REQUIRE( stats.mean() == 0.0 );
+
+    for( uint32_t i = 1; i <= 100; i++ ) {
+        stats.add( i );
+    }
+    CHECK( stats.size() == 100 );
+    CHECK( stats.recent( 0 ) == 100 );
+    CHECK( stats.recent( 99 ) == 1 );
+    CHECK( stats.mean() == Approx( 50.5 ) );
+    CHECK( stats.percentile( 50 ) == 51 );
+    CHECK( stats.max() == 100 );
+
+    // Overflow the window: only the newest samples may remain.
+    for( size_t i = 0; i < turn_profiler::window_size; i++ ) {
+        stats.add( 7 );
+    }
+    CHECK( stats.size() == turn_profiler::window_size );
+    CHECK( stats.mean() == Approx( 7.0 ) );
+    CHECK( stats.percentile( 95 ) == 7 );
+    // The lifetime maximum survives the window.
+    CHECK( stats.max() == 100 );
+
+    uint32_t bucketed = 0;
+    for( const auto count : stats.buckets() ) {
+        bucketed += count;
+    }
+    CHECK( bucketed == turn_profiler::window_size );
+    // 7 microseconds falls into [4, 8).
+    CHECK( stats.buckets()[3] == turn_profiler::window_size );
+}
+
+TEST_CASE( "turn_profiler_accumulates_phases_per_turn" )
+{
+    using namespace std::chrono;
+    turn_profiler::reset();
+
+    turn_profiler::record( turn_phase::monmove, microseconds( 30 ) );
+    turn_profiler::record( turn_phase::monmove, microseconds( 20 ) );
+    turn_profiler::record( turn_phase::process_fields, microseconds( 10 ) );
+    turn_profiler::finish_turn();
+
+    CHECK( turn_profiler::get_stats( turn_phase::monmove ).recent( 0 ) == 50 );
+    CHECK( turn_profiler::get_stats( turn_phase::process_fields ).recent( 0 ) == 10 );
+    CHECK( turn_profiler::get_stats( turn_phase::vehmove ).recent( 0 ) == 0 );
+    CHECK( turn_profiler::get_total_stats().recent( 0 ) == 60 );
+
+    turn_profiler::finish_turn();
+    CHECK( turn_profiler::get_stats( turn_phase::monmove ).recent( 0 ) == 0 );
+    CHECK( turn_profiler::get_total_stats().size() == 2 );
+}
+
+static bool turn_ending_early( const bool early )
+{
+    turn_profiler::turn_guard profiled_turn;
+    turn_profiler::record( turn_phase::process_events, std::chrono::microseconds( 5 ) );
+    if( early ) {
+        return true;
+    }
+    turn_profiler::record( turn_phase::monmove, std::chrono::microseconds( 7 ) );
+    return false;
+}
+
+TEST_CASE( "turn_profiler_guard_ends_turns_on_every_return" )
+{
+    turn_profiler::reset();
+
+    turn_ending_early( true );
+    CHECK( turn_profiler::get_total_stats().size() == 1 );
+    CHECK( turn_profiler::get_total_stats().recent( 0 ) == 5 );
+
+    turn_ending_early( false );
+    CHECK( turn_profiler::get_total_stats().size() == 2 );
+    CHECK( turn_profiler::get_total_stats().recent( 0 ) == 12 );
+}
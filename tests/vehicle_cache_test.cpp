@@ -0,0 +1,78 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "vehicle.h"
+#include "veh_type.h"
+
+#include <set>
+
+static std::set<tripoint> part_squares( const vehicle &veh )
+{
+    std::set<tripoint> squares;
+    for( size_t i = 0; i < veh.parts.size(); i++ ) {
+        if( !veh.parts[i].removed ) {
+            squares.insert( veh.global_part_pos3( i ) );
+        }
+    }
+    return squares;
+}
+
+static void check_cached( const vehicle &veh )
+{
+    for( const tripoint &p : part_squares( veh ) ) {
+        int part = -1;
+        const vehicle *found = g->m.veh_at( p, part );
+        REQUIRE( found == &veh );
+        REQUIRE( part >= 0 );
+        CHECK( veh.global_part_pos3( part ) == p );
+    }
+}
+
+TEST_CASE( "vehicle_cache_follows_moved_and_removed_vehicles", "[vehicle]" )
+{
+    const int z = g->get_levz();
+    for( int x = 30; x < 100; x++ ) {
+        for( int y = 50; y < 80; y++ ) {
+            const tripoint p( x, y, z );
+            if( g->m.veh_at( p ) != nullptr ) {
+                g->m.destroy_vehicle( g->m.veh_at( p ) );
+            }
+            g->m.ter_set( p, t_pavement );
+            g->m.furn_set( p, f_null );
+        }
+    }
+
+    vehicle *first = g->m.add_vehicle( vproto_id( "car" ), tripoint( 40, 55, z ), 0, 0, 0 );
+    vehicle *second = g->m.add_vehicle( vproto_id( "car" ), tripoint( 40, 70, z ), 0, 0, 0 );
+    REQUIRE( first != nullptr );
+    REQUIRE( second != nullptr );
+    check_cached( *first );
+    check_cached( *second );
+
+    const std::set<tripoint> first_start = part_squares( *first );
+    tripoint pos = first->global_pos3();
+    REQUIRE( g->m.displace_vehicle( pos, tripoint( 20, 0, 0 ) ) == first );
+    const std::set<tripoint> first_end = part_squares( *first );
+    check_cached( *first );
+    for( const tripoint &p : first_start ) {
+        if( first_end.count( p ) == 0 ) {
+            CHECK( g->m.veh_at( p ) == nullptr );
+        }
+    }
+
+    // The freed entry of the second car is reused by the third one.
+    const std::set<tripoint> second_squares = part_squares( *second );
+    g->m.destroy_vehicle( second );
+    for( const tripoint &p : second_squares ) {
+        CHECK( g->m.veh_at( p ) == nullptr );
+    }
+    vehicle *third = g->m.add_vehicle( vproto_id( "car" ), tripoint( 80, 70, z ), 0, 0, 0 );
+    REQUIRE( third != nullptr );
+    check_cached( *first );
+    check_cached( *third );
+
+    g->m.destroy_vehicle( first );
+    g->m.destroy_vehicle( third );
+}
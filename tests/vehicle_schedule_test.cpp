@@ -0,0 +1,91 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "vehicle.h"
+#include "vehicle_schedule.h"
+#include "veh_type.h"
+
+#include <array>
+
+TEST_CASE( "vehicle_schedule_moves_the_fastest_first", "[vehicle]" )
+{
+    std::array<vehicle, 4> vehs;
+    vehs[0].of_turn = 1;
+    vehs[1].of_turn = 3;
+    vehs[2].of_turn = 3;
+    vehs[3].of_turn = 0;
+    vehs[3].falling = true;
+
+    vehicle_schedule schedule;
+    for( vehicle &veh : vehs ) {
+        schedule.update( veh );
+    }
+
+    // Ties go to the one added first.
+    REQUIRE( schedule.next() == &vehs[1] );
+    vehs[1].of_turn = 0.5f;
+    schedule.moved( &vehs[1] );
+    CHECK( schedule.next() == &vehs[2] );
+    vehs[2].of_turn = 0;
+    schedule.moved( &vehs[2] );
+
+    // Changed elsewhere, without an update.
+    vehs[0].of_turn = 0.25f;
+    CHECK( schedule.next() == &vehs[1] );
+    vehs[1].of_turn = 0;
+    schedule.moved( &vehs[1] );
+    CHECK( schedule.next() == &vehs[0] );
+    vehs[0].of_turn = 0;
+    schedule.moved( &vehs[0] );
+
+    // Falling ones come last and stay until they land.
+    CHECK( schedule.next() == &vehs[3] );
+    CHECK( schedule.next() == &vehs[3] );
+    schedule.remove( &vehs[3] );
+    CHECK( schedule.next() == nullptr );
+
+    // Removed vehicles are not touched again.
+    vehs[2].of_turn = 2;
+    schedule.update( vehs[2] );
+    schedule.remove( &vehs[2] );
+    schedule.moved( &vehs[2] );
+    CHECK( schedule.next() == nullptr );
+}
+
+TEST_CASE( "vehmove_moves_only_the_moving_vehicle", "[vehicle]" )
+{
+    const int z = g->get_levz();
+    for( int x = 30; x < 100; x++ ) {
+        for( int y = 50; y < 80; y++ ) {
+            const tripoint p( x, y, z );
+            if( g->m.veh_at( p ) != nullptr ) {
+                g->m.destroy_vehicle( g->m.veh_at( p ) );
+            }
+            g->m.ter_set( p, t_pavement );
+            g->m.furn_set( p, f_null );
+        }
+    }
+    g->m.build_map_cache( z );
+
+    vehicle *moving = g->m.add_vehicle( vproto_id( "car" ), tripoint( 40, 55, z ), 0, 0, 0 );
+    vehicle *parked = g->m.add_vehicle( vproto_id( "car" ), tripoint( 40, 70, z ), 0, 0, 0 );
+    REQUIRE( moving != nullptr );
+    REQUIRE( parked != nullptr );
+    const tripoint moving_start = moving->global_pos3();
+    const tripoint parked_start = parked->global_pos3();
+
+    // Coasting at 20 mph, about two tiles per turn. Nobody is at the controls, so it
+    // may start to skid in any direction.
+    moving->velocity = 2000;
+    g->m.vehmove();
+
+    CHECK( moving->global_pos3() != moving_start );
+    CHECK( moving->of_turn <= 0 );
+    CHECK( parked->global_pos3() == parked_start );
+    CHECK( g->m.veh_at( moving->global_pos3() ) == moving );
+
+    g->m.destroy_vehicle( moving );
+    g->m.destroy_vehicle( parked );
+}
@@ -0,0 +1,64 @@
+#include "catch/catch.hpp"
+
+#include "calendar.h"
+#include "game.h"
+#include "player.h"
+#include "weather.h"
+#include "weather_gen.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+int get_hourly_rotpoints_at_temp( int temp );
+
+TEST_CASE( "weather_sums_add_up_over_consecutive_spans", "[weather]" )
+{
+    const tripoint location = g->u.global_square_location();
+    const int start = DAYS( 3 ) + MINUTES( 7 );
+    const int end = start + DAYS( 30 );
+
+    // Ask for the later days first, so the timeline grows in both directions.
+    int rot = 0;
+    int rain = 0;
+    float sunlight = 0;
+    for( int day = 29; day >= 0; --day ) {
+        const int from = start + DAYS( day );
+        rot += get_rot_since( from, from + DAYS( 1 ), location );
+        const weather_sum sums = sum_conditions( from, from + DAYS( 1 ), location );
+        rain += sums.rain_amount;
+        sunlight += sums.sunlight;
+    }
+    const weather_sum sums = sum_conditions( start, end, location );
+    // Days starting in the middle of an hour round the parts of that hour separately.
+    CHECK( std::abs( get_rot_since( start, end, location ) - rot ) <= 30 );
+    CHECK( std::abs( sums.rain_amount - rain ) <= 30 );
+    CHECK( sums.sunlight == Approx( sunlight ).epsilon( 0.001 ) );
+
+    const int middle = start + HOURS( 100 ) - start % HOURS( 1 );
+    CHECK( get_rot_since( start, end, location ) ==
+           get_rot_since( start, middle, location ) + get_rot_since( middle, end, location ) );
+}
+
+TEST_CASE( "weather_sums_match_the_weather_generator", "[weather]" )
+{
+    const tripoint location = g->u.global_square_location();
+    const auto &wgen = g->get_cur_weather_gen();
+    const int start = DAYS( 40 );
+    const int end = start + DAYS( 30 );
+
+    int expected_rot = 0;
+    weather_sum expected;
+    for( calendar turn( start ); turn < end; turn += MINUTES( 10 ) ) {
+        const w_point w = wgen.get_weather( location, turn, g->get_seed() );
+        if( turn % HOURS( 1 ) == 0 ) {
+            expected_rot += get_hourly_rotpoints_at_temp( w.temperature );
+        }
+        const weather_type wtype = wgen.get_weather_conditions( w );
+        expected.sunlight += std::max<float>( 0.0f, MINUTES( 10 ) * ( turn.sunlight() -
+                                              weather_data( wtype ).light_modifier ) );
+    }
+
+    CHECK( get_rot_since( start, end, location ) == Approx( expected_rot ).epsilon( 0.02 ) );
+    CHECK( sum_conditions( start, end, location ).sunlight ==
+           Approx( expected.sunlight ).epsilon( 0.02 ) );
+}